@@ -10,8 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -24,17 +26,37 @@ namespace bustub {
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                                     const KeyComparator &comparator, HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
-  //  implement me!
+                                     const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                                     const ExtendibleHashTableOptions &options)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      merge_limit_(static_cast<uint32_t>(std::clamp(options.merge_threshold_, 0.0, 1.0) * BucketPage::BytesCapacity())),
+      shrink_margin_(std::max<uint32_t>(options.shrink_margin_, 1)),
+      sorted_buckets_(options.sorted_buckets_),
+      hash_fn_(std::move(hash_fn)) {
+  page_id_t directory_page_id;
+  page_id_t bucket_page_id;
+  auto *header_page = reinterpret_cast<HashTableDirectoryHeaderPage *>(NewPage(&header_page_id_)->GetData());
+  auto *dir_page = reinterpret_cast<HashTableDirectoryPage *>(NewPage(&directory_page_id)->GetData());
+  NewPage(&bucket_page_id);
+
+  header_page->SetPageId(header_page_id_);
+  header_page->SetDirectoryPageId(0, directory_page_id);
+  dir_page->SetPageId(directory_page_id);
+  dir_page->SetBucketPageId(0, bucket_page_id);
+  dir_page->SetLocalDepth(0, 0);
+
+  buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+  buffer_pool_manager_->UnpinPage(directory_page_id, true);
+  buffer_pool_manager_->UnpinPage(header_page_id_, true);
 }
 
 /*****************************************************************************
  * HELPERS
  *****************************************************************************/
 /**
- * Hash - simple helper to downcast MurmurHash's 64-bit hash to 32-bit
- * for extendible hashing.
+ * Hash - simple helper to downcast the 64-bit hash of the table's HashFunction, with whichever HashAlgorithm it
+ * was configured with, to 32-bit for extendible hashing.
  *
  * @param key the key to hash
  * @return the downcasted 32-bit hash
@@ -45,23 +67,170 @@ uint32_t HASH_TABLE_TYPE::Hash(KeyType key) {
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page) {
-  return 0;
+uint32_t HASH_TABLE_TYPE::KeyToDirectoryIndex(uint32_t hash, HashTableDirectoryHeaderPage *header_page) {
+  return hash & header_page->GetGlobalDepthMask();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::KeyToPageId(uint32_t hash, HashTableDirectoryHeaderPage *header_page) {
+  uint32_t bucket_idx = KeyToDirectoryIndex(hash, header_page);
+  page_id_t directory_page_id = DirectoryPageIdOf(header_page, bucket_idx);
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(directory_page_id);
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(HashTableDirectoryHeaderPage::DirectorySlot(bucket_idx));
+  buffer_pool_manager_->UnpinPage(directory_page_id, false);
+  return bucket_page_id;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+page_id_t HASH_TABLE_TYPE::DirectoryPageIdOf(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx) {
+  return header_page->GetDirectoryPageId(HashTableDirectoryHeaderPage::DirectoryIndex(bucket_idx));
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryHeaderPage *HASH_TABLE_TYPE::FetchHeaderPage() {
+  return reinterpret_cast<HashTableDirectoryHeaderPage *>(FetchPage(header_page_id_)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage(page_id_t directory_page_id) {
+  return reinterpret_cast<HashTableDirectoryPage *>(FetchPage(directory_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+typename HASH_TABLE_TYPE::BucketPage *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
+  return reinterpret_cast<BucketPage *>(FetchPage(bucket_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::BucketInsert(BucketPage *bucket, const KeyType &key, const ValueType &value, uint32_t hash) {
+  return sorted_buckets_ ? bucket->InsertSorted(key, value, hash, comparator_)
+                         : bucket->Insert(key, value, hash, comparator_);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-page_id_t HASH_TABLE_TYPE::KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page) {
-  return 0;
+bool HASH_TABLE_TYPE::BucketRemove(BucketPage *bucket, const KeyType &key, const ValueType &value, uint32_t hash) {
+  return sorted_buckets_ ? bucket->RemoveSorted(key, value, comparator_)
+                         : bucket->Remove(key, value, hash, comparator_);
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HashTableDirectoryPage *HASH_TABLE_TYPE::FetchDirectoryPage() {
-  return nullptr;
+bool HASH_TABLE_TYPE::SplitFreesRoom(BucketPage *bucket, uint32_t hash) {
+  uint32_t depth_mask = (1U << MAX_GLOBAL_DEPTH) - 1;
+  for (uint32_t bucket_slot = 0; bucket_slot < bucket->NumSlots(); bucket_slot++) {
+    if (bucket->IsReadable(bucket_slot) && ((Hash(bucket->KeyAt(bucket_slot)) ^ hash) & depth_mask) != 0) {
+      return true;
+    }
+  }
+  return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_id) {
-  return nullptr;
+template <typename F>
+void HASH_TABLE_TYPE::ForEachDirectorySlot(HashTableDirectoryHeaderPage *header_page, uint32_t first_idx,
+                                           uint32_t step, F &&fn) {
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  HashTableDirectoryPage *dir_page = nullptr;
+  for (uint32_t idx = first_idx; idx < header_page->Size(); idx += step) {
+    page_id_t next_page_id = DirectoryPageIdOf(header_page, idx);
+    if (next_page_id != directory_page_id) {
+      if (dir_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(directory_page_id, true);
+      }
+      directory_page_id = next_page_id;
+      dir_page = FetchDirectoryPage(directory_page_id);
+    }
+    fn(dir_page, HashTableDirectoryHeaderPage::DirectorySlot(idx), idx);
+  }
+  if (dir_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id, true);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::GrowDirectory(HashTableDirectoryHeaderPage *header_page) {
+  if (header_page->GetGlobalDepth() < DIRECTORY_ARRAY_DEPTH) {
+    // The whole directory still fits in the first directory page, which mirrors its own lower half.
+    page_id_t directory_page_id = header_page->GetDirectoryPageId(0);
+    FetchDirectoryPage(directory_page_id)->IncrGlobalDepth();
+    buffer_pool_manager_->UnpinPage(directory_page_id, true);
+    header_page->IncrGlobalDepth();
+    stats_.num_directory_grows_++;
+    return;
+  }
+
+  // Every directory page is full: the new upper half of the directory is a copy of all existing directory pages.
+  uint32_t num_pages = header_page->NumDirectoryPages();
+  for (uint32_t directory_idx = 0; directory_idx < num_pages; directory_idx++) {
+    page_id_t src_page_id = header_page->GetDirectoryPageId(directory_idx);
+    page_id_t dst_page_id;
+    Page *src_page = FetchPage(src_page_id);
+    Page *dst_page = NewPage(&dst_page_id);
+    memcpy(dst_page->GetData(), src_page->GetData(), PAGE_SIZE);
+    reinterpret_cast<HashTableDirectoryPage *>(dst_page->GetData())->SetPageId(dst_page_id);
+    header_page->SetDirectoryPageId(directory_idx + num_pages, dst_page_id);
+    buffer_pool_manager_->UnpinPage(dst_page_id, true);
+    buffer_pool_manager_->UnpinPage(src_page_id, false);
+  }
+  header_page->IncrGlobalDepth();
+  stats_.num_directory_grows_++;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_TYPE::MaxLocalDepth(HashTableDirectoryHeaderPage *header_page) {
+  uint32_t global_depth = header_page->GetGlobalDepth();
+  uint32_t max_local_depth = 0;
+  for (uint32_t directory_idx = 0; directory_idx < header_page->NumDirectoryPages(); directory_idx++) {
+    page_id_t directory_page_id = header_page->GetDirectoryPageId(directory_idx);
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(directory_page_id);
+    uint32_t num_slots = std::min<uint32_t>(header_page->Size(), DIRECTORY_ARRAY_SIZE);
+    for (uint32_t slot = 0; slot < num_slots && max_local_depth < global_depth; slot++) {
+      max_local_depth = std::max(max_local_depth, dir_page->GetLocalDepth(slot));
+    }
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+    if (max_local_depth == global_depth) {
+      break;
+    }
+  }
+  return max_local_depth;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::ShrinkDirectory(HashTableDirectoryHeaderPage *header_page) {
+  if (header_page->GetGlobalDepth() <= DIRECTORY_ARRAY_DEPTH) {
+    page_id_t directory_page_id = header_page->GetDirectoryPageId(0);
+    FetchDirectoryPage(directory_page_id)->DecrGlobalDepth();
+    buffer_pool_manager_->UnpinPage(directory_page_id, true);
+    header_page->DecrGlobalDepth();
+    stats_.num_directory_shrinks_++;
+    return;
+  }
+
+  // The upper half of the directory pages duplicates the lower half, drop it.
+  uint32_t num_pages = header_page->NumDirectoryPages();
+  for (uint32_t directory_idx = num_pages / 2; directory_idx < num_pages; directory_idx++) {
+    buffer_pool_manager_->DeletePage(header_page->GetDirectoryPageId(directory_idx));
+    header_page->SetDirectoryPageId(directory_idx, INVALID_PAGE_ID);
+  }
+  header_page->DecrGlobalDepth();
+  stats_.num_directory_shrinks_++;
 }
 
 /*****************************************************************************
@@ -69,7 +238,21 @@ HASH_TABLE_BUCKET_TYPE *HASH_TABLE_TYPE::FetchBucketPage(page_id_t bucket_page_i
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  uint32_t hash = Hash(key);
+  table_latch_.RLock();
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  page_id_t bucket_page_id = KeyToPageId(hash, header_page);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  Page *page = FetchPage(bucket_page_id);
+  auto *bucket = reinterpret_cast<BucketPage *>(page->GetData());
+
+  page->RLatch();
+  bool found = bucket->GetValue(key, hash, comparator_, result);
+  page->RUnlatch();
+
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+  return found;
 }
 
 /*****************************************************************************
@@ -77,12 +260,121 @@ bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  if (!BucketPage::Fits(key)) {
+    // only possible with variable-length keys; no number of splits makes room for an entry larger than a bucket
+    LOG_WARN("Entry does not fit in a bucket page, cannot insert it");
+    return false;
+  }
+  uint32_t hash = Hash(key);
+  table_latch_.RLock();
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  page_id_t bucket_page_id = KeyToPageId(hash, header_page);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  Page *page = FetchPage(bucket_page_id);
+  auto *bucket = reinterpret_cast<BucketPage *>(page->GetData());
+
+  page->WLatch();
+  bool full = !bucket->HasSpaceFor(key);
+  bool inserted = !full && BucketInsert(bucket, key, value, hash);
+  page->WUnlatch();
+
+  buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+  table_latch_.RUnlock();
+
+  if (full) {
+    return SplitInsert(transaction, key, value, hash);
+  }
+  return inserted;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value,
+                                  uint32_t hash) {
+  // Holding the table latch exclusively keeps every other operation out of the directory and the buckets, so no
+  // page latches are needed below. The bucket is re-examined since another writer may have split it already.
+  table_latch_.WLock();
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  bool header_dirty = false;
+  bool inserted = false;
+
+  while (true) {
+    uint32_t bucket_idx = KeyToDirectoryIndex(hash, header_page);
+    page_id_t directory_page_id = DirectoryPageIdOf(header_page, bucket_idx);
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(directory_page_id);
+    uint32_t slot = HashTableDirectoryHeaderPage::DirectorySlot(bucket_idx);
+    page_id_t bucket_page_id = dir_page->GetBucketPageId(slot);
+    uint32_t local_depth = dir_page->GetLocalDepth(slot);
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+    BucketPage *bucket = FetchBucketPage(bucket_page_id);
+
+    if (bucket->HasSpaceFor(key)) {
+      inserted = BucketInsert(bucket, key, value, hash);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, inserted);
+      break;
+    }
+
+    // Splitting cannot help a pair that is there already, nor a key whose whole bucket shares its hash bits; either
+    // would only grow the directory by empty split images up to MAX_GLOBAL_DEPTH.
+    std::vector<ValueType> values;
+    bucket->GetValue(key, hash, comparator_, &values);
+    if (std::find(values.begin(), values.end(), value) != values.end()) {
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+    if (!SplitFreesRoom(bucket, hash)) {
+      LOG_WARN("Every entry in bucket %d has the hash bits of the key, cannot split it", bucket_page_id);
+      buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+      break;
+    }
+
+    if (local_depth == header_page->GetGlobalDepth()) {
+      if (local_depth == MAX_GLOBAL_DEPTH) {
+        LOG_WARN("Hash table directory is at maximum size, cannot split bucket %d", bucket_page_id);
+        buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+        break;
+      }
+      GrowDirectory(header_page);
+      header_dirty = true;
+    }
+
+    page_id_t image_page_id;
+    auto *image = reinterpret_cast<BucketPage *>(NewPage(&image_page_id)->GetData());
+
+    // Every slot that pointed at the full bucket gains a bit of local depth; those with the new bit set move over to
+    // the split image. These are exactly the slots congruent to bucket_idx modulo 2^local_depth.
+    uint32_t high_bit = 1U << local_depth;
+    ForEachDirectorySlot(header_page, bucket_idx & (high_bit - 1), high_bit,
+                         [&](HashTableDirectoryPage *dir, uint32_t dir_slot, uint32_t idx) {
+                           dir->IncrLocalDepth(dir_slot);
+                           if ((idx & high_bit) != 0) {
+                             dir->SetBucketPageId(dir_slot, image_page_id);
+                           }
+                         });
+
+    for (uint32_t bucket_slot = 0; bucket_slot < bucket->NumSlots(); bucket_slot++) {
+      if (!bucket->IsReadable(bucket_slot)) {
+        continue;
+      }
+      KeyType slot_key = bucket->KeyAt(bucket_slot);
+      uint32_t slot_hash = Hash(slot_key);
+      if ((slot_hash & high_bit) != 0) {
+        // a sorted bucket is walked in key order, so the image stays sorted as well
+        image->Insert(slot_key, bucket->ValueAt(bucket_slot), slot_hash, comparator_);
+        bucket->RemoveAt(bucket_slot);
+      }
+    }
+    if (sorted_buckets_) {
+      bucket->Compact();
+    }
+
+    buffer_pool_manager_->UnpinPage(image_page_id, true);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, true);
+    stats_.num_splits_++;
+  }
+
+  buffer_pool_manager_->UnpinPage(header_page_id_, header_dirty);
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -90,37 +382,265 @@ bool HASH_TABLE_TYPE::SplitInsert(Transaction *transaction, const KeyType &key,
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  uint32_t hash = Hash(key);
+  table_latch_.RLock();
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  page_id_t bucket_page_id = KeyToPageId(hash, header_page);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  Page *page = FetchPage(bucket_page_id);
+  auto *bucket = reinterpret_cast<BucketPage *>(page->GetData());
+
+  page->WLatch();
+  bool removed = BucketRemove(bucket, key, value, hash);
+  bool underfull = removed && bucket->BytesUsed() <= merge_limit_;
+  page->WUnlatch();
+
+  buffer_pool_manager_->UnpinPage(bucket_page_id, removed);
+  table_latch_.RUnlock();
+
+  if (underfull) {
+    Merge(transaction, key, value, hash);
+  }
+  return removed;
 }
 
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value) {}
+void HASH_TABLE_TYPE::Merge(Transaction *transaction, const KeyType &key, const ValueType &value, uint32_t hash) {
+  table_latch_.WLock();
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  uint32_t bucket_idx = KeyToDirectoryIndex(hash, header_page);
+
+  page_id_t directory_page_id = DirectoryPageIdOf(header_page, bucket_idx);
+  HashTableDirectoryPage *dir_page = FetchDirectoryPage(directory_page_id);
+  uint32_t slot = HashTableDirectoryHeaderPage::DirectorySlot(bucket_idx);
+  page_id_t bucket_page_id = dir_page->GetBucketPageId(slot);
+  uint32_t local_depth = dir_page->GetLocalDepth(slot);
+  buffer_pool_manager_->UnpinPage(directory_page_id, false);
+
+  if (local_depth == 0) {
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    table_latch_.WUnlock();
+    return;
+  }
+
+  uint32_t high_bit = 1U << (local_depth - 1);
+  uint32_t image_idx = bucket_idx ^ high_bit;
+  page_id_t image_directory_page_id = DirectoryPageIdOf(header_page, image_idx);
+  HashTableDirectoryPage *image_dir_page = FetchDirectoryPage(image_directory_page_id);
+  uint32_t image_slot = HashTableDirectoryHeaderPage::DirectorySlot(image_idx);
+  page_id_t image_page_id = image_dir_page->GetBucketPageId(image_slot);
+  uint32_t image_local_depth = image_dir_page->GetLocalDepth(image_slot);
+  buffer_pool_manager_->UnpinPage(image_directory_page_id, false);
+  if (image_local_depth != local_depth) {
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    table_latch_.WUnlock();
+    return;
+  }
+
+  // The pair may have been refilled or merged by another writer between Remove and here. Merging only when the pair
+  // fits well within one bucket keeps the merged bucket from splitting again on the next few inserts.
+  BucketPage *bucket = FetchBucketPage(bucket_page_id);
+  BucketPage *image = FetchBucketPage(image_page_id);
+  if (bucket->BytesUsed() + image->BytesUsed() > merge_limit_) {
+    buffer_pool_manager_->UnpinPage(image_page_id, false);
+    buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    table_latch_.WUnlock();
+    return;
+  }
+  for (uint32_t bucket_slot = 0; bucket_slot < bucket->NumSlots(); bucket_slot++) {
+    if (bucket->IsReadable(bucket_slot)) {
+      KeyType slot_key = bucket->KeyAt(bucket_slot);
+      BucketInsert(image, slot_key, bucket->ValueAt(bucket_slot), Hash(slot_key));
+    }
+  }
+  buffer_pool_manager_->UnpinPage(image_page_id, true);
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+
+  // Both buckets are reached through the slots congruent to bucket_idx modulo 2^(local_depth - 1).
+  ForEachDirectorySlot(header_page, bucket_idx & (high_bit - 1), high_bit,
+                       [&](HashTableDirectoryPage *dir, uint32_t dir_slot, uint32_t idx) {
+                         dir->SetBucketPageId(dir_slot, image_page_id);
+                         dir->DecrLocalDepth(dir_slot);
+                       });
+  buffer_pool_manager_->DeletePage(bucket_page_id);
+  stats_.num_merges_++;
+
+  // Shrink only once the directory is shrink_margin_ levels deeper than it needs to be, and leave
+  // shrink_margin_ - 1 levels of slack so that the next few splits do not have to grow it straight back.
+  bool header_dirty = false;
+  uint32_t max_local_depth = MaxLocalDepth(header_page);
+  if (header_page->GetGlobalDepth() >= max_local_depth + shrink_margin_) {
+    while (header_page->GetGlobalDepth() > max_local_depth + shrink_margin_ - 1) {
+      ShrinkDirectory(header_page);
+      header_dirty = true;
+    }
+  }
+
+  buffer_pool_manager_->UnpinPage(header_page_id_, header_dirty);
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
- * GETGLOBALDEPTH - DO NOT TOUCH
+ * ITERATION
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> HASH_TABLE_TYPE::Begin() {
+  return ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>(this, 0, UINT32_MAX, nullptr);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> HASH_TABLE_TYPE::Begin(uint32_t partition,
+                                                                                      uint32_t num_partitions) {
+  uint64_t size = 1ULL << GetGlobalDepth();
+  auto begin_idx = static_cast<uint32_t>(size * partition / num_partitions);
+  // the last partition also covers whatever the directory grows into during the scan
+  uint32_t end_idx =
+      partition + 1 == num_partitions ? UINT32_MAX : static_cast<uint32_t>(size * (partition + 1) / num_partitions);
+  return ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>(this, begin_idx, end_idx, nullptr);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> HASH_TABLE_TYPE::Begin(const KeyType &low,
+                                                                                      const KeyType &high) {
+  std::pair<KeyType, KeyType> range(low, high);
+  return ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>(this, 0, UINT32_MAX, &range);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::ReadBucket(uint32_t *bucket_idx, uint32_t end_idx, const std::pair<KeyType, KeyType> *range,
+                                 std::vector<MappingType> *entries) {
+  table_latch_.RLock();
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  end_idx = std::min(end_idx, header_page->Size());
+
+  // A bucket with local depth ld is pointed to by every 2^ld-th slot; only the first of them, below 2^ld, counts.
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  page_id_t directory_page_id = INVALID_PAGE_ID;
+  HashTableDirectoryPage *dir_page = nullptr;
+  for (uint32_t idx = *bucket_idx; idx < end_idx && bucket_page_id == INVALID_PAGE_ID; idx++) {
+    page_id_t next_page_id = DirectoryPageIdOf(header_page, idx);
+    if (next_page_id != directory_page_id) {
+      if (dir_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(directory_page_id, false);
+      }
+      directory_page_id = next_page_id;
+      dir_page = FetchDirectoryPage(directory_page_id);
+    }
+    uint32_t slot = HashTableDirectoryHeaderPage::DirectorySlot(idx);
+    if ((idx >> dir_page->GetLocalDepth(slot)) == 0) {
+      bucket_page_id = dir_page->GetBucketPageId(slot);
+      *bucket_idx = idx;
+    }
+  }
+  if (dir_page != nullptr) {
+    buffer_pool_manager_->UnpinPage(directory_page_id, false);
+  }
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  if (bucket_page_id == INVALID_PAGE_ID) {
+    table_latch_.RUnlock();
+    return false;
+  }
+
+  Page *page = FetchPage(bucket_page_id);
+  auto *bucket = reinterpret_cast<BucketPage *>(page->GetData());
+  page->RLatch();
+  if (range != nullptr && sorted_buckets_) {
+    uint32_t num_readable = bucket->NumReadable();
+    for (uint32_t bucket_slot = bucket->LowerBound(range->first, comparator_);
+         bucket_slot < num_readable && comparator_(bucket->KeyAt(bucket_slot), range->second) <= 0; bucket_slot++) {
+      entries->emplace_back(bucket->KeyAt(bucket_slot), bucket->ValueAt(bucket_slot));
+    }
+  } else {
+    for (uint32_t bucket_slot = 0; bucket_slot < bucket->NumSlots() && bucket->IsOccupied(bucket_slot);
+         bucket_slot++) {
+      if (!bucket->IsReadable(bucket_slot)) {
+        continue;
+      }
+      KeyType key = bucket->KeyAt(bucket_slot);
+      if (range == nullptr || (comparator_(key, range->first) >= 0 && comparator_(key, range->second) <= 0)) {
+        entries->emplace_back(key, bucket->ValueAt(bucket_slot));
+      }
+    }
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(bucket_page_id, false);
+  table_latch_.RUnlock();
+  return true;
+}
+
+/*****************************************************************************
+ * GETGLOBALDEPTH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_TYPE::GetGlobalDepth() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  uint32_t global_depth = dir_page->GetGlobalDepth();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  uint32_t global_depth = header_page->GetGlobalDepth();
+  [[maybe_unused]] bool unpinned = buffer_pool_manager_->UnpinPage(header_page_id_, false, nullptr);
+  assert(unpinned);
   table_latch_.RUnlock();
   return global_depth;
 }
 
 /*****************************************************************************
- * VERIFY INTEGRITY - DO NOT TOUCH
+ * GETSTATS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExtendibleHashTableStats HASH_TABLE_TYPE::GetStats() {
+  table_latch_.RLock();
+  ExtendibleHashTableStats stats = stats_;
+  table_latch_.RUnlock();
+  return stats;
+}
+
+/*****************************************************************************
+ * VERIFY INTEGRITY
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_TYPE::VerifyIntegrity() {
   table_latch_.RLock();
-  HashTableDirectoryPage *dir_page = FetchDirectoryPage();
-  dir_page->VerifyIntegrity();
-  assert(buffer_pool_manager_->UnpinPage(directory_page_id_, false, nullptr));
+  HashTableDirectoryHeaderPage *header_page = FetchHeaderPage();
+  if (header_page->NumDirectoryPages() == 1) {
+    page_id_t directory_page_id = header_page->GetDirectoryPageId(0);
+    HashTableDirectoryPage *dir_page = FetchDirectoryPage(directory_page_id);
+    assert(dir_page->GetGlobalDepth() == header_page->GetGlobalDepth());
+    dir_page->VerifyIntegrity();
+    [[maybe_unused]] bool unpinned = buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+    assert(unpinned);
+  } else {
+    // Same invariants as HashTableDirectoryPage::VerifyIntegrity, checked across all directory pages.
+    [[maybe_unused]] uint32_t global_depth = header_page->GetGlobalDepth();
+    std::unordered_map<page_id_t, uint32_t> page_id_to_count;
+    std::unordered_map<page_id_t, uint32_t> page_id_to_ld;
+    for (uint32_t directory_idx = 0; directory_idx < header_page->NumDirectoryPages(); directory_idx++) {
+      page_id_t directory_page_id = header_page->GetDirectoryPageId(directory_idx);
+      HashTableDirectoryPage *dir_page = FetchDirectoryPage(directory_page_id);
+      assert(dir_page->GetGlobalDepth() == DIRECTORY_ARRAY_DEPTH);
+      for (uint32_t slot = 0; slot < DIRECTORY_ARRAY_SIZE; slot++) {
+        page_id_t curr_page_id = dir_page->GetBucketPageId(slot);
+        uint32_t curr_ld = dir_page->GetLocalDepth(slot);
+        assert(curr_ld <= global_depth);
+        ++page_id_to_count[curr_page_id];
+        if (page_id_to_ld.count(curr_page_id) > 0) {
+          assert(curr_ld == page_id_to_ld[curr_page_id]);
+        } else {
+          page_id_to_ld[curr_page_id] = curr_ld;
+        }
+      }
+      [[maybe_unused]] bool unpinned = buffer_pool_manager_->UnpinPage(directory_page_id, false, nullptr);
+      assert(unpinned);
+    }
+    for (const auto &[curr_page_id, curr_count] : page_id_to_count) {
+      assert(curr_count == (0x1U << (global_depth - page_id_to_ld[curr_page_id])));
+      (void)curr_count;
+    }
+  }
+  [[maybe_unused]] bool unpinned = buffer_pool_manager_->UnpinPage(header_page_id_, false, nullptr);
+  assert(unpinned);
   table_latch_.RUnlock();
 }
 
@@ -135,4 +655,6 @@ template class ExtendibleHashTable<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTable<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class ExtendibleHashTable<VarlenKey, RID, VarlenComparator>;
+
 }  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_iterator.cpp
+//
+// Identification: src/container/hash/extendible_hash_table_iterator.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "container/hash/extendible_hash_table_iterator.h"
+#include "common/rid.h"
+#include "container/hash/extendible_hash_table.h"
+#include "storage/index/generic_key.h"
+#include "storage/index/varlen_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_ITERATOR_TYPE::ExtendibleHashTableIterator(ExtendibleHashTable<KeyType, ValueType, KeyComparator> *table,
+                                                      uint32_t begin_idx, uint32_t end_idx,
+                                                      const std::pair<KeyType, KeyType> *range)
+    : table_(table), next_idx_(begin_idx), end_idx_(end_idx), has_range_(range != nullptr) {
+  if (has_range_) {
+    range_ = *range;
+  }
+  NextBucket();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_ITERATOR_TYPE::IsEnd() {
+  return offset_ == entries_.size();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+const MappingType &HASH_TABLE_ITERATOR_TYPE::operator*() {
+  return entries_[offset_];
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_ITERATOR_TYPE &HASH_TABLE_ITERATOR_TYPE::operator++() {
+  if (++offset_ == entries_.size()) {
+    NextBucket();
+  }
+  return *this;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_ITERATOR_TYPE::NextBucket() {
+  entries_.clear();
+  offset_ = 0;
+  while (entries_.empty() && next_idx_ < end_idx_) {
+    uint32_t bucket_idx = next_idx_;
+    if (!table_->ReadBucket(&bucket_idx, end_idx_, has_range_ ? &range_ : nullptr, &entries_)) {
+      next_idx_ = end_idx_;
+      break;
+    }
+    next_idx_ = bucket_idx + 1;
+  }
+}
+
+template class ExtendibleHashTableIterator<int, int, IntComparator>;
+
+template class ExtendibleHashTableIterator<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExtendibleHashTableIterator<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExtendibleHashTableIterator<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExtendibleHashTableIterator<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExtendibleHashTableIterator<GenericKey<64>, RID, GenericComparator<64>>;
+
+template class ExtendibleHashTableIterator<VarlenKey, RID, VarlenComparator>;
+
+}  // namespace bustub
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <utility>
@@ -26,21 +28,471 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_TYPE::LinearProbeHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
                                       const KeyComparator &comparator, size_t num_buckets,
                                       HashFunction<KeyType> hash_fn)
-    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {}
+    : buffer_pool_manager_(buffer_pool_manager), comparator_(comparator), hash_fn_(std::move(hash_fn)) {
+  NewTable(num_buckets, &header_page_id_);
+}
+
+/*****************************************************************************
+ * HELPERS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::NewTable(size_t num_buckets, page_id_t *header_page_id) {
+  size_t num_blocks = std::max<size_t>((num_buckets + BLOCK_ARRAY_SIZE - 1) / BLOCK_ARRAY_SIZE, 1);
+  num_blocks = std::min<size_t>(num_blocks, HEADER_BLOCK_ARRAY_SIZE);
+  auto *header_page = reinterpret_cast<HashTableHeaderPage *>(NewPage(header_page_id)->GetData());
+  header_page->SetPageId(*header_page_id);
+  header_page->SetSize(num_blocks * BLOCK_ARRAY_SIZE);
+  for (size_t block_idx = 0; block_idx < num_blocks; block_idx++) {
+    header_page->AddBlockPageId(INVALID_PAGE_ID);
+  }
+  buffer_pool_manager_->UnpinPage(*header_page_id, true);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+size_t HASH_TABLE_TYPE::Distance(const KeyType &key, size_t slot, size_t size) {
+  return (slot + size - hash_fn_.GetHash(key) % size) % size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename F>
+bool HASH_TABLE_TYPE::ProbeSlots(HashTableHeaderPage *header_page, const KeyType &key, bool allocate, bool latch,
+                                 F &&fn) {
+  size_t size = header_page->GetSize();
+  size_t slot = hash_fn_.GetHash(key) % size;
+  size_t block_idx = slot / BLOCK_ARRAY_SIZE;
+  slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+  bool allocated = false;
+  Page *latched_page = nullptr;
+
+  for (size_t num_probed = 0; num_probed < size; block_idx = (block_idx + 1) % header_page->NumBlocks()) {
+    page_id_t block_page_id = header_page->GetBlockPageId(block_idx);
+    Page *page;
+    bool is_dirty = false;
+    if (block_page_id != INVALID_PAGE_ID) {
+      page = FetchPage(block_page_id);
+    } else if (allocate) {
+      page = NewPage(&block_page_id);
+      header_page->SetBlockPageId(block_idx, block_page_id);
+      allocated = true;
+      is_dirty = true;
+    } else {
+      // a block that was never allocated holds nothing but free slots
+      break;
+    }
+    if (latch) {
+      // Latches are coupled, so that an entry shifted between two blocks is not missed. Runs that wrap around past
+      // the last block only change under the exclusive table latch, so the coupling can be broken there.
+      if (block_idx == 0 && latched_page != nullptr) {
+        latched_page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(latched_page->GetPageId(), false);
+        latched_page = nullptr;
+      }
+      page->RLatch();
+      if (latched_page != nullptr) {
+        latched_page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(latched_page->GetPageId(), false);
+      }
+      latched_page = page;
+    }
+
+    auto *block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    bool keep_probing = true;
+    for (; offset < BLOCK_ARRAY_SIZE && num_probed < size && keep_probing; offset++, num_probed++) {
+      keep_probing = fn(block_page, offset, block_idx * BLOCK_ARRAY_SIZE + offset, &is_dirty);
+    }
+    if (!latch) {
+      buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+    }
+    if (!keep_probing) {
+      break;
+    }
+    offset = 0;
+  }
+  if (latched_page != nullptr) {
+    latched_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(latched_page->GetPageId(), false);
+  }
+  return allocated;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+template <typename F>
+bool HASH_TABLE_TYPE::LatchRun(HashTableHeaderPage *header_page, const KeyType &key, std::vector<Page *> *pages,
+                               F &&fn) {
+  size_t slot = hash_fn_.GetHash(key) % header_page->GetSize();
+  slot_offset_t offset = slot % BLOCK_ARRAY_SIZE;
+  // latching in block order, and never around past the last block, rules out deadlocks between writers
+  for (size_t block_idx = slot / BLOCK_ARRAY_SIZE; block_idx < header_page->NumBlocks(); block_idx++, offset = 0) {
+    page_id_t block_page_id = header_page->GetBlockPageId(block_idx);
+    if (block_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    Page *page = FetchPage(block_page_id);
+    page->WLatch();
+    pages->push_back(page);
+    auto *block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+    for (; offset < BLOCK_ARRAY_SIZE; offset++) {
+      if (!fn(block_page, offset, block_idx * BLOCK_ARRAY_SIZE + offset)) {
+        return true;
+      }
+    }
+  }
+  UnlatchRun(pages);
+  return false;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::UnlatchRun(std::vector<Page *> *pages) {
+  // the changes made under the latches already marked their pages dirty
+  for (Page *page : *pages) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  }
+  pages->clear();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::GetValueFrom(page_id_t header_page_id, const KeyType &key, std::vector<ValueType> *result) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id);
+  size_t size = header_page->GetSize();
+  size_t distance = 0;
+  bool found = false;
+  ProbeSlots(header_page, key, false, true, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset, size_t slot,
+                                                bool *is_dirty) {
+    // Robin Hood order: once the resident is closer to its home slot than we are to ours, the key cannot be further
+    if (!block_page->IsOccupied(offset) || Distance(block_page->KeyAt(offset), slot, size) < distance++) {
+      return false;
+    }
+    if (block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0) {
+      result->push_back(block_page->ValueAt(offset));
+      found = true;
+    }
+    return true;
+  });
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::FindSlot(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value,
+                               size_t *slot) {
+  size_t size = header_page->GetSize();
+  size_t distance = 0;
+  bool found = false;
+  ProbeSlots(header_page, key, false, false, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset, size_t curr,
+                                                 bool *is_dirty) {
+    if (!block_page->IsOccupied(offset) || Distance(block_page->KeyAt(offset), curr, size) < distance++) {
+      return false;
+    }
+    found = block_page->IsReadable(offset) && comparator_(block_page->KeyAt(offset), key) == 0 &&
+            block_page->ValueAt(offset) == value;
+    *slot = curr;
+    return !found;
+  });
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::Contains(page_id_t header_page_id, const KeyType &key, const ValueType &value) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id);
+  size_t slot;
+  bool found = FindSlot(header_page, key, value, &slot);
+  buffer_pool_manager_->UnpinPage(header_page_id, false);
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::InsertInto(const KeyType &key, const ValueType &value) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  if (num_occupied_ == size) {
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    return false;
+  }
+
+  // Robin Hood insertion: walk down the run and swap the carried entry with any resident that is closer to its home
+  // slot, so that distances from home stay even. The free slot found at the end takes whichever entry is carried.
+  MappingType carried(key, value);
+  size_t carried_distance = 0;
+  bool allocated = ProbeSlots(header_page, key, true, false, [&](HASH_TABLE_BLOCK_TYPE *block_page,
+                                                                 slot_offset_t offset, size_t slot, bool *is_dirty) {
+    if (!block_page->IsOccupied(offset)) {
+      block_page->Insert(offset, carried.first, carried.second);
+      *is_dirty = true;
+      return false;
+    }
+    size_t resident_distance = Distance(block_page->KeyAt(offset), slot, size);
+    if (resident_distance < carried_distance) {
+      MappingType resident(block_page->KeyAt(offset), block_page->ValueAt(offset));
+      block_page->Free(offset);
+      block_page->Insert(offset, carried.first, carried.second);
+      carried = resident;
+      carried_distance = resident_distance;
+      *is_dirty = true;
+    }
+    carried_distance++;
+    return true;
+  });
+  num_occupied_++;
+  buffer_pool_manager_->UnpinPage(header_page_id_, allocated);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::RemoveFrom(const KeyType &key, const ValueType &value) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  size_t hole;
+  if (!FindSlot(header_page, key, value, &hole)) {
+    buffer_pool_manager_->UnpinPage(header_page_id_, false);
+    return false;
+  }
+
+  // Backward-shift deletion: pull every following entry of the run one slot closer to its home, until reaching a
+  // free slot or an entry that already sits at home. No tombstone is left behind.
+  while (true) {
+    size_t next = (hole + 1) % size;
+    page_id_t hole_page_id = header_page->GetBlockPageId(hole / BLOCK_ARRAY_SIZE);
+    page_id_t next_page_id = header_page->GetBlockPageId(next / BLOCK_ARRAY_SIZE);
+    HASH_TABLE_BLOCK_TYPE *hole_page = FetchBlockPage(hole_page_id);
+    hole_page->Free(hole % BLOCK_ARRAY_SIZE);
+    bool shifted = false;
+    if (next_page_id != INVALID_PAGE_ID) {
+      HASH_TABLE_BLOCK_TYPE *next_page = FetchBlockPage(next_page_id);
+      slot_offset_t next_offset = next % BLOCK_ARRAY_SIZE;
+      shifted = next_page->IsOccupied(next_offset) && Distance(next_page->KeyAt(next_offset), next, size) > 0;
+      if (shifted) {
+        hole_page->Insert(hole % BLOCK_ARRAY_SIZE, next_page->KeyAt(next_offset), next_page->ValueAt(next_offset));
+      }
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(hole_page_id, true);
+    if (!shifted) {
+      break;
+    }
+    hole = next;
+  }
+  num_occupied_--;
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::RemoveFromOld(const KeyType &key, const ValueType &value) {
+  // The old table only shrinks until it is dropped, so a tombstone is enough and keeps the runs intact for migration.
+  HashTableHeaderPage *header_page = FetchHeaderPage(old_header_page_id_);
+  size_t slot;
+  bool found = FindSlot(header_page, key, value, &slot);
+  if (found) {
+    page_id_t block_page_id = header_page->GetBlockPageId(slot / BLOCK_ARRAY_SIZE);
+    FetchBlockPage(block_page_id)->Remove(slot % BLOCK_ARRAY_SIZE);
+    buffer_pool_manager_->UnpinPage(block_page_id, true);
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::InsertShared(const KeyType &key, const ValueType &value, bool *inserted) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  size_t distance = 0;
+  bool searching = true;
+  bool duplicate = false;
+  std::vector<Page *> pages;
+  // the run up to its first free slot holds every value of key, and is all that the insert shifts
+  bool latched = LatchRun(header_page, key, &pages, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset,
+                                                         size_t slot) {
+    if (!block_page->IsOccupied(offset)) {
+      return false;
+    }
+    // Robin Hood order: past a resident closer to its home slot, the key cannot be any further, but the free slot can
+    searching = searching && Distance(block_page->KeyAt(offset), slot, size) >= distance++;
+    duplicate = searching && comparator_(block_page->KeyAt(offset), key) == 0 && block_page->ValueAt(offset) == value;
+    return !duplicate;
+  });
+  *inserted = latched && !duplicate && InsertInto(key, value);
+  UnlatchRun(&pages);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  return latched;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::RemoveShared(const KeyType &key, const ValueType &value, bool *removed) {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  size_t distance = 0;
+  bool found = false;
+  std::vector<Page *> pages;
+  // the run up to where the backward shift stops, at a free slot or an entry that sits at home
+  bool latched = LatchRun(header_page, key, &pages, [&](HASH_TABLE_BLOCK_TYPE *block_page, slot_offset_t offset,
+                                                         size_t slot) {
+    if (found) {
+      return block_page->IsOccupied(offset) && Distance(block_page->KeyAt(offset), slot, size) > 0;
+    }
+    if (!block_page->IsOccupied(offset) || Distance(block_page->KeyAt(offset), slot, size) < distance++) {
+      return false;
+    }
+    found = comparator_(block_page->KeyAt(offset), key) == 0 && block_page->ValueAt(offset) == value;
+    return true;
+  });
+  *removed = latched && found && RemoveFrom(key, value);
+  UnlatchRun(&pages);
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  return latched;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::IsOverloaded() {
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  return num_occupied_ > MAX_LOAD_FACTOR * size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::Grow() {
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    // resizes leave room for twice the entries, so a migration only runs out of slots at the maximum size
+    LOG_WARN("Linear probe hash table filled up before its resize finished migrating");
+    return false;
+  }
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t num_blocks = header_page->NumBlocks();
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  if (2 * num_blocks > HEADER_BLOCK_ARRAY_SIZE) {
+    LOG_WARN("Linear probe hash table is at maximum size, cannot grow past %zu slots", size);
+    return false;
+  }
+  BeginResize(2 * size);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::BeginResize(size_t num_buckets) {
+  old_header_page_id_ = header_page_id_;
+  next_migrate_block_ = 0;
+  NewTable(num_buckets, &header_page_id_);
+  num_occupied_ = 0;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_TYPE::MigrateBlocks(size_t num_blocks) {
+  if (old_header_page_id_ == INVALID_PAGE_ID) {
+    return;
+  }
+  HashTableHeaderPage *old_header_page = FetchHeaderPage(old_header_page_id_);
+  size_t old_num_blocks = old_header_page->NumBlocks();
+  for (; num_blocks > 0 && next_migrate_block_ < old_num_blocks; num_blocks--, next_migrate_block_++) {
+    page_id_t block_page_id = old_header_page->GetBlockPageId(next_migrate_block_);
+    if (block_page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    // Migrated entries leave tombstones behind, so that lookups in the old table still find the entries of later
+    // blocks whose probe sequences run through this one.
+    HASH_TABLE_BLOCK_TYPE *block_page = FetchBlockPage(block_page_id);
+    bool is_dirty = false;
+    for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+      if (block_page->IsReadable(offset)) {
+        bool inserted = InsertInto(block_page->KeyAt(offset), block_page->ValueAt(offset));
+        BUSTUB_ASSERT(inserted, "the new table is larger than the old one");
+        (void)inserted;
+        block_page->Remove(offset);
+        is_dirty = true;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(block_page_id, is_dirty);
+  }
+
+  bool done = next_migrate_block_ == old_num_blocks;
+  if (done) {
+    for (size_t block_idx = 0; block_idx < old_num_blocks; block_idx++) {
+      page_id_t block_page_id = old_header_page->GetBlockPageId(block_idx);
+      if (block_page_id != INVALID_PAGE_ID) {
+        buffer_pool_manager_->DeletePage(block_page_id);
+      }
+    }
+  }
+  buffer_pool_manager_->UnpinPage(old_header_page_id_, false);
+  if (done) {
+    buffer_pool_manager_->DeletePage(old_header_page_id_);
+    old_header_page_id_ = INVALID_PAGE_ID;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HashTableHeaderPage *HASH_TABLE_TYPE::FetchHeaderPage(page_id_t header_page_id) {
+  return reinterpret_cast<HashTableHeaderPage *>(FetchPage(header_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+HASH_TABLE_BLOCK_TYPE *HASH_TABLE_TYPE::FetchBlockPage(page_id_t block_page_id) {
+  return reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(FetchPage(block_page_id)->GetData());
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch hash table page");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *HASH_TABLE_TYPE::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate hash table page");
+  }
+  return page;
+}
 
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) {
-  return false;
+  table_latch_.RLock();
+  bool found = GetValueFrom(header_page_id_, key, result);
+  if (old_header_page_id_ != INVALID_PAGE_ID) {
+    found = GetValueFrom(old_header_page_id_, key, result) || found;
+  }
+  table_latch_.RUnlock();
+  return found;
 }
 /*****************************************************************************
  * INSERTION
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  table_latch_.RLock();
+  bool inserted = false;
+  bool done = old_header_page_id_ == INVALID_PAGE_ID && InsertShared(key, value, &inserted);
+  bool overloaded = inserted && IsOverloaded();
+  table_latch_.RUnlock();
+  if (done && !overloaded) {
+    return inserted;
+  }
+
+  table_latch_.WLock();
+  if (!done) {
+    MigrateBlocks(RESIZE_BLOCKS_PER_OPERATION);
+    if (!Contains(header_page_id_, key, value) &&
+        (old_header_page_id_ == INVALID_PAGE_ID || !Contains(old_header_page_id_, key, value))) {
+      inserted = InsertInto(key, value);
+      if (!inserted && Grow()) {
+        inserted = InsertInto(key, value);
+      }
+    }
+  }
+  // another writer may have started growing the table in the meantime
+  if (old_header_page_id_ == INVALID_PAGE_ID && IsOverloaded()) {
+    Grow();
+  }
+  table_latch_.WUnlock();
+  return inserted;
 }
 
 /*****************************************************************************
@@ -48,21 +500,98 @@ bool HASH_TABLE_TYPE::Insert(Transaction *transaction, const KeyType &key, const
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_TYPE::Remove(Transaction *transaction, const KeyType &key, const ValueType &value) {
-  return false;
+  table_latch_.RLock();
+  bool removed = false;
+  bool done = old_header_page_id_ == INVALID_PAGE_ID && RemoveShared(key, value, &removed);
+  table_latch_.RUnlock();
+  if (done) {
+    return removed;
+  }
+
+  table_latch_.WLock();
+  MigrateBlocks(RESIZE_BLOCKS_PER_OPERATION);
+  removed = RemoveFrom(key, value) || (old_header_page_id_ != INVALID_PAGE_ID && RemoveFromOld(key, value));
+  table_latch_.WUnlock();
+  return removed;
 }
 
 /*****************************************************************************
  * RESIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_TYPE::Resize(size_t initial_size) {}
+void HASH_TABLE_TYPE::Resize(size_t initial_size) {
+  table_latch_.WLock();
+  MigrateBlocks(SIZE_MAX);
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  // never shrink below the current size, and leave room for twice the entries, so that the new table cannot fill up
+  // before the old one is migrated
+  BeginResize(std::max({2 * initial_size, size, 2 * num_occupied_.load()}));
+  table_latch_.WUnlock();
+}
 
 /*****************************************************************************
  * GETSIZE
  *****************************************************************************/
 template <typename KeyType, typename ValueType, typename KeyComparator>
 size_t HASH_TABLE_TYPE::GetSize() {
-  return 0;
+  table_latch_.RLock();
+  HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id_);
+  size_t size = header_page->GetSize();
+  buffer_pool_manager_->UnpinPage(header_page_id_, false);
+  table_latch_.RUnlock();
+  return size;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_TYPE::IsResizing() {
+  table_latch_.RLock();
+  bool resizing = old_header_page_id_ != INVALID_PAGE_ID;
+  table_latch_.RUnlock();
+  return resizing;
+}
+
+/*****************************************************************************
+ * GETSTATS
+ *****************************************************************************/
+template <typename KeyType, typename ValueType, typename KeyComparator>
+LinearProbeHashTableStats HASH_TABLE_TYPE::GetStats() {
+  table_latch_.RLock();
+  LinearProbeHashTableStats stats;
+  size_t total_probe_length = 0;
+  for (page_id_t header_page_id : {header_page_id_, old_header_page_id_}) {
+    if (header_page_id == INVALID_PAGE_ID) {
+      continue;
+    }
+    HashTableHeaderPage *header_page = FetchHeaderPage(header_page_id);
+    size_t size = header_page->GetSize();
+    for (size_t block_idx = 0; block_idx < header_page->NumBlocks(); block_idx++) {
+      page_id_t block_page_id = header_page->GetBlockPageId(block_idx);
+      if (block_page_id == INVALID_PAGE_ID) {
+        continue;
+      }
+      Page *page = FetchPage(block_page_id);
+      page->RLatch();
+      auto *block_page = reinterpret_cast<HASH_TABLE_BLOCK_TYPE *>(page->GetData());
+      for (slot_offset_t offset = 0; offset < BLOCK_ARRAY_SIZE; offset++) {
+        if (block_page->IsReadable(offset)) {
+          size_t probe_length = Distance(block_page->KeyAt(offset), block_idx * BLOCK_ARRAY_SIZE + offset, size) + 1;
+          total_probe_length += probe_length;
+          stats.max_probe_length_ = std::max(stats.max_probe_length_, probe_length);
+          stats.num_entries_++;
+        }
+      }
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(block_page_id, false);
+    }
+    buffer_pool_manager_->UnpinPage(header_page_id, false);
+  }
+  table_latch_.RUnlock();
+  if (stats.num_entries_ > 0) {
+    stats.avg_probe_length_ = static_cast<double>(total_probe_length) / stats.num_entries_;
+  }
+  return stats;
 }
 
 template class LinearProbeHashTable<int, int, IntComparator>;
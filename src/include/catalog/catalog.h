@@ -21,6 +21,8 @@
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
 #include "container/hash/hash_function.h"
+#include "storage/index/adaptive_radix_tree_index.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
@@ -192,18 +194,7 @@ class Catalog {
   IndexInfo *CreateIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
                          const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
                          std::size_t keysize, HashFunction<KeyType> hash_function) {
-    // Reject the creation request for nonexistent table
-    if (table_names_.find(table_name) == table_names_.end()) {
-      return NULL_INDEX_INFO;
-    }
-
-    // If the table exists, an entry for the table should already be present in index_names_
-    BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
-
-    // Determine if the requested index already exists for this table
-    auto &table_indexes = index_names_.find(table_name)->second;
-    if (table_indexes.find(index_name) != table_indexes.end()) {
-      // The requested index already exists for this table
+    if (!CanCreateIndex(index_name, table_name)) {
       return NULL_INDEX_INFO;
     }
 
@@ -224,19 +215,100 @@ class Catalog {
       index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
     }
 
-    // Get the next OID for the new index
-    const auto index_oid = next_index_oid_.fetch_add(1);
+    return AddIndex(std::move(index), key_schema, index_name, table_name, keysize);
+  }
 
-    // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
-    auto *tmp = index_info.get();
+  /**
+   * Create a new B+ tree index, populate existing data of the table and return its metadata.
+   *
+   * Inserting the keys of the table one by one would split pages all over the tree and leave them about half full.
+   * Instead the keys are sorted and the tree is bulk loaded bottom-up, with every page filled to fill_factor. The sort
+   * is external, so that a large table's keys are spilled to the buffer pool in sorted runs rather than held in
+   * memory all at once.
+   * Like any B+ tree, the index records where it keeps its root page id in the header page, which must already exist.
+   *
+   * @param txn The transaction in which the table is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @param keysize Size of the key, which must be the size of KeyType
+   * @param fill_factor The fraction of each index page to fill, leaving room for later inserts
+   * @param is_unique Whether each key may only be indexed once; a non-unique index needs keysize to fit the key and
+   * a RID
+   * @return A (non-owning) pointer to the metadata of the new table, or NULL_INDEX_INFO if keysize is not the size of
+   * KeyType, a non-unique key does not fit next to a RID, or the bulk load fails
+   */
+  template <class KeyType, class ValueType, class KeyComparator>
+  IndexInfo *CreateBPlusTreeIndex(Transaction *txn, const std::string &index_name, const std::string &table_name,
+                                  const Schema &schema, const Schema &key_schema,
+                                  const std::vector<uint32_t> &key_attrs, std::size_t keysize,
+                                  double fill_factor = 0.9, bool is_unique = true) {
+    if (!CanCreateIndex(index_name, table_name) || keysize != sizeof(KeyType)) {
+      return NULL_INDEX_INFO;
+    }
 
-    // Update internal tracking
-    indexes_.emplace(index_oid, std::move(index_info));
-    table_indexes.emplace(index_name, index_oid);
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique);
+    if (!is_unique && !BPlusTreeIndex<KeyType, ValueType, KeyComparator>::KeyFits(meta->GetKeySchema(), is_unique)) {
+      return NULL_INDEX_INFO;
+    }
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+
+    // Feed the keys of all tuples in table heap to the index, which sorts them
+    auto *heap = GetTable(table_name)->table_.get();
+    auto tuple = heap->Begin(txn);
+    bool loaded = index->BulkLoad(
+        [&](std::pair<KeyType, ValueType> *entry) {
+          if (tuple == heap->End()) {
+            return false;
+          }
+          entry->first.SetFromKey(tuple->KeyFromTuple(schema, key_schema, key_attrs), &key_schema);
+          entry->second = tuple->GetRid();
+          ++tuple;
+          return true;
+        },
+        fill_factor);
+    if (!loaded) {
+      return NULL_INDEX_INFO;
+    }
 
-    return tmp;
+    return AddIndex(std::move(index), key_schema, index_name, table_name, keysize);
+  }
+
+  /**
+   * Create a new adaptive radix tree index, populate existing data of the table and return its metadata.
+   *
+   * The index is an ordered index kept in memory instead of in pages, so it takes keys of any length, but is lost on
+   * shutdown like the rest of the catalog.
+   *
+   * @param txn The transaction in which the table is being created
+   * @param index_name The name of the new index
+   * @param table_name The name of the table
+   * @param schema The schema of the table
+   * @param key_schema The schema of the key
+   * @param key_attrs Key attributes
+   * @param is_unique Whether each key may only be indexed once
+   * @return A (non-owning) pointer to the metadata of the new table
+   */
+  IndexInfo *CreateAdaptiveRadixTreeIndex(Transaction *txn, const std::string &index_name,
+                                          const std::string &table_name, const Schema &schema,
+                                          const Schema &key_schema, const std::vector<uint32_t> &key_attrs,
+                                          bool is_unique = true) {
+    if (!CanCreateIndex(index_name, table_name)) {
+      return NULL_INDEX_INFO;
+    }
+
+    auto meta = std::make_unique<IndexMetadata>(index_name, table_name, &schema, key_attrs, is_unique);
+    auto index = std::make_unique<AdaptiveRadixTreeIndex>(std::move(meta));
+
+    // Populate the index with all tuples in table heap
+    auto *heap = GetTable(table_name)->table_.get();
+    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    }
+
+    return AddIndex(std::move(index), key_schema, index_name, table_name, key_schema.GetLength());
   }
 
   /**
@@ -323,6 +395,44 @@ class Catalog {
   }
 
  private:
+  /**
+   * @return true if the table exists and does not have an index called index_name yet
+   */
+  bool CanCreateIndex(const std::string &index_name, const std::string &table_name) {
+    // Reject the creation request for nonexistent table
+    if (table_names_.find(table_name) == table_names_.end()) {
+      return false;
+    }
+
+    // If the table exists, an entry for the table should already be present in index_names_
+    BUSTUB_ASSERT((index_names_.find(table_name) != index_names_.end()), "Broken Invariant");
+
+    // Determine if the requested index already exists for this table
+    auto &table_indexes = index_names_.find(table_name)->second;
+    return table_indexes.find(index_name) == table_indexes.end();
+  }
+
+  /**
+   * Register a new, populated index.
+   * @return A (non-owning) pointer to the metadata of the new index
+   */
+  IndexInfo *AddIndex(std::unique_ptr<Index> &&index, const Schema &key_schema, const std::string &index_name,
+                      const std::string &table_name, std::size_t keysize) {
+    // Get the next OID for the new index
+    const auto index_oid = next_index_oid_.fetch_add(1);
+
+    // Construct index information; IndexInfo takes ownership of the Index itself
+    auto index_info =
+        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto *tmp = index_info.get();
+
+    // Update internal tracking
+    indexes_.emplace(index_oid, std::move(index_info));
+    index_names_.find(table_name)->second.emplace(index_name, index_oid);
+
+    return tmp;
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
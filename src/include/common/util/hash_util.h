@@ -12,24 +12,63 @@
 
 #pragma once
 
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <string>
 
 #include "common/macros.h"
+#include "murmur3/MurmurHash3.h"
 #include "type/value.h"
 
 namespace bustub {
 
 using hash_t = std::size_t;
 
-class HashUtil {
- private:
-  static const hash_t PRIME_FACTOR = 10000019;
+/** The byte-string hash functions HashUtil offers. */
+enum class HashAlgorithm {
+  /** Byte-at-a-time rotate/xor loop. Cheap, but leaves the high bits of short keys almost constant. */
+  ROTATE_XOR,
+  /** MurmurHash3 x64_128, truncated to 64 bits. */
+  MURMUR3,
+  /** wyhash: reads 8 bytes at a time and mixes with 64x64->128-bit multiplies. */
+  WYHASH,
+  /** CRC32C of the input via the SSE4.2 crc32 instruction, then spread over 64 bits. WYHASH without SSE4.2. */
+  CRC32C,
+};
 
+class HashUtil {
  public:
+  /** The algorithm used by HashBytes, HashValue and HashFunction unless told otherwise. */
+  static constexpr HashAlgorithm DEFAULT_HASH_ALGORITHM = HashAlgorithm::WYHASH;
+
   static inline hash_t HashBytes(const char *bytes, size_t length) {
+    return HashBytes(DEFAULT_HASH_ALGORITHM, bytes, length);
+  }
+
+  static inline hash_t HashBytes(HashAlgorithm algorithm, const char *bytes, size_t length) {
+    switch (algorithm) {
+      case HashAlgorithm::ROTATE_XOR:
+        return HashBytesRotateXor(bytes, length);
+      case HashAlgorithm::MURMUR3: {
+        uint64_t hash[2];
+        murmur3::MurmurHash3_x64_128(bytes, static_cast<int>(length), 0, hash);
+        return hash[0];
+      }
+      case HashAlgorithm::WYHASH:
+        return WyHash(bytes, length, 0);
+      case HashAlgorithm::CRC32C:
+        return Crc32cHash(bytes, length, 0);
+    }
+    UNREACHABLE("Unknown hash algorithm.");
+  }
+
+  static inline hash_t HashBytesRotateXor(const char *bytes, size_t length) {
     // https://github.com/greenplum-db/gpos/blob/b53c1acd6285de94044ff91fbee91589543feba1/libgpos/src/utils.cpp#L126
     hash_t hash = length;
     for (size_t i = 0; i < length; ++i) {
@@ -38,14 +77,85 @@ class HashUtil {
     return hash;
   }
 
-  static inline hash_t CombineHashes(hash_t l, hash_t r) {
-    hash_t both[2];
-    both[0] = l;
-    both[1] = r;
-    return HashBytes(reinterpret_cast<char *>(both), sizeof(hash_t) * 2);
+  /**
+   * wyhash (https://github.com/wangyi-fudan/wyhash), final version 3. Inputs up to 16 bytes are read as at most four
+   * overlapping 4-byte words; longer inputs are consumed 16 or 48 bytes per iteration.
+   */
+  static inline hash_t WyHash(const char *bytes, size_t length, uint64_t seed) {
+    const char *p = bytes;
+    seed ^= WyMix(seed ^ WYP[0], WYP[1]);
+    uint64_t a;
+    uint64_t b;
+    if (length <= 16) {
+      if (length >= 4) {
+        a = (Read4(p) << 32) | Read4(p + ((length >> 3) << 2));
+        b = (Read4(p + length - 4) << 32) | Read4(p + length - 4 - ((length >> 3) << 2));
+      } else if (length > 0) {
+        a = (static_cast<uint64_t>(static_cast<uint8_t>(p[0])) << 16) |
+            (static_cast<uint64_t>(static_cast<uint8_t>(p[length >> 1])) << 8) |
+            static_cast<uint64_t>(static_cast<uint8_t>(p[length - 1]));
+        b = 0;
+      } else {
+        a = b = 0;
+      }
+    } else {
+      size_t i = length;
+      if (i > 48) {
+        uint64_t see1 = seed;
+        uint64_t see2 = seed;
+        do {
+          seed = WyMix(Read8(p) ^ WYP[1], Read8(p + 8) ^ seed);
+          see1 = WyMix(Read8(p + 16) ^ WYP[2], Read8(p + 24) ^ see1);
+          see2 = WyMix(Read8(p + 32) ^ WYP[3], Read8(p + 40) ^ see2);
+          p += 48;
+          i -= 48;
+        } while (i > 48);
+        seed ^= see1 ^ see2;
+      }
+      while (i > 16) {
+        seed = WyMix(Read8(p) ^ WYP[1], Read8(p + 8) ^ seed);
+        i -= 16;
+        p += 16;
+      }
+      a = Read8(p + i - 16);
+      b = Read8(p + i - 8);
+    }
+    a ^= WYP[1];
+    b ^= seed;
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+    return WyMix(a ^ WYP[0] ^ length, b ^ WYP[1]);
+  }
+
+  /**
+   * CRC32C of the input, consumed 8 bytes per crc32 instruction. CRC is linear, so its 32 bits are run through one
+   * multiply-mix to spread them over the whole 64-bit result.
+   */
+  static inline hash_t Crc32cHash(const char *bytes, size_t length, uint64_t seed) {
+#if defined(__SSE4_2__)
+    uint64_t crc = static_cast<uint32_t>(seed);
+    size_t i = 0;
+    for (; i + 8 <= length; i += 8) {
+      crc = _mm_crc32_u64(crc, Read8(bytes + i));
+    }
+    if (i + 4 <= length) {
+      crc = _mm_crc32_u32(static_cast<uint32_t>(crc), static_cast<uint32_t>(Read4(bytes + i)));
+      i += 4;
+    }
+    for (; i < length; i++) {
+      crc = _mm_crc32_u8(static_cast<uint32_t>(crc), static_cast<uint8_t>(bytes[i]));
+    }
+    return WyMix(crc ^ WYP[0], (length + seed) ^ WYP[1]);
+#else
+    return WyHash(bytes, length, seed);
+#endif
   }
 
-  static inline hash_t SumHashes(hash_t l, hash_t r) { return (l % PRIME_FACTOR + r % PRIME_FACTOR) % PRIME_FACTOR; }
+  static inline hash_t CombineHashes(hash_t l, hash_t r) { return WyMix(l ^ WYP[0], r ^ WYP[1]); }
+
+  /** Order-independent combination: wrapping addition is commutative and associative. */
+  static inline hash_t SumHashes(hash_t l, hash_t r) { return l + r; }
 
   template <typename T>
   static inline hash_t Hash(const T *ptr) {
@@ -98,6 +208,29 @@ class HashUtil {
       }
     }
   }
+
+ private:
+  /** wyhash's default secret. */
+  static constexpr uint64_t WYP[4] = {0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+                                      0x589965cc75374cc3ull};
+
+  /** 64x64->128-bit multiply, folded back to 64 bits. */
+  static inline uint64_t WyMix(uint64_t a, uint64_t b) {
+    __uint128_t product = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+  }
+
+  static inline uint64_t Read8(const char *p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
+
+  static inline uint64_t Read4(const char *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+  }
 };
 
 }  // namespace bustub
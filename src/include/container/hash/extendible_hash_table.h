@@ -14,25 +14,79 @@
 
 #include <queue>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction.h"
+#include "container/hash/extendible_hash_table_iterator.h"
 #include "container/hash/hash_function.h"
 #include "storage/page/hash_table_bucket_page.h"
+#include "storage/page/hash_table_directory_header_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_slotted_bucket_page.h"
 
 namespace bustub {
 
 #define HASH_TABLE_TYPE ExtendibleHashTable<KeyType, ValueType, KeyComparator>
 
+/**
+ * Controls when an ExtendibleHashTable gives space back. Buckets always split as soon as they overflow, but merges
+ * and directory shrinks are held back so that a workload hovering around a split point does not split and merge
+ * the same bucket over and over.
+ */
+struct ExtendibleHashTableOptions {
+  /** A bucket is merged with its split image only if both together fill at most this fraction of one bucket. */
+  double merge_threshold_{0.5};
+  /**
+   * The directory shrinks only once the global depth exceeds every local depth by at least this margin, and then
+   * down to (max local depth + shrink_margin - 1). A margin of 1 shrinks as soon as possible.
+   */
+  uint32_t shrink_margin_{2};
+  /**
+   * Keep the entries of every bucket sorted by key. Inserts and removes shift entries within the bucket, in return
+   * range scans binary-search each bucket instead of filtering all of it.
+   */
+  bool sorted_buckets_{false};
+};
+
+/**
+ * Structural changes an ExtendibleHashTable has made since it was created.
+ */
+struct ExtendibleHashTableStats {
+  uint64_t num_splits_{0};
+  uint64_t num_merges_{0};
+  uint64_t num_directory_grows_{0};
+  uint64_t num_directory_shrinks_{0};
+};
+
+/**
+ * The bucket page layout for a key type: fixed-size keys are kept in an array of key/value pairs, variable-length
+ * keys in a slotted page.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+struct ExtendibleHashTableBucket {
+  using Type = HashTableBucketPage<KeyType, ValueType, KeyComparator>;
+};
+
+template <typename ValueType, typename KeyComparator>
+struct ExtendibleHashTableBucket<VarlenKey, ValueType, KeyComparator> {
+  using Type = HashTableSlottedBucketPage<ValueType, KeyComparator>;
+};
+
 /**
  * Implementation of extendible hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table grows/shrinks dynamically as buckets become full/empty.
+ *
+ * The directory is spread over as many directory pages as the global depth
+ * requires, which a single header page keeps track of. Every lookup touches
+ * exactly three pages: header, directory and bucket.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTable {
+  using BucketPage = typename ExtendibleHashTableBucket<KeyType, ValueType, KeyComparator>::Type;
+
  public:
   /**
    * Creates a new ExtendibleHashTable.
@@ -40,9 +94,11 @@ class ExtendibleHashTable {
    * @param buffer_pool_manager buffer pool manager to be used
    * @param comparator comparator for keys
    * @param hash_fn the hash function
+   * @param options merge and shrink policy
    */
   explicit ExtendibleHashTable(const std::string &name, BufferPoolManager *buffer_pool_manager,
-                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn);
+                               const KeyComparator &comparator, HashFunction<KeyType> hash_fn,
+                               const ExtendibleHashTableOptions &options = ExtendibleHashTableOptions());
 
   /**
    * Inserts a key-value pair into the hash table.
@@ -50,7 +106,8 @@ class ExtendibleHashTable {
    * @param transaction the current transaction
    * @param key the key to create
    * @param value the value to be associated with the key
-   * @return true if insert succeeded, false otherwise
+   * @return true if insert succeeded, false otherwise, e.g. if the pair is already there, or if the bucket of the key
+   * is full and the directory is at MAX_GLOBAL_DEPTH, or no split could move any of its entries away from the key
    */
   bool Insert(Transaction *transaction, const KeyType &key, const ValueType &value);
 
@@ -75,19 +132,48 @@ class ExtendibleHashTable {
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result);
 
   /**
-   * Returns the global depth.  Do not touch.
+   * Returns an iterator over every entry, walking the buckets in directory order. Entries come out in no particular
+   * order across buckets, and in key order within a bucket if buckets are sorted.
+   *
+   * The iterator copies one bucket at a time and holds no latches in between, so it does not block writers. Entries
+   * inserted, removed or moved by a split or merge while the scan is underway may or may not be returned.
+   */
+  ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> Begin();
+
+  /**
+   * Returns an iterator over one of num_partitions disjoint slices of the directory, so that several threads can
+   * scan the table together.
+   *
+   * @param partition which slice to scan, in [0, num_partitions)
+   * @param num_partitions how many slices the directory is cut into
+   */
+  ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> Begin(uint32_t partition, uint32_t num_partitions);
+
+  /**
+   * Returns an iterator over the entries with low <= key <= high. Every bucket is still visited, but sorted buckets
+   * are binary-searched for low and cut off after high.
+   */
+  ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> Begin(const KeyType &low, const KeyType &high);
+
+  /**
+   * Returns the global depth of the logical directory.
    */
   uint32_t GetGlobalDepth();
 
   /**
-   * Helper function to verify the integrity of the extendible hash table's directory.  Do not touch.
+   * Returns the split, merge and directory resize counters.
+   */
+  ExtendibleHashTableStats GetStats();
+
+  /**
+   * Helper function to verify the integrity of the extendible hash table's directory, across all directory pages.
    */
   void VerifyIntegrity();
 
  private:
   /**
-   * Hash - simple helper to downcast MurmurHash's 64-bit hash to 32-bit
-   * for extendible hashing.
+   * Hash - simple helper to downcast the 64-bit hash of the table's HashFunction, with whichever HashAlgorithm it
+   * was configured with, to 32-bit for extendible hashing.
    *
    * @param key the key to hash
    * @return the downcasted 32-bit hash
@@ -95,7 +181,7 @@ class ExtendibleHashTable {
   inline uint32_t Hash(KeyType key);
 
   /**
-   * KeyToDirectoryIndex - maps a key to a directory index
+   * KeyToDirectoryIndex - maps the hash of a key to a directory index
    *
    * In Extendible Hashing we map a key to a directory index
    * using the following hash + mask function.
@@ -106,27 +192,42 @@ class ExtendibleHashTable {
    * upwards.  For example, global depth 3 corresponds to 0x00000007 in a 32-bit
    * representation.
    *
-   * @param key the key to use for lookup
-   * @param dir_page to use for lookup of global depth
-   * @return the directory index
+   * @param hash the hash of the key to use for lookup
+   * @param header_page to use for lookup of global depth
+   * @return the index into the logical directory
    */
-  uint32_t KeyToDirectoryIndex(KeyType key, HashTableDirectoryPage *dir_page);
+  uint32_t KeyToDirectoryIndex(uint32_t hash, HashTableDirectoryHeaderPage *header_page);
 
   /**
    * Get the bucket page_id corresponding to a key.
    *
-   * @param key the key for lookup
-   * @param dir_page a pointer to the hash table's directory page
+   * @param hash the hash of the key for lookup
+   * @param header_page a pointer to the hash table's header page
    * @return the bucket page_id corresponding to the input key
    */
-  page_id_t KeyToPageId(KeyType key, HashTableDirectoryPage *dir_page);
+  page_id_t KeyToPageId(uint32_t hash, HashTableDirectoryHeaderPage *header_page);
 
   /**
-   * Fetches the directory page from the buffer pool manager.
+   * @param header_page a pointer to the hash table's header page
+   * @param bucket_idx an index into the logical directory
+   * @return the page_id of the directory page that holds bucket_idx
+   */
+  page_id_t DirectoryPageIdOf(HashTableDirectoryHeaderPage *header_page, uint32_t bucket_idx);
+
+  /**
+   * Fetches the header page from the buffer pool manager.
    *
+   * @return a pointer to the header page
+   */
+  HashTableDirectoryHeaderPage *FetchHeaderPage();
+
+  /**
+   * Fetches a directory page from the buffer pool manager.
+   *
+   * @param directory_page_id the page_id to fetch
    * @return a pointer to the directory page
    */
-  HashTableDirectoryPage *FetchDirectoryPage();
+  HashTableDirectoryPage *FetchDirectoryPage(page_id_t directory_page_id);
 
   /**
    * Fetches the a bucket page from the buffer pool manager using the bucket's page_id.
@@ -134,7 +235,67 @@ class ExtendibleHashTable {
    * @param bucket_page_id the page_id to fetch
    * @return a pointer to a bucket page
    */
-  HASH_TABLE_BUCKET_TYPE *FetchBucketPage(page_id_t bucket_page_id);
+  BucketPage *FetchBucketPage(page_id_t bucket_page_id);
+
+  /**
+   * Fetches a bucket's raw page, for callers that need to take the page latch.
+   *
+   * @param page_id the page_id to fetch
+   * @return a pointer to the pinned page
+   */
+  Page *FetchPage(page_id_t page_id);
+
+  /**
+   * Allocates a new page, throwing if the buffer pool is out of frames.
+   *
+   * @param[out] page_id the page_id of the new page
+   * @return a pointer to the pinned page
+   */
+  Page *NewPage(page_id_t *page_id);
+
+  /**
+   * Inserts into or removes from a bucket page, keeping it sorted if the table uses sorted buckets. The bucket takes
+   * the fingerprints of its entries from hash, the directory hash of key.
+   */
+  bool BucketInsert(BucketPage *bucket, const KeyType &key, const ValueType &value, uint32_t hash);
+  bool BucketRemove(BucketPage *bucket, const KeyType &key, const ValueType &value, uint32_t hash);
+
+  /**
+   * Checks whether splitting a full bucket, as deep as the directory can go, could ever make room for a key.
+   *
+   * @param bucket the full bucket of the key
+   * @param hash the hash of the key
+   * @return false if every entry in the bucket shares the lowest MAX_GLOBAL_DEPTH bits of hash, so that all of them
+   * would follow the key into the same bucket however often it was split
+   */
+  bool SplitFreesRoom(BucketPage *bucket, uint32_t hash);
+
+  /**
+   * Calls fn(dir_page, slot, bucket_idx) for bucket_idx = first_idx, first_idx + step, ... across the logical
+   * directory, fetching each directory page once. The directory pages are marked dirty.
+   */
+  template <typename F>
+  void ForEachDirectorySlot(HashTableDirectoryHeaderPage *header_page, uint32_t first_idx, uint32_t step, F &&fn);
+
+  /**
+   * Doubles the logical directory, allocating new directory pages once the first one is full.
+   *
+   * @param header_page a pointer to the hash table's header page
+   */
+  void GrowDirectory(HashTableDirectoryHeaderPage *header_page);
+
+  /**
+   * @param header_page a pointer to the hash table's header page
+   * @return the largest local depth in the logical directory
+   */
+  uint32_t MaxLocalDepth(HashTableDirectoryHeaderPage *header_page);
+
+  /**
+   * Halves the logical directory, deleting directory pages that only mirrored the lower half.
+   *
+   * @param header_page a pointer to the hash table's header page
+   */
+  void ShrinkDirectory(HashTableDirectoryHeaderPage *header_page);
 
   /**
    * Performs insertion with an optional bucket splitting.  If the 
@@ -144,33 +305,59 @@ class ExtendibleHashTable {
    * @param transaction a pointer to the current transaction
    * @param key the key to insert
    * @param value the value to insert
+   * @param hash the hash of key
    * @return whether or not the insertion was successful
    */
-  bool SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value);
+  bool SplitInsert(Transaction *transaction, const KeyType &key, const ValueType &value, uint32_t hash);
 
   /**
-   * Optionally merges an empty bucket into it's pair.  This is called by Remove,
-   * if Remove makes a bucket empty.
+   * Optionally merges an underfull bucket into it's pair.  This is called by Remove,
+   * if Remove leaves at most merge_limit_ bytes of entries in a bucket.
    *
    * There are three conditions under which we skip the merge:
-   * 1. The bucket is no longer empty.
+   * 1. The bucket and its split image together hold more than merge_limit_ bytes of entries.
    * 2. The bucket has local depth 0.
    * 3. The bucket's local depth doesn't match its split image's local depth.
-   * 
+   *
+   * After a merge the directory is shrunk according to shrink_margin_.
+   *
    * Note: we do not merge recursively.
    *
    * @param transaction a pointer to the current transaction
    * @param key the key that was removed
    * @param value the value that was removed
+   * @param hash the hash of key
+   */
+  void Merge(Transaction *transaction, const KeyType &key, const ValueType &value, uint32_t hash);
+
+  friend class ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>;
+
+  /**
+   * Copies the entries of the first bucket found at or after directory index bucket_idx. Each bucket is only found
+   * at the lowest directory index pointing to it.
+   *
+   * @param[in,out] bucket_idx where to start looking, set to the directory index of the bucket read
+   * @param end_idx the directory index to stop looking at
+   * @param range if not null, only copy entries with range->first <= key <= range->second
+   * @param[out] entries the copied entries
+   * @return false if no bucket was found before end_idx
    */
-  void Merge(Transaction *transaction, const KeyType &key, const ValueType &value);
+  bool ReadBucket(uint32_t *bucket_idx, uint32_t end_idx, const std::pair<KeyType, KeyType> *range,
+                  std::vector<MappingType> *entries);
 
   // member variables
-  page_id_t directory_page_id_;
+  page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
+  uint32_t merge_limit_;
+  uint32_t shrink_margin_;
+  bool sorted_buckets_;
+  ExtendibleHashTableStats stats_;
 
-  // Readers includes inserts and removes, writers are splits and merges
+  // Guards the header and directory pages. Readers include lookups, inserts and removes, which additionally latch
+  // the one bucket page they touch (shared for lookups, exclusive otherwise). Writers are splits and merges, which
+  // restructure the directory and may touch any bucket, so they need no page latches. stats_ is only written under
+  // the exclusive latch.
   ReaderWriterLatch table_latch_;
   HashFunction<KeyType> hash_fn_;
 };
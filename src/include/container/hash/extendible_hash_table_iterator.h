@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extendible_hash_table_iterator.h
+//
+// Identification: src/include/container/hash/extendible_hash_table_iterator.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTable;
+
+#define HASH_TABLE_ITERATOR_TYPE ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator>
+
+/**
+ * Full scan of an extendible hash table, one bucket at a time in directory order. The current bucket is copied out
+ * of its page, so the iterator holds no pins or latches while it is being consumed.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExtendibleHashTableIterator {
+ public:
+  /**
+   * @param table the table to scan
+   * @param begin_idx the first directory index to scan
+   * @param end_idx the directory index to stop at, clamped to the directory size
+   * @param range if not null, only return entries with range->first <= key <= range->second
+   */
+  ExtendibleHashTableIterator(ExtendibleHashTable<KeyType, ValueType, KeyComparator> *table, uint32_t begin_idx,
+                              uint32_t end_idx, const std::pair<KeyType, KeyType> *range);
+
+  bool IsEnd();
+
+  const MappingType &operator*();
+
+  ExtendibleHashTableIterator &operator++();
+
+ private:
+  /** Reads buckets until one of them has entries to return, or the scan is over. */
+  void NextBucket();
+
+  ExtendibleHashTable<KeyType, ValueType, KeyComparator> *table_;
+  uint32_t next_idx_;
+  uint32_t end_idx_;
+  bool has_range_;
+  std::pair<KeyType, KeyType> range_;
+  std::vector<MappingType> entries_;
+  size_t offset_{0};
+};
+
+}  // namespace bustub
@@ -14,23 +14,33 @@
 
 #include <cstdint>
 
-#include "murmur3/MurmurHash3.h"
+#include "common/util/hash_util.h"
 
 namespace bustub {
 
 template <typename KeyType>
 class HashFunction {
  public:
+  /** Hashes keys with HashUtil::DEFAULT_HASH_ALGORITHM. */
+  HashFunction() = default;
+
+  /**
+   * @param algorithm the algorithm used to hash the bytes of a key
+   */
+  explicit HashFunction(HashAlgorithm algorithm) : algorithm_(algorithm) {}
+
+  virtual ~HashFunction() = default;
+
   /**
    * @param key the key to be hashed
    * @return the hashed value
    */
   virtual uint64_t GetHash(KeyType key) {
-    uint64_t hash[2];
-    murmur3::MurmurHash3_x64_128(reinterpret_cast<const void *>(&key), static_cast<int>(sizeof(KeyType)), 0,
-                                 reinterpret_cast<void *>(&hash));
-    return hash[0];
+    return HashUtil::HashBytes(algorithm_, reinterpret_cast<const char *>(&key), sizeof(KeyType));
   }
+
+ private:
+  HashAlgorithm algorithm_{HashUtil::DEFAULT_HASH_ALGORITHM};
 };
 
 }  // namespace bustub
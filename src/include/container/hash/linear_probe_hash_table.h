@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <vector>
@@ -28,10 +29,31 @@ namespace bustub {
 
 #define HASH_TABLE_TYPE LinearProbeHashTable<KeyType, ValueType, KeyComparator>
 
+/**
+ * Probe lengths of the entries in a LinearProbeHashTable, i.e. how many slots a lookup examines to find each one.
+ */
+struct LinearProbeHashTableStats {
+  size_t num_entries_{0};
+  double avg_probe_length_{0};
+  size_t max_probe_length_{0};
+};
+
 /**
  * Implementation of linear probing hash table that is backed by a buffer pool
  * manager. Non-unique keys are supported. Supports insert and delete. The
  * table dynamically grows once full.
+ *
+ * Growing is incremental: a resize only allocates the header page of a table twice the size, and every later insert
+ * or remove migrates a bounded number of block pages from the old table into the new one. Until the last old block
+ * has been migrated, lookups consult both tables.
+ *
+ * Entries are placed by Robin Hood hashing, which keeps every run sorted by distance from the home slot, and removed
+ * by backward-shift deletion, so the table never accumulates tombstones. Only the old table of a resize uses
+ * tombstones, since it is dropped once migrated.
+ *
+ * Inserts and removes share the table latch with lookups and write-latch the block pages of the run they change, in
+ * block order. The table latch is only taken exclusively to change the table itself: to allocate a block page, to
+ * grow or migrate a resize, or for a run that wraps around past the last block page.
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
 class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator> {
@@ -75,7 +97,8 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
   bool GetValue(Transaction *transaction, const KeyType &key, std::vector<ValueType> *result) override;
 
   /**
-   * Resizes the table to at least twice the initial size provided.
+   * Resizes the table to at least twice the initial size provided. Any resize still in progress is finished first;
+   * the entries are then migrated to the new table by subsequent inserts and removes.
    * @param initial_size the initial size of the hash table
    */
   void Resize(size_t initial_size);
@@ -86,13 +109,154 @@ class LinearProbeHashTable : public HashTable<KeyType, ValueType, KeyComparator>
    */
   size_t GetSize();
 
+  /**
+   * @return true while entries are still being migrated from the table before the last resize
+   */
+  bool IsResizing();
+
+  /**
+   * Scans the whole table to compute the average and maximum probe length of its entries.
+   * @return the probe length statistics
+   */
+  LinearProbeHashTableStats GetStats();
+
  private:
+  /** Fraction of slots that may be occupied before an insert starts growing the table. */
+  static constexpr double MAX_LOAD_FACTOR = 0.75;
+
+  /**
+   * Old block pages migrated by each insert or remove during a resize. The new table has room for at least twice the
+   * entries of the old one, so even a single block per operation finishes migrating long before it fills up.
+   */
+  static constexpr size_t RESIZE_BLOCKS_PER_OPERATION = 1;
+
+  /**
+   * Creates the header page of an empty table. Its block pages are allocated the first time an insert probes them.
+   *
+   * @param num_buckets number of slots in the table, rounded up to whole block pages
+   * @param[out] header_page_id the page_id of the new header page
+   */
+  void NewTable(size_t num_buckets, page_id_t *header_page_id);
+
+  /**
+   * @return how many slots past its home slot an entry with this key sits at slot
+   */
+  size_t Distance(const KeyType &key, size_t slot, size_t size);
+
+  /**
+   * Calls fn(block_page, offset, slot, &is_dirty) for every slot along the probe sequence of key, starting at its
+   * home slot, until fn returns false or every slot has been visited. fn sets is_dirty when it changes the slot, so
+   * that only changed block pages are marked dirty. Probing also stops at a block page that was never allocated,
+   * unless allocate is set. Block pages are read-latched if latch is set.
+   * @return true if a block page was allocated, in which case the caller must mark the header page dirty
+   */
+  template <typename F>
+  bool ProbeSlots(HashTableHeaderPage *header_page, const KeyType &key, bool allocate, bool latch, F &&fn);
+
+  /**
+   * Write-latches the block pages along the probe sequence of key in block order, calling fn(block_page, offset,
+   * slot) for every slot until it returns false.
+   * @param[out] pages the latched block pages, still pinned
+   * @return false, with nothing latched, if the run reaches a block page that was never allocated or wraps around
+   * past the last block page
+   */
+  template <typename F>
+  bool LatchRun(HashTableHeaderPage *header_page, const KeyType &key, std::vector<Page *> *pages, F &&fn);
+
+  /**
+   * Unlatches and unpins the block pages of LatchRun.
+   */
+  void UnlatchRun(std::vector<Page *> *pages);
+
+  /**
+   * Inserts the key-value pair into the current table under the shared table latch.
+   * @param[out] inserted false if the table already holds the pair
+   * @return false if the insert needs the table latch exclusively
+   */
+  bool InsertShared(const KeyType &key, const ValueType &value, bool *inserted);
+
+  /**
+   * Removes the key-value pair from the current table under the shared table latch.
+   * @param[out] removed false if the table does not hold the pair
+   * @return false if the remove needs the table latch exclusively
+   */
+  bool RemoveShared(const KeyType &key, const ValueType &value, bool *removed);
+
+  /**
+   * @return true if the current table has more entries than MAX_LOAD_FACTOR allows
+   */
+  bool IsOverloaded();
+
+  /**
+   * Collects the values of key stored in one table.
+   */
+  bool GetValueFrom(page_id_t header_page_id, const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Looks for the key-value pair in one table.
+   * @param[out] slot the slot holding the pair, if found
+   * @return true if the table holds the pair
+   */
+  bool FindSlot(HashTableHeaderPage *header_page, const KeyType &key, const ValueType &value, size_t *slot);
+
+  /**
+   * @return true if one table holds the key-value pair
+   */
+  bool Contains(page_id_t header_page_id, const KeyType &key, const ValueType &value);
+
+  /**
+   * Stores the key-value pair in the current table, without checking for duplicates.
+   * @return false if the table has no free slot left
+   */
+  bool InsertInto(const KeyType &key, const ValueType &value);
+
+  /**
+   * Removes the key-value pair from the current table by backward-shift deletion.
+   */
+  bool RemoveFrom(const KeyType &key, const ValueType &value);
+
+  /**
+   * Removes the key-value pair from the old table of a resize, leaving a tombstone.
+   */
+  bool RemoveFromOld(const KeyType &key, const ValueType &value);
+
+  /**
+   * Starts growing the table to twice its size.
+   * @return false if a resize is still in progress, or the header page cannot address a table that large
+   */
+  bool Grow();
+
+  /**
+   * Makes the current table the old one and starts migrating it into a new, empty table.
+   * @param num_buckets number of slots in the new table
+   */
+  void BeginResize(size_t num_buckets);
+
+  /**
+   * Migrates up to num_blocks block pages of the old table into the current one, and drops the old table once it
+   * has been migrated completely.
+   */
+  void MigrateBlocks(size_t num_blocks);
+
+  // Fetch and allocate pages, throwing if the buffer pool is out of frames
+  HashTableHeaderPage *FetchHeaderPage(page_id_t header_page_id);
+  HASH_TABLE_BLOCK_TYPE *FetchBlockPage(page_id_t block_page_id);
+  Page *FetchPage(page_id_t page_id);
+  Page *NewPage(page_id_t *page_id);
+
   // member variable
   page_id_t header_page_id_;
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
 
-  // Readers includes inserts and removes, writer is only resize
+  // The table being migrated away from during a resize, or INVALID_PAGE_ID
+  page_id_t old_header_page_id_{INVALID_PAGE_ID};
+  // The next block of the old table to migrate
+  size_t next_migrate_block_{0};
+  // Occupied slots in the current table
+  std::atomic<size_t> num_occupied_{0};
+
+  // Shared by lookups, inserts and removes, which latch block pages; exclusive to change the table itself
   ReaderWriterLatch table_latch_;
 
   // Hash function
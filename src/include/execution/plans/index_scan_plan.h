@@ -12,13 +12,38 @@
 
 #pragma once
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "catalog/catalog.h"
 #include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
 #include "execution/plans/abstract_plan.h"
 
 namespace bustub {
+/**
+ * One end of the range of keys that an index scan covers.
+ */
+struct IndexScanBound {
+  /** The values of the key columns, in the order of the index key schema; empty if the range is open at this end. */
+  std::vector<Value> key_;
+  /** Whether keys equal to the bound are in the range. */
+  bool inclusive_{true};
+
+  /** @return whether the range is bounded at this end */
+  bool IsBounded() const { return !key_.empty(); }
+};
+
 /**
  * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ *
+ * The scan may be limited to a range of keys of an ordered index, in which case only the keys in the range are read
+ * and the predicate is tested on their tuples. Without bounds the whole index is scanned.
+ *
+ * An index-only scan never reads the table: it rebuilds each tuple from its key with Tuple::TupleFromKey, leaving the
+ * columns the index does not store NULL, so it may only be planned when IsCovering holds for its output schema and
+ * predicate.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -28,9 +53,35 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * @param predicate the predicate to scan with, tuples are returned if predicate(tuple) == true or predicate ==
    * nullptr
    * @param table_oid the identifier of table to be scanned
+   * @param low the lower bound of the keys to scan
+   * @param high the upper bound of the keys to scan
+   * @param index_only whether to read the tuples from the index keys instead of the table
    */
-  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid)
-      : AbstractPlanNode(output, {}), predicate_{predicate}, index_oid_(index_oid) {}
+  IndexScanPlanNode(const Schema *output, const AbstractExpression *predicate, index_oid_t index_oid,
+                    IndexScanBound low = {}, IndexScanBound high = {}, bool index_only = false)
+      : AbstractPlanNode(output, {}),
+        predicate_{predicate},
+        index_oid_(index_oid),
+        low_(std::move(low)),
+        high_(std::move(high)),
+        index_only_(index_only) {}
+
+  /**
+   * @return whether an index scan with the given output schema and predicate can be answered from the keys of
+   * index_info alone, i.e. the index stores its keys in full and every column they read is a key column
+   */
+  static bool IsCovering(const Schema *output, const AbstractExpression *predicate, const IndexInfo *index_info) {
+    if (!index_info->index_->StoresFullKeys()) {
+      return false;
+    }
+    const auto &key_attrs = index_info->index_->GetKeyAttrs();
+    if (predicate != nullptr && !ReadsOnly(predicate, key_attrs)) {
+      return false;
+    }
+    return std::all_of(output->GetColumns().begin(), output->GetColumns().end(), [&key_attrs](const Column &column) {
+      return column.GetExpr() == nullptr || ReadsOnly(column.GetExpr(), key_attrs);
+    });
+  }
 
   PlanType GetType() const override { return PlanType::IndexScan; }
 
@@ -40,11 +91,34 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** @return the identifier of the table that should be scanned */
   index_oid_t GetIndexOid() const { return index_oid_; }
 
+  /** @return the lower bound of the keys to scan */
+  const IndexScanBound &GetLowBound() const { return low_; }
+
+  /** @return the upper bound of the keys to scan */
+  const IndexScanBound &GetHighBound() const { return high_; }
+
+  /** @return whether the tuples should be read from the index keys instead of the table */
+  bool IsIndexOnly() const { return index_only_; }
+
  private:
+  /** @return whether expr only reads the columns in key_attrs */
+  static bool ReadsOnly(const AbstractExpression *expr, const std::vector<uint32_t> &key_attrs) {
+    if (const auto *column = dynamic_cast<const ColumnValueExpression *>(expr); column != nullptr) {
+      return std::find(key_attrs.begin(), key_attrs.end(), column->GetColIdx()) != key_attrs.end();
+    }
+    return std::all_of(expr->GetChildren().begin(), expr->GetChildren().end(),
+                       [&key_attrs](const AbstractExpression *child) { return ReadsOnly(child, key_attrs); });
+  }
+
   /** The predicate that all returned tuples must satisfy. */
   const AbstractExpression *predicate_;
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
+  /** The range of keys to scan. */
+  IndexScanBound low_;
+  IndexScanBound high_;
+  /** Whether to read the tuples from the index keys. */
+  bool index_only_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.h
+//
+// Identification: src/include/storage/index/adaptive_radix_tree.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/macros.h"
+#include "common/rid.h"
+#include "common/rwlatch.h"
+
+namespace bustub {
+
+/**
+ * An in-memory adaptive radix tree, after Leis et al., "The Adaptive Radix Tree: ARTful Indexing for Main-Memory
+ * Databases", mapping byte string keys to RIDs.
+ *
+ * Each inner node branches on one byte of the key, and grows through four layouts as it fills up: Node4 and Node16
+ * keep their key bytes sorted next to their children, and Node16 compares all of them at once with SSE2 where
+ * available; Node48 maps every byte to one of its 48 child slots, and Node256 indexes its children by byte. An inner
+ * node also keeps the bytes that all keys below it share, so no chains of single-child nodes are built. Leaves keep
+ * their whole key, and the RIDs stored under it.
+ *
+ * Keys are ordered byte by byte as memcmp orders them. No key may be a proper prefix of another, which holds for the
+ * keys KeyEncoder encodes for one key schema.
+ *
+ * The tree lives outside the buffer pool, and is not persisted. A single reader-writer latch guards all of it.
+ */
+class AdaptiveRadixTree {
+ public:
+  /**
+   * @param unique whether each key may only be stored once; a non-unique tree keeps any number of RIDs per key
+   */
+  explicit AdaptiveRadixTree(bool unique = true);
+
+  ~AdaptiveRadixTree();
+
+  DISALLOW_COPY_AND_MOVE(AdaptiveRadixTree);
+
+  bool IsEmpty() const { return root_ == nullptr; }
+
+  bool IsUnique() const { return unique_; }
+
+  /**
+   * Stores rid under key.
+   * @return false if the tree is unique and already has the key, or already has the key with rid
+   */
+  bool Insert(const std::string &key, RID rid);
+
+  /**
+   * Removes rid from under key, and the key once no RID is left. A unique tree removes the key whatever its RID.
+   * @return false if the entry was not found
+   */
+  bool Remove(const std::string &key, RID rid);
+
+  /**
+   * Appends the RIDs stored under key to result.
+   * @return whether the key was found
+   */
+  bool GetValue(const std::string &key, std::vector<RID> *result);
+
+  /**
+   * Calls callback with the key and each RID of the keys from low on, in key order, until it returns false. The
+   * callback must not modify the tree.
+   * @param low the smallest key to scan, or nullptr to start at the smallest key of the tree
+   * @param low_inclusive whether to scan low itself
+   */
+  void Scan(const std::string *low, bool low_inclusive,
+            const std::function<bool(const std::string &, RID)> &callback);
+
+ private:
+  struct Node;
+  struct Leaf;
+  struct Node4;
+  struct Node16;
+  struct Node48;
+  struct Node256;
+
+  bool InsertInto(std::unique_ptr<Node> *node_ref, const std::string &key, size_t depth, RID rid);
+
+  bool RemoveFrom(std::unique_ptr<Node> *node_ref, const std::string &key, size_t depth, RID rid);
+
+  /**
+   * Scans the keys below node, which are depth bytes into the key, and calls callback for the ones from low on.
+   * @param low the smallest key to scan, or nullptr if all keys below node are past it
+   * @return false once callback has returned false
+   */
+  static bool ScanFrom(const Node *node, size_t depth, const std::string *low, bool low_inclusive,
+                       const std::function<bool(const std::string &, RID)> &callback);
+
+  // whether the prefix of node matches key at depth
+  static bool PrefixMatches(const Node *node, const std::string &key, size_t depth);
+
+  // the child of node under byte, or nullptr if there is none
+  static std::unique_ptr<Node> *FindChild(Node *node, uint8_t byte);
+
+  // adds child under byte, first replacing a full node with a larger one
+  static void AddChild(std::unique_ptr<Node> *node_ref, uint8_t byte, std::unique_ptr<Node> child);
+
+  // removes the empty child slot under byte, then replaces a sparse node with a smaller one
+  static void RemoveChild(std::unique_ptr<Node> *node_ref, uint8_t byte);
+
+  // calls visit with each child from byte from on, in byte order, until it returns false
+  template <typename Visitor>
+  static bool ForEachChild(const Node *node, uint8_t from, const Visitor &visit);
+
+  /** Whether each key may only be stored once. */
+  const bool unique_;
+  /** The root, which is a leaf while the tree has one key, and nullptr while it has none. */
+  std::unique_ptr<Node> root_;
+  ReaderWriterLatch latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_index.h
+//
+// Identification: src/include/storage/index/adaptive_radix_tree_index.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/index.h"
+
+namespace bustub {
+
+/**
+ * An ordered index kept in memory, in an adaptive radix tree over the keys encoded by KeyEncoder.
+ *
+ * Unlike BPlusTreeIndex it takes keys of any length, and reaches its entries without going through the buffer pool,
+ * but it is not persisted: it has to be rebuilt from its table after a restart.
+ */
+class AdaptiveRadixTreeIndex : public Index {
+ public:
+  explicit AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata);
+
+  ~AdaptiveRadixTreeIndex() override = default;
+
+  void InsertEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) override;
+
+  void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
+
+  void ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                 const std::function<bool(RID)> &callback, Transaction *transaction) override;
+
+  void ScanRangeKeys(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                     const std::function<bool(const Tuple &, RID)> &callback, Transaction *transaction) override;
+
+  // the tree keeps the whole encoded key of every entry
+  bool StoresFullKeys() const override { return true; }
+
+ protected:
+  /**
+   * Calls callback with the encoded key and the RID of each entry between low and high, in key order, until it
+   * returns false.
+   */
+  void ScanEntries(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                   const std::function<bool(const std::string &, RID)> &callback);
+
+  AdaptiveRadixTree container_;
+};
+
+}  // namespace bustub
@@ -10,11 +10,22 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <map>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "concurrency/transaction.h"
+#include "storage/index/external_sort.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -23,15 +34,96 @@ namespace bustub {
 
 #define BPLUSTREE_TYPE BPlusTree<KeyType, ValueType, KeyComparator>
 
+/**
+ * How the operations on a BPlusTree have synchronized since it was created.
+ */
+struct BPlusTreeConcurrencyStats {
+  // operations that completed optimistically, latching at most the leaf
+  uint64_t num_optimistic_ops_{0};
+  // optimistic descents that were restarted because a page changed underneath them
+  uint64_t num_restarts_{0};
+  // operations that fell back to latch crabbing from the root
+  uint64_t num_pessimistic_ops_{0};
+};
+
+/**
+ * The shape of a BPlusTree, as CollectStats found it.
+ */
+template <typename KeyType>
+struct BPlusTreeStats {
+  // one level of pages, all at the same distance from the root
+  struct Level {
+    // pages at this level, all of which are counted even where only some are read
+    uint64_t num_pages_{0};
+    // pages read
+    uint64_t num_pages_read_{0};
+    // entries in the pages read: children of internal pages, keys of leaves
+    uint64_t num_entries_read_{0};
+    // how full the pages read are, as the fraction of their max size that they hold
+    double avg_fill_{0};
+    double min_fill_{0};
+    // pages read that hold fewer entries than their min size, not counting the root
+    uint64_t num_underflowing_{0};
+  };
+
+  // the number of levels, 0 for an empty tree and 1 for a tree that is a single leaf
+  int height_{0};
+  // the levels from the root down to the leaves
+  std::vector<Level> levels_;
+  // the entries of the tree, estimated from the leaves read if not all were
+  uint64_t num_entries_{0};
+  // the fraction of leaves read whose right sibling is not the next page on disk, so a range scan seeks to it
+  double leaf_fragmentation_{0};
+  // An equi-depth histogram of the keys: the smallest key of each bucket, and the entries estimated from it up to
+  // the key of the next bucket, in key order. The keys are as KeyOf returns them.
+  std::vector<std::pair<KeyType, uint64_t>> key_distribution_;
+};
+
 /**
  * Main class providing the API for the Interactive B+ Tree.
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) Keys are unique, unless the tree is created non-unique (see below)
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * Concurrency control is optimistic lock coupling. Lookups descend without
+ * latching any page, remembering each page's version and validating it once
+ * they have read what they need from the page (see BPlusTreePage). Inserts and
+ * removes descend the same way and only write-latch the leaf; if the leaf
+ * would split or underflow, or anything changed on the way down, they retry,
+ * and after a few failed attempts fall back to write-latch crabbing from the
+ * root. A lookup that keeps failing validation falls back to read-latch
+ * crabbing. Writers make the version of every page they modify odd until they
+ * release its latch, so optimistic readers never accept a half-modified page.
+ *
+ * Pages that a writer deletes while an optimistic reader still has them pinned
+ * cannot be deleted from the buffer pool right away; they are retried after
+ * later pessimistic operations.
+ *
+ * Leaves link to both their neighbours, so that index iterators can run either
+ * way. The link back from a leaf's right sibling is only updated after the
+ * writer that split or merged the leaf has released its latches, so iterators
+ * running backwards check it against the forward link.
+ *
+ * A non-unique tree holds any number of values for the same key. Each entry is
+ * stored under its key with the last sizeof(ValueType) bytes replaced by the
+ * bytes of its value, which makes the stored keys unique again, so splits,
+ * merges and the concurrency control work on them unchanged. The entries of a
+ * key therefore sit next to each other, ordered by the bytes of their values,
+ * and lookups scan them as a range. This relies on the comparator ordering
+ * keys by all of their bytes, as GenericComparator does, and cuts the keys
+ * themselves short by the size of a value.
+ *
+ * Writes may also be buffered ahead of the tree, see SetWriteBufferSize, and
+ * merges deferred until later, see SetDeferredMerges.
+ *
+ * Operations read the root page id from memory. It is kept on disk in a meta
+ * page of the tree's own, which is written whenever the root changes, while
+ * the header page that all indexes share is only written once per tree, to
+ * record where its meta page is.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTree {
@@ -40,24 +132,152 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool unique = true);
+
+  // Stops background rebalancing and flushes the write buffer, so the buffer pool has to outlive a tree that buffers
+  // writes.
+  ~BPlusTree();
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  // Whether each key has at most one value, see the class comment.
+  bool IsUnique() const { return unique_; }
+
+  // Insert a key-value pair into this B+ tree. Returns false if the key, or in a non-unique tree the key-value pair,
+  // is already there.
   bool Insert(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and its value, or in a non-unique tree all of its values, from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a key-value pair from this B+ tree. A unique tree removes the key whatever its value.
+  void Remove(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+
+  // return the values associated with a given key
   bool GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction = nullptr);
 
+  /**
+   * The key that an entry was inserted under, as far as the tree keeps it: in a non-unique tree, iterators return
+   * the keys entries are stored under, which KeyOf turns back into comparable keys. Keys are returned as they are by
+   * a unique tree.
+   */
+  KeyType KeyOf(const KeyType &key) const;
+
+  /**
+   * Looks up many keys at once, as GetValue does one by one. The pages on the way to the last leaf stay pinned, and
+   * each following key is looked up from the lowest of them whose key range still covers it, so keys that fall into
+   * the same leaf or subtree as the key before them only cost a search of that page. Sorted keys therefore descend
+   * from the root only once per leaf they hit, but the keys may come in any order.
+   * @param[out] result the values of the keys found, in the order of the keys. A non-unique tree looks its keys up one
+   * by one.
+   * @return for each key, whether it was found
+   */
+  std::vector<bool> MultiGet(const std::vector<KeyType> &keys, std::vector<ValueType> *result,
+                             Transaction *transaction = nullptr);
+
+  /**
+   * Builds the tree bottom-up from entries sorted by key: the leaves are filled from left to right, then each level
+   * of internal pages above them, so no page is ever split. Of several entries with the same key only the first is
+   * loaded, as with Insert, unless the tree is non-unique.
+   * @param fill_factor the fraction of each page to fill, leaving room for later inserts. Pages are never filled
+   * below their minimum size.
+   * @return false if the tree is not empty
+   */
+  bool BulkLoad(const MappingType *begin, const MappingType *end, double fill_factor = 1.0);
+
+  /**
+   * Builds the tree bottom-up like BulkLoad, from entries in any order, which next produces one by one until it
+   * returns false. The entries are sorted by an ExternalSort, which holds no more than run_size of them in memory and
+   * spills the rest to pages of the buffer pool. Of several entries with the same key only the first one produced is
+   * loaded, unless the tree is non-unique.
+   * @return false if the tree is not empty, in which case next is never called
+   */
+  bool BulkLoadUnsorted(const std::function<bool(MappingType *)> &next, double fill_factor = 1.0,
+                        size_t run_size = ExternalSort<KeyType, ValueType, KeyComparator>::DEFAULT_RUN_SIZE);
+
   // index iterator
   INDEXITERATOR_TYPE Begin();
   INDEXITERATOR_TYPE Begin(const KeyType &key);
   INDEXITERATOR_TYPE End();
+  // index iterators that run backwards, in descending key order, from the last entry or the last entry not greater
+  // than key; they also end at End()
+  INDEXITERATOR_TYPE RBegin();
+  INDEXITERATOR_TYPE RBegin(const KeyType &key);
+
+  /**
+   * Buffers up to size inserts and removes instead of applying each to its leaf right away. Once the buffer is full,
+   * it is flushed down the tree in key order, so the writes that go to the same leaf are applied one after the other
+   * while the leaf is in the buffer pool, rather than scattered over the whole tree. Lookups pay for it by merging
+   * the buffer into what they read from the tree. This is the message buffer of a B-epsilon tree, kept for the root
+   * only, as the pages of this tree have no room for one.
+   *
+   * Inserts still look their key up, to return whether it is already there, but removes are blind. Iterators, bulk
+   * loads and removing every value of a key in a non-unique tree flush the buffer first, and IsEmpty only sees what
+   * was flushed. The size must not change while other operations run.
+   *
+   * The buffer is kept in memory only and its writes are not logged, so writes that were not flushed yet are lost
+   * on a crash. It is therefore off unless a size is set: a size of 0, the default, flushes the buffer and applies
+   * every write right away.
+   */
+  void SetWriteBufferSize(size_t size);
+
+  /**
+   * Applies the buffered writes to the tree. The buffer is swapped out for an empty one first, so writes and lookups
+   * go on while the flush runs, and the flush descends the tree once per leaf it writes to, applying every write
+   * that falls into the leaf under a single latch. Writes that would split or underflow their leaf are applied one
+   * by one. One flush runs at a time.
+   */
+  void FlushWriteBuffer(Transaction *transaction = nullptr);
+
+  /**
+   * Lets removes leave a leaf underflowing instead of merging or redistributing it right away, as long as the leaf
+   * keeps at least one entry. The remove then only latches the leaf, as if it were safe, and records the leaf as a
+   * candidate for Rebalance, which latches its parent and sibling later, off the path of the remove. A leaf that is
+   * refilled before then is never merged at all, rather than merged and split again.
+   *
+   * Removes that would empty a leaf, and those that fall back to latch crabbing, still rebalance right away. Turning
+   * deferral off rebalances the candidates left. Deferral must not be switched while other operations run.
+   */
+  void SetDeferredMerges(bool deferred);
+
+  /**
+   * Merges or redistributes the leaves recorded by removes with deferred merges, those that still underflow. Each
+   * leaf is reached by an optimistic descent, then only it, its parent and its sibling are latched, as long as the
+   * parent keeps enough children; otherwise the leaf is rebalanced by write-latch crabbing from the root, as a remove
+   * would.
+   * @return the number of leaves merged or redistributed
+   */
+  size_t Rebalance(Transaction *transaction = nullptr);
+
+  // calls Rebalance on a thread of its own every interval, until stopped or the tree is destroyed
+  void StartBackgroundRebalance(std::chrono::milliseconds interval);
+  void StopBackgroundRebalance();
+
+  /**
+   * Takes up the tree that the header page records under the name of this one, for instance after the buffer pool
+   * was restarted on the same database file. The tree must not be in use yet.
+   * @return false if the header page has no record of the tree
+   */
+  bool Open();
+
+  // how the operations so far have synchronized
+  BPlusTreeConcurrencyStats GetConcurrencyStats() const;
+
+  /**
+   * Walks the tree to find its height, the pages and entries on each level, how full they are, and how its keys are
+   * distributed, for instance to decide when to rebuild it. Every internal page is read, but only about
+   * sample_rate of the leaves, spread evenly over the tree; the leaf level's page count is still exact, taken from
+   * the leaves' parents, while its entries and fill are estimated from the leaves read.
+   *
+   * The walk read-latches one page at a time, so writers carry on meanwhile, and it is exact only on a tree that is
+   * not being written to: where a page changes while its children are walked, the rest of them are skipped. Buffered
+   * writes are not counted.
+   * @param sample_rate the fraction of leaves to read, greater than 0 and at most 1
+   * @param num_buckets the buckets of the key distribution, which has fewer if there are fewer leaves read
+   */
+  BPlusTreeStats<KeyType> CollectStats(double sample_rate = 1.0, size_t num_buckets = 16);
 
   void Print(BufferPoolManager *bpm) {
     ToString(reinterpret_cast<BPlusTreePage *>(bpm->FetchPage(root_page_id_)->GetData()), bpm);
@@ -80,9 +300,246 @@ class BPlusTree {
   Page *FindLeafPage(const KeyType &key, bool leftMost = false);
 
  private:
+  friend class INDEXITERATOR_TYPE;
+
+  enum class Operation { INSERT, REMOVE };
+
+  // which leaf an optimistic descent ends at: the one covering its key, or the left or right most one
+  enum class LeafEdge { NONE, LEFT_MOST, RIGHT_MOST };
+
+  // the page a bulk load is filling at one level of the tree
+  struct BulkLoadCursor {
+    Page *page_{nullptr};
+    // pages started at this level so far
+    size_t num_pages_{0};
+    // entries in the current page
+    int size_{0};
+  };
+
+  // a leaf whose right sibling has to be linked back to it once the writer has released its latches
+  struct PrevLink {
+    // pinned until then
+    Page *page_{nullptr};
+    // the leaf merged into page, which the sibling linked back to so far, also pinned
+    Page *merged_page_{nullptr};
+  };
+
+  // a page on the path of a MultiGet, pinned, with its version and the key range its parent directed to it
+  struct PathLevel {
+    Page *page_{nullptr};
+    uint32_t version_{0};
+    // the range runs from low_ up to, but not including, high_; either end is open if it is not bounded
+    KeyType low_{};
+    KeyType high_{};
+    bool has_low_{false};
+    bool has_high_{false};
+  };
+
+  // a write waiting in the write buffer, for the key an entry is stored under
+  struct BufferedWrite {
+    // an insert, or else a remove
+    bool insert_{false};
+    ValueType value_{};
+    // whether the insert replaces an entry that is still in the tree, which was removed while buffered
+    bool replaces_{false};
+  };
+
+  // a leaf that CollectStats read
+  struct LeafSample {
+    KeyType first_key_{};
+    int size_{0};
+    page_id_t page_id_{INVALID_PAGE_ID};
+    page_id_t next_page_id_{INVALID_PAGE_ID};
+  };
+
+  // orders the keys of the write buffer
+  struct KeyLess {
+    bool operator()(const KeyType &lhs, const KeyType &rhs) const { return (*comparator_)(lhs, rhs) < 0; }
+    const KeyComparator *comparator_;
+  };
+
+  // optimistic attempts before an operation falls back to latch crabbing
+  static constexpr int MAX_OPTIMISTIC_ATTEMPTS = 8;
+
+  /**
+   * Descends to the leaf covering key, or the left or right most leaf, without latching any page.
+   * @param[out] leaf_page the pinned leaf, or nullptr if the tree is empty
+   * @param[out] version the version of the leaf when it was reached
+   * @return false if a page changed during the descent, in which case nothing is left pinned
+   */
+  bool FindLeafOptimistic(const KeyType &key, LeafEdge edge, Page **leaf_page, uint32_t *version);
+
+  /**
+   * Descends to the leaf covering key without latching any page, from the lowest page on path whose key range covers
+   * key, or from the root if there is none, leaving the pages on the way pinned on path. A page's key range only
+   * changes with the page itself, so a page that still has the version it was read at covers what it covered then.
+   * @return false if a page changed since it was read, in which case path is left for the caller to release. An
+   * empty path means the tree is empty.
+   */
+  bool FindLeafFromPath(const KeyType &key, std::vector<PathLevel> *path);
+
+  // unpins the pages on path
+  void ReleasePath(std::vector<PathLevel> *path);
+
+  // looks key up by read-latch crabbing, once optimistic lookups gave up
+  bool GetValuePessimistic(const KeyType &key, std::vector<ValueType> *result);
+
+  /**
+   * Descends to the leaf covering key, or the leaf at edge, by read-latch crabbing.
+   * @return the pinned and read-latched leaf, or nullptr if the tree is empty
+   */
+  Page *FindLeafPageShared(const KeyType &key, LeafEdge edge);
+
+  /**
+   * Descends to the leaf covering key by write-latch crabbing, starting with the root latch held. Every page that
+   * the operation may have to modify is left latched in the transaction's page set, in root-to-leaf order.
+   * @return the pinned and write-latched leaf
+   */
+  Page *FindLeafPageExclusive(const KeyType &key, Operation operation, Transaction *transaction);
+
+  /**
+   * Whether the operation on key cannot split or underflow node, so its ancestors can be released. As pages are
+   * compressed, an internal page is only safe if it can take any key, be it a new child's or a replaced one's,
+   * without splitting.
+   */
+  bool IsSafe(BPlusTreePage *node, Operation operation, const KeyType &key) const;
+
+  /**
+   * Releases the latches and pins on the transaction's page set, making the version of every modified page even
+   * again, then deletes the pages in its deleted page set.
+   */
+  void ReleaseWritePages(Transaction *transaction);
+
+  // deletes pages from the buffer pool, keeping those that are still pinned around to be retried later
+  void DeletePages(const std::vector<page_id_t> &page_ids);
+
+  // the key an entry is stored under in a non-unique tree
+  KeyType EntryKey(const KeyType &key, const ValueType &value) const;
+
+  // the largest key any entry of key can be stored under in a non-unique tree
+  KeyType LastEntryKey(const KeyType &key) const;
+
+  // Insert, Remove and BulkLoad on the keys that entries are stored under
+  bool InsertEntry(const KeyType &key, const ValueType &value, Transaction *transaction);
+  void RemoveEntry(const KeyType &key, Transaction *transaction);
+  // Calls its argument with the entries of a bulk load in order, as often as it is called itself: BulkLoadEntries
+  // reads the entries twice, once to plan the tree and once to fill it.
+  using EntryScan = std::function<void(const std::function<void(const MappingType &)> &)>;
+  bool BulkLoadEntries(const EntryScan &scan, double fill_factor);
+
+  // GetValue in a unique tree, which looks up the entry stored under key
+  bool GetEntry(const KeyType &key, std::vector<ValueType> *result);
+
+  // Insert, Remove and GetValue with the write buffer on, see SetWriteBufferSize
+  bool InsertBuffered(const KeyType &entry_key, const ValueType &value, Transaction *transaction);
+  void RemoveBuffered(const KeyType &entry_key, const ValueType &value, Transaction *transaction);
+  bool GetValueBuffered(const KeyType &key, std::vector<ValueType> *result);
+
+  // FlushWriteBuffer with the flush latch held
+  void FlushWriteBufferLocked(Transaction *transaction);
+
+  // flushes the buffer that a write filled up, unless a flush is running already
+  void FlushFullWriteBuffer(Transaction *transaction);
+
+  // applies writes, in key order, to the leaves they fall into
+  void ApplyWrites(const std::map<KeyType, BufferedWrite, KeyLess> &writes, Transaction *transaction);
+
+  /**
+   * Applies a write to the latched leaf its key falls into, unless the leaf would split or underflow.
+   * @return false if the write was not applied for that reason
+   */
+  bool ApplyWriteToLeaf(LeafPage *leaf, const KeyType &key, const BufferedWrite &write) const;
+
+  // whether key falls into the key range of a page on a path
+  bool Covers(const PathLevel &level, const KeyType &key) const;
+
+  // GetValue in a non-unique tree, which collects the values of the entries of key from the leaves in order
+  bool GetValues(const KeyType &key, std::vector<ValueType> *result);
+
+  // collects the values of the entries of first_key like an index iterator, from from_key on, or after it
+  void ScanValues(const KeyType &first_key, KeyType from_key, bool after, std::vector<ValueType> *result);
+
+  bool InsertPessimistic(const KeyType &key, const ValueType &value, Transaction *transaction);
+
+  // reads the first key of a leaf recorded by a remove, if the page is still a leaf that underflows
+  bool UnderflowingLeafKey(page_id_t page_id, KeyType *key);
+
+  // merges or redistributes the leaf covering key, if it underflows; returns false if it did not
+  bool RebalanceLeaf(const KeyType &key, Transaction *transaction);
+
+  // RebalanceLeaf by write-latch crabbing from the root, for a leaf whose parent would underflow as well
+  bool RebalanceLeafPessimistic(const KeyType &key, Transaction *transaction);
+
+  void RemovePessimistic(const KeyType &key, Transaction *transaction);
+
+  /**
+   * Copies entries from the leaf level for the index iterator. With key == nullptr the copy starts at the left most
+   * entry, otherwise at the first entry not less than key, or greater than key if after is true. If the leaf
+   * covering key holds no such entries, the copy is taken from the following leaf instead.
+   *
+   * With reverse, the copy runs backwards through the leaves, from the right most entry, or the last entry not
+   * greater than key, or less than key if after is true.
+   * @param[out] items the entries copied, all from the same leaf, in the order they are iterated
+   * @return the page id of the leaf copied from, or INVALID_PAGE_ID if there are no such entries
+   */
+  page_id_t ReadLeaf(const KeyType *key, bool after, bool reverse, std::vector<MappingType> *items);
+
+  // one optimistic attempt of ReadLeaf, returns false if a page changed in the meantime
+  bool ReadLeafOptimistic(const KeyType *key, bool after, bool reverse, std::vector<MappingType> *items,
+                          page_id_t *page_id);
+
+  // one attempt of ReadLeaf by read-latch crabbing, once optimistic attempts gave up; returns false if the leaf
+  // changed while moving on to the following one
+  bool ReadLeafLatched(const KeyType *key, bool after, bool reverse, std::vector<MappingType> *items,
+                       page_id_t *page_id);
+
+  // the index ReadLeaf copies from in the leaf covering key, forwards from it on, backwards before it
+  int ReadIndex(LeafPage *leaf, const KeyType *key, bool after, bool reverse) const;
+
+  // appends the entries from index on, or backwards those before index, to items
+  void CopyItems(LeafPage *leaf, int index, bool reverse, std::vector<MappingType> *items) const;
+
+  Page *FetchPage(page_id_t page_id);
+
+  /**
+   * Adds the pinned page at depth and the pages below it to stats for CollectStats, and unpins it.
+   * @param sample_credit the leaves due to be read, which each leaf adds sample_rate to; a leaf is read once a whole
+   * one is due
+   * @param[out] leaves the leaves read, in key order
+   */
+  void CollectPageStats(Page *page, size_t depth, double sample_rate, double *sample_credit,
+                        BPlusTreeStats<KeyType> *stats, std::vector<LeafSample> *leaves);
+
+  /**
+   * Adds a read-latched node to stats for CollectPageStats.
+   * @param[out] children the children of an internal node that are due to be walked
+   */
+  void CollectNodeStats(BPlusTreePage *node, size_t depth, double sample_rate, double *sample_credit,
+                        BPlusTreeStats<KeyType> *stats, std::vector<LeafSample> *leaves,
+                        std::vector<page_id_t> *children);
+
+  // changes the root page id, both in memory and in the meta page
+  void SetRoot(page_id_t root_page_id);
+
   void StartNewTree(const KeyType &key, const ValueType &value);
 
-  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction = nullptr);
+  /**
+   * Splits the entries of one level of a bulk load into pages of capacity entries each. A short last page is merged
+   * into the one before it, or evened out with it if both do not fit into max_size entries.
+   * @return the number of entries in each page, from left to right
+   */
+  static std::vector<int> PlanBulkLoadLevel(int64_t count, int capacity, int min_size, int max_size);
+
+  /**
+   * Claims a slot for the next entry at level of a bulk load, starting a new page if the current one is full as
+   * planned. A new leaf is separated from the previous one by the shortest key between them, and a new internal page
+   * takes the separator of its first child.
+   * @return the page the entry goes into, pinned until the cursor moves on
+   */
+  Page *BulkLoadPage(size_t level, const KeyType &key, const std::vector<std::vector<int>> &plan,
+                     std::vector<BulkLoadCursor> *cursors);
+
+  bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction, PrevLink *prev_link);
 
   void InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                         Transaction *transaction = nullptr);
@@ -91,18 +548,37 @@ class BPlusTree {
   N *Split(N *node);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *node, Transaction *transaction, PrevLink *prev_link);
 
   template <typename N>
   bool Coalesce(N **neighbor_node, N **node, BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent,
-                int index, Transaction *transaction = nullptr);
+                int index, Transaction *transaction, PrevLink *prev_link);
 
   template <typename N>
-  void Redistribute(N *neighbor_node, N *node, int index);
+  void Redistribute(N *neighbor_node, N *node, int index, Transaction *transaction = nullptr);
+
+  /**
+   * Replaces the key of parent's index-th child, splitting parent first if the key does not fit, in which case
+   * parent must not be safe for the operation.
+   */
+  void SetSeparator(InternalPage *parent, int index, const KeyType &key, Transaction *transaction);
+
+  /**
+   * Suffix truncation: the separator of two neighbouring leaves does not have to be a key of the tree, only greater
+   * than left and no greater than right.
+   * @return the shortest prefix of right, padded with zeros, that separates the leaves
+   */
+  KeyType SeparatorKey(const KeyType &left, const KeyType &right) const;
+
+  template <typename N>
+  void MoveAll(N *node, N *recipient, const KeyType &middle_key);
+
+  // points the right sibling of a leaf that was split or merged into back at it, then unpins the pages of prev_link
+  void LinkPrevPage(const PrevLink &prev_link);
 
   bool AdjustRoot(BPlusTreePage *node);
 
-  void UpdateRootPageId(int insert_record = 0);
+  void UpdateRootPageId();
 
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
@@ -111,11 +587,42 @@ class BPlusTree {
 
   // member variable
   std::string index_name_;
-  page_id_t root_page_id_;
+  std::atomic<page_id_t> root_page_id_;
+  // the page that keeps the root page id on disk, only written while the root latch is held
+  page_id_t meta_page_id_{INVALID_PAGE_ID};
   BufferPoolManager *buffer_pool_manager_;
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool unique_;
+  // Held exclusively by pessimistic writers until they reach a page that is safe, and always while the root page id
+  // changes. A nullptr in a transaction's page set stands for this latch.
+  ReaderWriterLatch root_latch_;
+  // odd while the root page id is being changed, so that optimistic descents can validate the root they started at
+  std::atomic<uint32_t> root_version_{0};
+  std::mutex pending_deletes_latch_;
+  std::vector<page_id_t> pending_deletes_;
+  std::atomic<uint64_t> num_optimistic_ops_{0};
+  std::atomic<uint64_t> num_restarts_{0};
+  std::atomic<uint64_t> num_pessimistic_ops_{0};
+  // Writes not yet applied to the tree, by the key their entry is stored under. Held while the buffer is read or
+  // changed, and by inserts while they look their key up, so that two of them cannot both buffer the same key.
+  std::mutex write_buffer_latch_;
+  std::atomic<size_t> write_buffer_size_{0};
+  std::map<KeyType, BufferedWrite, KeyLess> write_buffer_;
+  // Held by the flush that is running. The writes it applies stay visible to lookups until they are all in the tree,
+  // and are only changed with both latches held, so the flush reads them without the write buffer latch.
+  std::mutex write_buffer_flush_latch_;
+  std::map<KeyType, BufferedWrite, KeyLess> flushing_writes_;
+  // Leaves that removes left underflowing, for Rebalance. Pages are dropped from it once deleted.
+  std::atomic<bool> merges_deferred_{false};
+  std::mutex merge_candidates_latch_;
+  std::unordered_set<page_id_t> merge_candidates_;
+  // Wakes the background rebalance thread up early to stop it.
+  std::thread rebalance_thread_;
+  std::mutex rebalance_thread_latch_;
+  std::condition_variable rebalance_thread_cv_;
+  bool stop_rebalance_thread_{false};
 };
 
 }  // namespace bustub
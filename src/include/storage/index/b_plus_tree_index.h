@@ -11,11 +11,13 @@
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree.h"
 #include "storage/index/index.h"
 
@@ -34,6 +36,35 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                 const std::function<bool(RID)> &callback, Transaction *transaction) override;
+
+  void ScanRangeKeys(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                     const std::function<bool(const Tuple &, RID)> &callback, Transaction *transaction) override;
+
+  // whether the keys fit into KeyType, and in a non-unique index next to a RID
+  bool StoresFullKeys() const override;
+
+  // whether every key of key_schema fits into KeyType, and in a non-unique index next to a RID
+  static bool KeyFits(const Schema *key_schema, bool is_unique);
+
+  void RebuildBloomFilter(size_t bits_per_key) override;
+
+  /**
+   * Builds the still empty index from entries in any order, which next produces until it returns false, by sorting
+   * them externally and bulk loading the tree, see BPlusTree::BulkLoadUnsorted.
+   * @param fill_factor the fraction of each page to fill
+   * @param run_size the most entries held in memory at once
+   * @return false if the index is not empty
+   */
+  bool BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor,
+                size_t run_size = ExternalSort<KeyType, ValueType, KeyComparator>::DEFAULT_RUN_SIZE);
+
+  // the shape of the tree and the distribution of its keys, see BPlusTree::CollectStats
+  BPlusTreeStats<KeyType> CollectStats(double sample_rate = 1.0, size_t num_buckets = 16) {
+    return container_.CollectStats(sample_rate, num_buckets);
+  }
+
   INDEXITERATOR_TYPE GetBeginIterator();
 
   INDEXITERATOR_TYPE GetBeginIterator(const KeyType &key);
@@ -41,6 +72,17 @@ class BPlusTreeIndex : public Index {
   INDEXITERATOR_TYPE GetEndIterator();
 
  protected:
+  /**
+   * Calls callback with the key and the value of each entry between low and high, in key order, until it returns
+   * false. The keys are the ones the tree stores.
+   */
+  template <typename Callback>
+  void ScanEntries(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                   const Callback &callback);
+
+  // the hash of a key in the Bloom filter, which ignores the RID a non-unique tree stores in its keys
+  hash_t BloomFilterHash(const KeyType &key) const { return HashFunction<KeyType>().GetHash(container_.KeyOf(key)); }
+
   // comparator for key
   KeyComparator comparator_;
   // container
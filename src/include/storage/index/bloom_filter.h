@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/storage/index/bloom_filter.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "common/util/hash_util.h"
+
+namespace bustub {
+
+/**
+ * A blocked Bloom filter over key hashes, which an index checks before it looks for a key, so that a key it does not
+ * have is usually turned away without touching a single page.
+ *
+ * The filter is split into blocks of one cache line each. A hash picks one block, and sets one bit in each of its
+ * eight 64-bit words, so that inserting or probing a key touches a single cache line; a probe checks all eight bits
+ * at once with SSE2 where available. At 10 bits per key about 1% of the probes for absent keys pass.
+ *
+ * Keys cannot be removed, so the filter is only ever rebuilt from scratch. Inserts may run concurrently with each
+ * other and with probes.
+ */
+class BloomFilter {
+ public:
+  /**
+   * Creates an empty filter sized for num_keys keys.
+   * @param bits_per_key the number of bits to spend on each key
+   */
+  BloomFilter(size_t num_keys, size_t bits_per_key);
+
+  void Insert(hash_t hash);
+
+  /** @return false if no key with the hash was inserted, true if one probably was */
+  bool MayContain(hash_t hash) const;
+
+  /** @return the size of the filter in bytes */
+  size_t GetSize() const { return blocks_.size() * sizeof(Block); }
+
+ private:
+  static constexpr size_t WORDS_PER_BLOCK = 8;
+
+  struct alignas(64) Block {
+    std::atomic<uint64_t> words_[WORDS_PER_BLOCK];
+  };
+
+  // the index of the block of a hash, chosen by its upper half
+  size_t BlockOf(hash_t hash) const;
+
+  // the bits a hash sets in its block, one per word, chosen by its lower half
+  static void MaskOf(hash_t hash, uint64_t *mask);
+
+  std::vector<Block> blocks_;
+};
+
+}  // namespace bustub
@@ -29,7 +29,8 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 class ExtendibleHashTableIndex : public Index {
  public:
   ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager,
-                           const HashFunction<KeyType> &hash_fn);
+                           const HashFunction<KeyType> &hash_fn,
+                           const ExtendibleHashTableOptions &options = ExtendibleHashTableOptions());
 
   ~ExtendibleHashTableIndex() override = default;
 
@@ -39,7 +40,20 @@ class ExtendibleHashTableIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void RebuildBloomFilter(size_t bits_per_key) override;
+
+  // Unordered scans over every entry, e.g. for index-only aggregation; see ExtendibleHashTable::Begin
+  ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> GetBeginIterator();
+
+  ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> GetBeginIterator(uint32_t partition,
+                                                                                  uint32_t num_partitions);
+
+  ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> GetBeginIterator(const Tuple &low, const Tuple &high);
+
  protected:
+  // the hash of a key in the Bloom filter
+  static hash_t BloomFilterHash(const KeyType &key) { return HashFunction<KeyType>().GetHash(key); }
+
   // comparator for key
   KeyComparator comparator_;
   // container
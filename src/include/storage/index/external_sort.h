@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.h
+//
+// Identification: src/include/storage/index/external_sort.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Sorts entries by key that need not fit in memory, for bulk loads.
+ *
+ * Entries are collected into runs of up to run_size entries, each of which is sorted in memory and written out to a
+ * chain of pages from the buffer pool, so memory only ever holds the run being collected. Reading the entries back
+ * merges the runs, with one page of each run pinned at a time; if there are more runs than a quarter of the buffer
+ * pool, groups of them are first merged into longer runs. Entries that fit into a single run are never written out.
+ *
+ * The sort is stable: entries with the same key come back in the order they were added. The run pages are deleted
+ * once they are merged into longer runs, and by the destructor.
+ */
+template <typename KeyType, typename ValueType, typename KeyComparator>
+class ExternalSort {
+  using Entry = std::pair<KeyType, ValueType>;
+
+ public:
+  // the entries of a run that a bulk load sorts in memory, by default
+  static constexpr size_t DEFAULT_RUN_SIZE = 1 << 16;
+
+  ExternalSort(BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
+               size_t run_size = DEFAULT_RUN_SIZE);
+
+  ~ExternalSort();
+
+  DISALLOW_COPY_AND_MOVE(ExternalSort);
+
+  /** Adds an entry, writing out the run collected so far first if it is full. No entry may be added once Scan ran. */
+  void Add(const KeyType &key, const ValueType &value);
+
+  /** @return the number of entries added */
+  int64_t GetSize() const { return size_; }
+
+  /** @return the number of runs written out to pages so far */
+  size_t GetNumRuns() const { return runs_.size(); }
+
+  /** Calls callback with each entry in key order. Scan may be called any number of times. */
+  void Scan(const std::function<void(const Entry &)> &callback);
+
+ private:
+  // a sorted run written out to a chain of pages
+  struct Run {
+    page_id_t first_page_id_{INVALID_PAGE_ID};
+    int64_t size_{0};
+  };
+
+  // the next entry of a run being merged, with the run's page it was read from pinned
+  struct RunCursor {
+    Page *page_{nullptr};
+    int index_{0};
+    // which of the runs merged the cursor reads, which breaks ties between equal keys
+    size_t run_{0};
+  };
+
+  // appends entries to a new run, one page after the other
+  struct RunWriter {
+    Run run_;
+    Page *page_{nullptr};
+  };
+
+  // the layout of a run page: the id of the next page, the number of entries, then the entries
+  static constexpr size_t HEADER_SIZE = sizeof(page_id_t) + sizeof(int32_t);
+  static constexpr int ENTRIES_PER_PAGE = static_cast<int>((PAGE_SIZE - HEADER_SIZE) / sizeof(Entry));
+
+  // sorts the entries collected in memory and writes them out as a run
+  void WriteRun();
+
+  /**
+   * Merges runs, deleting their pages if consume is set, and calls emit with each entry in order.
+   * Ties go to the run that comes first, which was written first.
+   */
+  void Merge(const std::vector<Run> &runs, bool consume, const std::function<void(const Entry &)> &emit);
+
+  void Append(RunWriter *writer, const Entry &entry);
+
+  // unpins the last page of the writer's run, and returns the run
+  Run Finish(RunWriter *writer);
+
+  // moves the cursor on to the next entry of its run, returning false at the end of the run
+  bool Advance(RunCursor *cursor, bool consume);
+
+  // deletes the pages of a run
+  void DeleteRun(const Run &run);
+
+  Page *NewPage(page_id_t *page_id);
+  Page *FetchPage(page_id_t page_id);
+
+  static page_id_t &NextPageId(Page *page) { return *reinterpret_cast<page_id_t *>(page->GetData()); }
+  static int32_t &PageSize(Page *page) { return *reinterpret_cast<int32_t *>(page->GetData() + sizeof(page_id_t)); }
+  static Entry *PageEntries(Page *page) { return reinterpret_cast<Entry *>(page->GetData() + HEADER_SIZE); }
+
+  BufferPoolManager *buffer_pool_manager_;
+  KeyComparator comparator_;
+  size_t run_size_;
+  // runs merged at once, so that no more pages than a quarter of the buffer pool are pinned
+  size_t fan_in_;
+  int64_t size_{0};
+  // the run being collected, or once Scan ran without writing any run out, all entries in order
+  std::vector<Entry> entries_;
+  std::vector<Run> runs_;
+  bool sorted_{false};
+};
+
+}  // namespace bustub
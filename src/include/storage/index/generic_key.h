@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 
+#include "storage/index/key_encoder.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -25,42 +28,38 @@ namespace bustub {
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
  * with a template argument.
+ *
+ * The key tuple is stored as encoded by KeyEncoder, so that keys order as
+ * their bytes do. Key tuples that take more than KeySize bytes encoded are
+ * cut short.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
-    // intialize to 0
-    memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
+    KeyEncoder::Encode(tuple, key_schema, data_, KeySize);
   }
 
   // NOTE: for test purpose only
+  // encode key as if it were the only column of the key, of type BIGINT
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    KeyEncoder::EncodeValue(Value(TypeId::BIGINT, key), data_, KeySize);
   }
 
   inline Value ToValue(Schema *schema, uint32_t column_idx) const {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
-    }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return KeyEncoder::Decode(data_, KeySize, schema, column_idx);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline int64_t ToString() const { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // interpret the key as set by SetFromInteger
+  inline int64_t ToString() const {
+    uint32_t length;
+    return KeyEncoder::DecodeValue(TypeId::BIGINT, data_, KeySize, &length).template GetAs<int64_t>();
+  }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // interpret the key as set by SetFromInteger
   friend std::ostream &operator<<(std::ostream &os, const GenericKey &key) {
     os << key.ToString();
     return os;
@@ -72,26 +71,34 @@ class GenericKey {
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * Keys are encoded so that they order as their bytes do, so they are compared
+ * with memcmp, whatever the types of their columns.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline int operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
+    int cmp = memcmp(lhs.data_, rhs.data_, KeySize);
+    return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+  }
+
+  /**
+   * A 4-byte head of the key that orders as the comparator does: whenever the head of lhs is less than the head of
+   * rhs, so is lhs, while keys with the same head have to be compared in full. B+ tree pages search the heads of
+   * their keys before they call the comparator.
+   *
+   * The head is made of the first 4 bytes of the key. A BIGINT first column is clamped to the range of an INTEGER
+   * instead, as most values of a BIGINT column have the same first 4 bytes. Both are read straight from the
+   * big-endian bytes of the key, whose flipped sign bit makes them order as unsigned numbers.
+   */
+  inline uint32_t KeyHead(const GenericKey<KeySize> &key) const {
+    if (key_schema_->GetColumnCount() > 0 && key_schema_->GetColumn(0).GetType() == TypeId::BIGINT) {
+      // the range of an INTEGER, as encoded in a BIGINT
+      constexpr uint64_t min = (uint64_t{1} << 63) - (uint64_t{1} << 31);
+      return static_cast<uint32_t>(std::clamp<uint64_t>(ReadBigEndian<8>(key), min, min + UINT32_MAX) - min);
     }
-    // equals
-    return 0;
+    return static_cast<uint32_t>(ReadBigEndian<4>(key));
   }
 
   GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
@@ -100,6 +107,16 @@ class GenericComparator {
   explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
 
  private:
+  /** @return the first Bytes bytes of the key as a big-endian number, reading bytes past its end as zeros */
+  template <size_t Bytes>
+  static inline uint64_t ReadBigEndian(const GenericKey<KeySize> &key) {
+    uint64_t number = 0;
+    for (size_t index = 0; index < Bytes; index++) {
+      number = (number << 8) | (index < KeySize ? static_cast<uint8_t>(key.data_[index]) : 0);
+    }
+    return number;
+  }
+
   Schema *key_schema_;
 };
 
@@ -12,12 +12,17 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
+#include "storage/index/bloom_filter.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -43,10 +48,14 @@ class IndexMetadata {
    * @param table_name The name of the table on which the index is created
    * @param tuple_schema The schema of the indexed key
    * @param key_attrs The mapping from indexed columns to base table columns
+   * @param is_unique Whether each key may only be indexed once
    */
   IndexMetadata(std::string index_name, std::string table_name, const Schema *tuple_schema,
-                std::vector<uint32_t> key_attrs)
-      : name_(std::move(index_name)), table_name_(std::move(table_name)), key_attrs_(std::move(key_attrs)) {
+                std::vector<uint32_t> key_attrs, bool is_unique = true)
+      : name_(std::move(index_name)),
+        table_name_(std::move(table_name)),
+        key_attrs_(std::move(key_attrs)),
+        is_unique_(is_unique) {
     key_schema_ = Schema::CopySchema(tuple_schema, key_attrs_);
   }
 
@@ -72,6 +81,9 @@ class IndexMetadata {
   /** @return The mapping relation between indexed columns and base table columns */
   inline const std::vector<uint32_t> &GetKeyAttrs() const { return key_attrs_; }
 
+  /** @return Whether each key may only be indexed once */
+  inline bool IsUnique() const { return is_unique_; }
+
   /** @return A string representation for debugging */
   std::string ToString() const {
     std::stringstream os;
@@ -92,6 +104,8 @@ class IndexMetadata {
   std::string table_name_;
   /** The mapping relation between key schema and tuple schema */
   const std::vector<uint32_t> key_attrs_;
+  /** Whether each key may only be indexed once */
+  const bool is_unique_;
   /** The schema of the indexed key */
   Schema *key_schema_;
 };
@@ -175,9 +189,133 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Scan the index for the keys between low and high, in key order. Only ordered indexes support range scans.
+   * @param low The lower bound of the keys, or nullptr to start at the smallest key
+   * @param low_inclusive Whether keys equal to low are in the range
+   * @param high The upper bound of the keys, or nullptr to end at the largest key
+   * @param high_inclusive Whether keys equal to high are in the range
+   * @param callback Called with the RID of each key in the range; the scan stops early once it returns false
+   * @param transaction The transaction context
+   */
+  virtual void ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                         const std::function<bool(RID)> &callback, Transaction *transaction) {
+    throw NotImplementedException("ScanRange not implemented for " + GetName());
+  }
+
+  /**
+   * Scan the index for the keys between low and high like ScanRange, but also hand out the keys themselves, so that
+   * a scan that only needs the key columns does not have to fetch the tuples from the table.
+   * @param callback Called with the key tuple, in the key schema, and the RID of each key in the range; the scan
+   * stops early once it returns false
+   */
+  virtual void ScanRangeKeys(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                             const std::function<bool(const Tuple &, RID)> &callback, Transaction *transaction) {
+    throw NotImplementedException("ScanRangeKeys not implemented for " + GetName());
+  }
+
+  /**
+   * @return Whether ScanRangeKeys hands out the keys exactly as they were inserted, rather than cut short to the
+   * size of the index keys
+   */
+  virtual bool StoresFullKeys() const { return false; }
+
+  ///////////////////////////////////////////////////////////////////
+  // Bloom Filter
+  ///////////////////////////////////////////////////////////////////
+
+  /**
+   * Build a Bloom filter over the keys in the index, replacing the one it has. From then on ScanKey turns away most
+   * keys the index does not have before looking for them, and InsertEntry adds new keys to the filter. Deleted keys
+   * stay in the filter, and keys inserted past the ones it was sized for make it less selective, until it is rebuilt.
+   * Probes keep using the old filter until the new one is published, and inserts go on meanwhile.
+   * @param bits_per_key The number of bits to spend on each key
+   */
+  virtual void RebuildBloomFilter(size_t bits_per_key) {
+    throw NotImplementedException("RebuildBloomFilter not implemented for " + GetName());
+  }
+
+  /** Drop the Bloom filter, if the index has one */
+  void DropBloomFilter() {
+    std::lock_guard<std::mutex> guard(bloom_filter_rebuild_latch_);
+    has_bloom_filter_ = false;
+    std::atomic_store(&bloom_filter_, std::shared_ptr<BloomFilter>());
+  }
+
+  /** @return The Bloom filter of the index, or nullptr if it has none */
+  std::shared_ptr<const BloomFilter> GetBloomFilter() const { return LoadBloomFilter(); }
+
+ protected:
+  /** @return The Bloom filter of the index, kept alive for the caller even if a rebuild replaces it, or nullptr */
+  std::shared_ptr<BloomFilter> LoadBloomFilter() const {
+    return has_bloom_filter_ ? std::atomic_load(&bloom_filter_) : nullptr;
+  }
+
+  /**
+   * Runs insert, which adds a key to the index, and adds the hash of the key to the Bloom filter around it: to the
+   * published filter first, so that a probe never turns away a key the index has, and once the key is in, to the
+   * filter of any rebuild that started meanwhile, whose scan may have passed the key before it got there. Without a
+   * filter or a rebuild this only costs a few atomic loads.
+   * @param hash computes the hash of the key
+   * @param insert adds the key to the index
+   */
+  template <typename HashFn, typename InsertFn>
+  void InsertWithBloomFilter(const HashFn &hash, const InsertFn &insert) {
+    uint64_t rebuilds = bloom_filter_rebuilds_;
+    std::shared_ptr<BloomFilter> bloom_filter = LoadBloomFilter();
+    if (bloom_filter != nullptr) {
+      bloom_filter->Insert(hash());
+    }
+    insert();
+    if (bloom_filter_rebuilds_ != rebuilds || rebuilds % 2 == 1) {
+      std::shared_ptr<BloomFilter> building = std::atomic_load(&building_bloom_filter_);
+      if (building != nullptr) {
+        building->Insert(hash());
+      }
+      std::shared_ptr<BloomFilter> published = std::atomic_load(&bloom_filter_);
+      if (published != nullptr && published != bloom_filter) {
+        published->Insert(hash());
+      }
+    }
+  }
+
+  /**
+   * Rebuilds the Bloom filter from scan, which calls its argument with the hash of every key in the index. The index
+   * is scanned twice: once to size the new filter, and once to fill it while inserts add their keys to it as well.
+   * @param bits_per_key The number of bits to spend on each key
+   * @param scan calls its argument with the hash of every key in the index
+   */
+  template <typename ScanFn>
+  void RebuildBloomFilterFrom(size_t bits_per_key, const ScanFn &scan) {
+    std::lock_guard<std::mutex> guard(bloom_filter_rebuild_latch_);
+    size_t num_keys = 0;
+    scan([&num_keys](hash_t hash) { num_keys++; });
+    auto bloom_filter = std::make_shared<BloomFilter>(num_keys, bits_per_key);
+
+    // an odd count tells inserts that a rebuild is running, and to look for its filter once their key is in
+    bloom_filter_rebuilds_++;
+    std::atomic_store(&building_bloom_filter_, bloom_filter);
+    has_bloom_filter_ = true;
+    scan([&bloom_filter](hash_t hash) { bloom_filter->Insert(hash); });
+    std::atomic_store(&bloom_filter_, bloom_filter);
+    std::atomic_store(&building_bloom_filter_, std::shared_ptr<BloomFilter>());
+    bloom_filter_rebuilds_++;
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
+
+  /** The optional Bloom filter over the keys in the index, only accessed atomically */
+  std::shared_ptr<BloomFilter> bloom_filter_;
+  /** The filter a running rebuild fills, only accessed atomically */
+  std::shared_ptr<BloomFilter> building_bloom_filter_;
+  /** Whether the index has a filter, or is building one, so that an index without one skips loading it */
+  std::atomic<bool> has_bloom_filter_{false};
+  /** Twice the number of rebuilds that finished, plus one while another one runs */
+  std::atomic<uint64_t> bloom_filter_rebuilds_{0};
+  /** Keeps rebuilds and drops of the filter apart */
+  std::mutex bloom_filter_rebuild_latch_;
 };
 
 }  // namespace bustub
@@ -13,17 +13,33 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * Iterates over the entries of a BPlusTree in key order.
+ *
+ * The iterator holds no latches or pins between calls: it copies the entries of one leaf at a time, and once they
+ * run out it asks the tree for the entries following the last key it returned. It therefore sees every entry that
+ * was in the tree for the whole scan, and may or may not see entries inserted or removed during the scan.
+ *
+ * An iterator from BPlusTree::RBegin runs backwards the same way, following the leaves' previous page ids.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
-  // you may define your own constructor based on your member variables
+  // the end iterator
   IndexIterator();
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, std::vector<MappingType> items, page_id_t page_id,
+                bool reverse = false);
   ~IndexIterator();
 
   bool IsEnd();
@@ -32,12 +48,19 @@ class IndexIterator {
 
   IndexIterator &operator++();
 
-  bool operator==(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator==(const IndexIterator &itr) const { return page_id_ == itr.page_id_ && offset_ == itr.offset_; }
 
-  bool operator!=(const IndexIterator &itr) const { throw std::runtime_error("unimplemented"); }
+  bool operator!=(const IndexIterator &itr) const { return !(*this == itr); }
 
  private:
-  // add your own private member variables here
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_{nullptr};
+  // the entries copied from the current leaf
+  std::vector<MappingType> items_;
+  size_t offset_{0};
+  // the leaf the entries were copied from, INVALID_PAGE_ID at the end
+  page_id_t page_id_{INVALID_PAGE_ID};
+  // whether the iterator runs in descending key order
+  bool reverse_{false};
 };
 
 }  // namespace bustub
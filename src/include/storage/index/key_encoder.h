@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.h
+//
+// Identification: src/include/storage/index/key_encoder.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Encodes keys as byte strings that memcmp orders as SQL orders the keys, column by column, so that keys can be
+ * compared, and their shared prefixes found, without deserializing a single Value.
+ *
+ * Each column is encoded in turn:
+ * - integers in big-endian byte order with their sign bit flipped, so that negative numbers come first
+ * - decimals in big-endian byte order, with the sign bit flipped for positive numbers and all bits flipped for
+ *   negative ones; -0.0 is encoded as 0.0
+ * - timestamps in big-endian byte order
+ * - strings as a marker byte, 0 for NULL and 1 otherwise, followed by their characters, in which every 0 byte is
+ *   escaped as 0 0xFF, and a terminating 0 0. A string thus orders before all strings it is a prefix of.
+ *
+ * Fixed-length types keep their NULLs in band, as the values the type system represents them with, so that a NULL
+ * integer orders before all others, and a NULL timestamp after them.
+ *
+ * Encoding into a buffer that is too small cuts the key short, so keys that only differ past the end of the buffer
+ * encode the same.
+ */
+class KeyEncoder {
+ public:
+  /**
+   * Encodes the columns of a key tuple into out, filling the rest of it with zeros.
+   * @param key_schema the schema of the key tuple
+   */
+  static void Encode(const Tuple &key, const Schema *key_schema, char *out, uint32_t size);
+
+  /**
+   * Encodes the columns of a key tuple in full. No such key is a proper prefix of another key of the same schema.
+   * @param key_schema the schema of the key tuple
+   */
+  static std::string Encode(const Tuple &key, const Schema *key_schema);
+
+  /**
+   * @return the most bytes a key of key_schema takes encoded, or UINT32_MAX if it has a column of variable length,
+   * whose values take any number of bytes
+   */
+  static uint32_t MaxLength(const Schema *key_schema);
+
+  /**
+   * Encodes value into out.
+   * @return the number of bytes the value takes encoded, which is more than were written if size is too small
+   */
+  static uint32_t EncodeValue(const Value &value, char *out, uint32_t size);
+
+  /**
+   * Decodes the column_idx-th column of a key encoded by Encode. Bytes past the end of the encoded key read as
+   * zeros, and a string cut short ends where the key does.
+   */
+  static Value Decode(const char *data, uint32_t size, const Schema *key_schema, uint32_t column_idx);
+
+  /**
+   * Decodes a value of type from data.
+   * @param[out] length the number of bytes the value takes encoded
+   */
+  static Value DecodeValue(TypeId type, const char *data, uint32_t size, uint32_t *length);
+};
+
+}  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varlen_key.h
+//
+// Identification: src/include/storage/index/varlen_key.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include "common/util/hash_util.h"
+#include "container/hash/hash_function.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * Variable-length key, used for indexing key tuples whose size is not bounded by a GenericKey, e.g. ones with
+ * VARCHAR columns.
+ *
+ * The key holds exactly the bytes of the serialized key tuple, so keys of any length keep their full contents
+ * and two keys are equal byte for byte iff their tuples are. Containers that store VarlenKeys in pages have to
+ * use a page layout for variable-length entries, such as HashTableSlottedBucketPage.
+ */
+class VarlenKey {
+ public:
+  VarlenKey() = default;
+
+  VarlenKey(const char *data, uint32_t size) : data_(data, size) {}
+
+  // the key keeps the serialized tuple as it is, so it needs no key schema to be set, unlike a GenericKey
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema = nullptr) {
+    data_.assign(tuple.GetData(), tuple.GetLength());
+  }
+
+  // NOTE: for test purpose only
+  inline void SetFromInteger(int64_t key) { data_.assign(reinterpret_cast<const char *>(&key), sizeof(int64_t)); }
+
+  inline Value ToValue(Schema *schema, uint32_t column_idx) const {
+    const char *data_ptr;
+    const auto &col = schema->GetColumn(column_idx);
+    const TypeId column_type = col.GetType();
+    const bool is_inlined = col.IsInlined();
+    if (is_inlined) {
+      data_ptr = (data_.data() + col.GetOffset());
+    } else {
+      int32_t offset;
+      memcpy(&offset, data_.data() + col.GetOffset(), sizeof(int32_t));
+      data_ptr = (data_.data() + offset);
+    }
+    return Value::DeserializeFrom(data_ptr, column_type);
+  }
+
+  /** @return the serialized key */
+  inline const char *GetData() const { return data_.data(); }
+
+  /** @return the length of the serialized key in bytes */
+  inline uint32_t GetSize() const { return static_cast<uint32_t>(data_.size()); }
+
+  // NOTE: for test purpose only
+  // interpret the first 8 bytes as int64_t from data vector
+  inline int64_t ToString() const {
+    int64_t key = 0;
+    memcpy(&key, data_.data(), std::min(data_.size(), sizeof(int64_t)));
+    return key;
+  }
+
+  // NOTE: for test purpose only
+  friend std::ostream &operator<<(std::ostream &os, const VarlenKey &key) {
+    os << key.ToString();
+    return os;
+  }
+
+ private:
+  std::string data_;
+};
+
+/**
+ * Function object that orders VarlenKeys column by column, decoding each column's Value from the serialized keys
+ * with the key schema. Returns -1 if lhs < rhs, 1 if lhs > rhs, and 0 if every column is equal.
+ */
+class VarlenComparator {
+ public:
+  inline int operator()(const VarlenKey &lhs, const VarlenKey &rhs) const {
+    uint32_t column_count = key_schema_->GetColumnCount();
+
+    for (uint32_t i = 0; i < column_count; i++) {
+      Value lhs_value = (lhs.ToValue(key_schema_, i));
+      Value rhs_value = (rhs.ToValue(key_schema_, i));
+
+      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
+        return -1;
+      }
+      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
+        return 1;
+      }
+    }
+    // equals
+    return 0;
+  }
+
+  VarlenComparator(const VarlenComparator &other) : key_schema_{other.key_schema_} {}
+
+  // constructor
+  explicit VarlenComparator(Schema *key_schema) : key_schema_(key_schema) {}
+
+ private:
+  Schema *key_schema_;
+};
+
+/**
+ * A VarlenKey is hashed by its serialized bytes rather than by the bytes of the object.
+ */
+template <>
+inline uint64_t HashFunction<VarlenKey>::GetHash(VarlenKey key) {
+  return HashUtil::HashBytes(algorithm_, key.GetData(), key.GetSize());
+}
+
+}  // namespace bustub
@@ -12,13 +12,15 @@
 
 #include <queue>
 
+#include "storage/page/b_plus_tree_key_array.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
-#define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+#define INTERNAL_PAGE_HEADER_SIZE 32
+// no limit beyond what fits in a page
+#define INTERNAL_PAGE_SIZE ((PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(page_id_t))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -27,10 +29,19 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Internal page format (keys are stored in increasing order, compressed as
+ * described in BPlusTreeKeyArray):
+ *  ---------------------------------------------------------------------------------------------------------
+ * | HEADER | COMMON KEY | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) | ... | HEAD(1) |
+ *  ---------------------------------------------------------------------------------------------------------
+ *
+ * The header is that of BPlusTreePage followed by MaxSizeLimit (4), 32 bytes
+ * in total. The first key still takes part in the compression, so it is always
+ * set to a key of the tree, mostly the one that was pushed up from the page.
+ *
+ * An internal page overflows to max_size + 1 children before it is split. As
+ * in leaf pages, how many children fit depends on how many bytes the keys have
+ * in common, so max_size follows the keys up to MaxSizeLimit.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -39,28 +50,46 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void Init(page_id_t page_id, page_id_t parent_id = INVALID_PAGE_ID, int max_size = INTERNAL_PAGE_SIZE);
 
   KeyType KeyAt(int index) const;
-  void SetKeyAt(int index, const KeyType &key);
+  void SetKeyAt(int index, const KeyType &key, const KeyComparator &comparator);
   int ValueIndex(const ValueType &value) const;
   ValueType ValueAt(int index) const;
 
+  // capacity methods: how many children fit depends on their keys
+  bool HasRoomFor(const KeyType &key) const;
+  int MaxSizeMergedWith(const BPlusTreeInternalPage *sibling, const KeyType &middle_key) const;
+  static int MaxSize(int max_size_limit, int common_size);
+
   ValueType Lookup(const KeyType &key, const KeyComparator &comparator) const;
-  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
-  int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
+  // the index of the child that covers key, which covers the keys from its own key up to the next one
+  int LookupIndex(const KeyType &key, const KeyComparator &comparator) const;
+  void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value,
+                       const KeyComparator &comparator);
+  int InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value,
+                      const KeyComparator &comparator);
+  // bulk load: append a child after all others, leaving its parent page id to the caller
+  void Append(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   void Remove(int index);
   ValueType RemoveAndReturnOnlyChild();
 
   // Split and Merge utility methods
-  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, BufferPoolManager *buffer_pool_manager);
+  void MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key, const KeyComparator &comparator,
+                 BufferPoolManager *buffer_pool_manager);
   void MoveHalfTo(BPlusTreeInternalPage *recipient, BufferPoolManager *buffer_pool_manager);
-  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+  void MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key, const KeyComparator &comparator,
                         BufferPoolManager *buffer_pool_manager);
-  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
+  void MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key, const KeyComparator &comparator,
                          BufferPoolManager *buffer_pool_manager);
 
  private:
-  void CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager);
-  void CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  void CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager);
-  MappingType array_[0];
+  void CopyNFrom(MappingType *items, const uint32_t *heads, int size, BufferPoolManager *buffer_pool_manager);
+  void CopyLastFrom(const MappingType &pair, uint32_t head, BufferPoolManager *buffer_pool_manager);
+  void CopyFirstFrom(const MappingType &pair, uint32_t head, BufferPoolManager *buffer_pool_manager);
+  void Adopt(page_id_t child_page_id, BufferPoolManager *buffer_pool_manager);
+  void UpdateMaxSize();
+
+  using KeyArray = BPlusTreeKeyArray<KeyType, ValueType, PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE>;
+  int max_size_limit_;
+  // Do not add any members below array_, as its entries extend to the end of the page.
+  KeyArray array_;
 };
 }  // namespace bustub
@@ -0,0 +1,326 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_key_array.h
+//
+// Identification: src/include/storage/page/b_plus_tree_key_array.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "storage/page/b_plus_tree_page.h"
+
+namespace bustub {
+
+/**
+ * The key & value pairs of a B+ tree page, with the bytes their keys have in
+ * common stored only once.
+ *
+ * Keys in a page tend to agree on their first bytes, e.g. on the leading
+ * columns of a composite key, and on their last bytes, as keys shorter than
+ * the key type are padded with zeros. The array keeps a common key whose first
+ * PrefixSize and last SuffixSize bytes are shared by all keys, and stores only
+ * the bytes in between for each entry. The fewer bytes the keys differ in, the
+ * more entries fit in the page.
+ *
+ * Each entry also has a head: 4 bytes derived from its key by the comparator
+ * (see GenericComparator::KeyHead) that order as the keys do, wherever they
+ * differ. The heads are kept apart from the entries, at the end of the page,
+ * so that a search runs through them as one small array and only compares
+ * the keys that share a head in full.
+ *
+ * Array format (size in byte):
+ *  ----------------------------------------------------------------------------------------------------------
+ * | PrefixSize (2) | SuffixSize (2) | CommonKey (sizeof(KeyType)) | KEY(1) + VALUE(1) | ... | HEAD(1) |
+ *  ----------------------------------------------------------------------------------------------------------
+ *
+ * The heads are stored backwards from the end of the page, HEAD(1) last.
+ * Bytes is the space from the start of the array to the end of the page, so
+ * the array must be the last member of its page. Adding a key that does not
+ * share the common bytes widens every entry; callers check that the entries
+ * still fit before they add a key.
+ */
+template <typename KeyType, typename ValueType, size_t Bytes>
+class BPlusTreeKeyArray {
+ public:
+  static constexpr int KEY_SIZE = sizeof(KeyType);
+  static constexpr int HEADER_SIZE = 2 * sizeof(uint16_t) + KEY_SIZE;
+  static constexpr int HEAD_SIZE = sizeof(uint32_t);
+
+  /** @return how many entries fit if their keys have common_size bytes in common */
+  static constexpr int Capacity(int common_size) {
+    return (static_cast<int>(Bytes) - HEADER_SIZE) /
+           (KEY_SIZE - common_size + static_cast<int>(sizeof(ValueType)) + HEAD_SIZE);
+  }
+
+  void Init() {
+    prefix_size_ = KEY_SIZE;
+    suffix_size_ = 0;
+  }
+
+  /** @return the number of bytes the first size keys have in common */
+  int GetCommonSize(int size) const { return GetCommon(size).Size(); }
+
+  /** @return the number of bytes the first size keys and key have in common */
+  int CommonSizeWith(const KeyType &key, int size) const {
+    Common common = GetCommon(size);
+    common.Include(key);
+    return common.Size();
+  }
+
+  /**
+   * @return the number of bytes the first size keys, the first other_size keys of other and key, if given, have in
+   * common
+   */
+  int CommonSizeWith(const BPlusTreeKeyArray &other, int other_size, int size, const KeyType *key = nullptr) const {
+    Common common = GetCommon(size);
+    common.Include(other.GetCommon(other_size));
+    if (key != nullptr) {
+      common.Include(*key);
+    }
+    return common.Size();
+  }
+
+  /** @return whether the first size entries and one with key fit */
+  bool HasRoomFor(const KeyType &key, int size) const { return size + 1 <= Capacity(CommonSizeWith(key, size)); }
+
+  KeyType KeyAt(int index) const {
+    Layout layout = GetLayout();
+    KeyType key;
+    auto *bytes = reinterpret_cast<char *>(&key);
+    memcpy(bytes, common_key_, KEY_SIZE);
+    memcpy(bytes + layout.prefix_, EntryAt(index, layout), layout.width_);
+    return key;
+  }
+
+  ValueType ValueAt(int index) const {
+    Layout layout = GetLayout();
+    ValueType value;
+    memcpy(&value, EntryAt(index, layout) + layout.width_, sizeof(ValueType));
+    return value;
+  }
+
+  MappingType ItemAt(int index) const { return MappingType(KeyAt(index), ValueAt(index)); }
+
+  uint32_t HeadAt(int index) const { return *HeadPtr(index); }
+
+  /** Replaces the key at index, one of the first size entries, widening the entries if needed */
+  void SetKeyAt(int index, const KeyType &key, uint32_t head, int size) {
+    Widen(key, size);
+    WriteKey(index, key);
+    *HeadPtr(index) = head;
+  }
+
+  void SetValueAt(int index, const ValueType &value) {
+    Layout layout = GetLayout();
+    memcpy(const_cast<char *>(EntryAt(index, layout)) + layout.width_, &value, sizeof(ValueType));
+  }
+
+  /** Inserts an entry before index, shifting the rest of the first size entries back */
+  void Insert(int index, const KeyType &key, const ValueType &value, uint32_t head, int size) {
+    Widen(key, size);
+    int entry_size = GetLayout().width_ + sizeof(ValueType);
+    memmove(data_ + (index + 1) * entry_size, data_ + index * entry_size, (size - index) * entry_size);
+    // the heads run backwards, so the ones after index move down
+    memmove(HeadPtr(size), HeadPtr(size - 1), (size - index) * HEAD_SIZE);
+    WriteKey(index, key);
+    SetValueAt(index, value);
+    *HeadPtr(index) = head;
+  }
+
+  /** Removes the entry at index, shifting the rest of the first size entries forward */
+  void Remove(int index, int size) {
+    int entry_size = GetLayout().width_ + sizeof(ValueType);
+    memmove(data_ + index * entry_size, data_ + (index + 1) * entry_size, (size - index - 1) * entry_size);
+    memmove(HeadPtr(size - 2), HeadPtr(size - 1), (size - index - 1) * HEAD_SIZE);
+  }
+
+  /**
+   * Searches the entries in [begin, end) for key. The heads are searched first, and the comparator only decides
+   * between the entries whose head is the same as that of key.
+   * @return the first of the entries whose key is greater than key if upper is true, or not less than key otherwise
+   */
+  template <typename KeyComparator>
+  int Search(const KeyType &key, bool upper, int begin, int end, const KeyComparator &comparator) const {
+    uint32_t head = comparator.KeyHead(key);
+    int low = LowerBound(head, begin, end);
+    int high = head == UINT32_MAX ? end : LowerBound(head + 1, low, end);
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      int cmp = comparator(KeyAt(mid), key);
+      if (cmp < 0 || (upper && cmp == 0)) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  /** Narrows the entries down to the bytes the first size keys actually differ in */
+  void Compact(int size) {
+    Common common;
+    for (int index = 0; index < size; index++) {
+      common.Include(KeyAt(index));
+    }
+    Reencode(common, size);
+  }
+
+ private:
+  /** The bytes a set of keys has in common: the first prefix_ and the last suffix_ bytes of key_ */
+  struct Common {
+    void Include(const KeyType &key) {
+      Common common;
+      common.prefix_ = KEY_SIZE;
+      common.suffix_ = KEY_SIZE;
+      common.empty_ = false;
+      common.key_ = key;
+      Include(common);
+    }
+
+    void Include(const Common &other) {
+      if (other.empty_) {
+        return;
+      }
+      if (empty_) {
+        *this = other;
+        return;
+      }
+      auto *bytes = reinterpret_cast<const char *>(&key_);
+      auto *other_bytes = reinterpret_cast<const char *>(&other.key_);
+      int prefix = 0;
+      while (prefix < std::min(prefix_, other.prefix_) && bytes[prefix] == other_bytes[prefix]) {
+        prefix++;
+      }
+      int suffix = 0;
+      while (suffix < std::min(suffix_, other.suffix_) &&
+             bytes[KEY_SIZE - 1 - suffix] == other_bytes[KEY_SIZE - 1 - suffix]) {
+        suffix++;
+      }
+      prefix_ = prefix;
+      suffix_ = suffix;
+    }
+
+    // the prefix and the suffix overlap while the keys share most bytes; the suffix is cut short where they do
+    int Size() const { return empty_ ? KEY_SIZE : std::min(prefix_ + suffix_, KEY_SIZE); }
+
+    int prefix_{0};
+    int suffix_{0};
+    bool empty_{true};
+    KeyType key_;
+  };
+
+  Common GetCommon(int size) const {
+    Common common;
+    if (size > 0) {
+      common.prefix_ = std::min<int>(prefix_size_, KEY_SIZE);
+      common.suffix_ = std::min<int>(suffix_size_, KEY_SIZE);
+      common.empty_ = false;
+      memcpy(&common.key_, common_key_, KEY_SIZE);
+    }
+    return common;
+  }
+
+  /** Where the bytes of each key that are not in common start, and how many there are */
+  struct Layout {
+    int prefix_;
+    int width_;
+  };
+
+  // The stored suffix may overlap the prefix, and is cut short where it does. Optimistic readers may also see the
+  // header and the entries of a page that is being modified, so the layout is read once and cut to fit, and entries
+  // are looked up within the page; their version check discards whatever they read.
+  Layout GetLayout() const {
+    int prefix = std::min<int>(prefix_size_, KEY_SIZE);
+    int suffix = std::min<int>(suffix_size_, KEY_SIZE - prefix);
+    return {prefix, KEY_SIZE - prefix - suffix};
+  }
+
+  const char *EntryAt(int index, const Layout &layout) const {
+    int entry_size = layout.width_ + sizeof(ValueType);
+    index = std::clamp(index, 0, (static_cast<int>(Bytes) - HEADER_SIZE) / entry_size - 1);
+    return data_ + index * entry_size;
+  }
+
+  uint32_t *HeadPtr(int index) const {
+    constexpr int max_index = (static_cast<int>(Bytes) - HEADER_SIZE) / HEAD_SIZE - 1;
+    auto *heads_end = reinterpret_cast<uint32_t *>(const_cast<char *>(data_) + Bytes - HEADER_SIZE);
+    return heads_end - 1 - std::clamp(index, 0, max_index);
+  }
+
+  /**
+   * Branch-free binary search over the heads of the entries in [begin, end): every step halves the range by a
+   * conditional move rather than a branch that mispredicts half of the time.
+   * @return the first of the entries whose head is not less than head
+   */
+  int LowerBound(uint32_t head, int begin, int end) const {
+    int length = end - begin;
+    if (length <= 0) {
+      return begin;
+    }
+    while (length > 1) {
+      int half = length / 2;
+      begin = HeadAt(begin + half) < head ? begin + half : begin;
+      length -= half;
+    }
+    return begin + (HeadAt(begin) < head ? 1 : 0);
+  }
+
+  void WriteKey(int index, const KeyType &key) {
+    Layout layout = GetLayout();
+    memcpy(const_cast<char *>(EntryAt(index, layout)), reinterpret_cast<const char *>(&key) + layout.prefix_,
+           layout.width_);
+  }
+
+  /** Widens the first size entries so that key shares the common bytes */
+  void Widen(const KeyType &key, int size) {
+    Common common = GetCommon(size);
+    common.Include(key);
+    if (size == 0 || common.prefix_ != prefix_size_ || common.suffix_ != suffix_size_) {
+      Reencode(common, size);
+    }
+  }
+
+  /**
+   * Stores the first size entries again with the bytes in common, which all their keys must share. The entries are
+   * re-encoded in place: they move towards the end of the page as they widen, so they are rewritten last to first,
+   * and towards its start as they narrow, so they are rewritten first to last. Either way, no entry is overwritten
+   * before it is read.
+   */
+  void Reencode(const Common &common, int size) {
+    Layout old_layout = GetLayout();
+    KeyType key;
+    memcpy(&key, common_key_, KEY_SIZE);
+    if (!common.empty_) {
+      prefix_size_ = static_cast<uint16_t>(common.prefix_);
+      suffix_size_ = static_cast<uint16_t>(common.suffix_);
+      memcpy(common_key_, &common.key_, KEY_SIZE);
+    }
+    bool widen = GetLayout().width_ > old_layout.width_;
+    for (int step = 0; step < size; step++) {
+      int index = widen ? size - 1 - step : step;
+      const char *entry = EntryAt(index, old_layout);
+      ValueType value;
+      memcpy(reinterpret_cast<char *>(&key) + old_layout.prefix_, entry, old_layout.width_);
+      memcpy(&value, entry + old_layout.width_, sizeof(ValueType));
+      WriteKey(index, key);
+      SetValueAt(index, value);
+    }
+  }
+
+  uint16_t prefix_size_;
+  uint16_t suffix_size_;
+  char common_key_[KEY_SIZE];
+  // Do not add any members below data_, as the entries extend to the end of the page.
+  char data_[0];
+};
+
+}  // namespace bustub
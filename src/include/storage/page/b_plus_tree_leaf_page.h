@@ -13,31 +13,39 @@
 #include <utility>
 #include <vector>
 
+#include "storage/page/b_plus_tree_key_array.h"
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
-#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_HEADER_SIZE 40
+// no limit beyond what fits in a page
+#define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(ValueType))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
  *
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ * Leaf page format (keys are stored in order, compressed as described in
+ * BPlusTreeKeyArray):
+ *  ------------------------------------------------------------------------------------------------
+ * | HEADER | COMMON KEY | KEY(1) + RID(1) | ... | KEY(n) + RID(n) | ... | HEAD(n) | ... | HEAD(1) |
+ *  ------------------------------------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 40 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  -----------------------------------------------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | Version (4) | NextPageId (4) | PrevPageId (4) | MaxSizeLimit (4)
+ *  -----------------------------------------------------------------------------------------------------
+ *
+ * How many entries fit depends on how many bytes their keys have in common,
+ * so MaxSize follows the keys, up to the MaxSizeLimit the page was created
+ * with. A full page splits in halves that each have to fit even if their keys
+ * share no bytes, which bounds MaxSize to about twice what fits uncompressed.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,14 +56,24 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   page_id_t GetNextPageId() const;
   void SetNextPageId(page_id_t next_page_id);
+  page_id_t GetPrevPageId() const;
+  void SetPrevPageId(page_id_t prev_page_id);
   KeyType KeyAt(int index) const;
   int KeyIndex(const KeyType &key, const KeyComparator &comparator) const;
-  const MappingType &GetItem(int index);
+  MappingType GetItem(int index) const;
+
+  // capacity methods: how many entries fit depends on their keys
+  bool HasRoomFor(const KeyType &key) const;
+  int MaxSizeWith(const KeyType &key) const;
+  int MaxSizeMergedWith(const BPlusTreeLeafPage *sibling) const;
+  static int MaxSize(int max_size_limit, int common_size);
 
   // insert and delete methods
   int Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
   bool Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const;
   int RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator);
+  // bulk load: append an entry greater than all others
+  void Append(const KeyType &key, const ValueType &value, const KeyComparator &comparator);
 
   // Split and Merge utility methods
   void MoveHalfTo(BPlusTreeLeafPage *recipient);
@@ -64,10 +82,16 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   void MoveLastToFrontOf(BPlusTreeLeafPage *recipient);
 
  private:
-  void CopyNFrom(MappingType *items, int size);
-  void CopyLastFrom(const MappingType &item);
-  void CopyFirstFrom(const MappingType &item);
+  using KeyArray = BPlusTreeKeyArray<KeyType, ValueType, PAGE_SIZE - LEAF_PAGE_HEADER_SIZE>;
+
+  void CopyNFrom(MappingType *items, const uint32_t *heads, int size);
+  void CopyLastFrom(const MappingType &item, uint32_t head);
+  void CopyFirstFrom(const MappingType &item, uint32_t head);
+  void UpdateMaxSize();
   page_id_t next_page_id_;
-  MappingType array_[0];
+  page_id_t prev_page_id_;
+  int max_size_limit_;
+  // Do not add any members below array_, as its entries extend to the end of the page.
+  KeyArray array_;
 };
 }  // namespace bustub
@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_meta_page.h
+//
+// Identification: src/include/storage/page/b_plus_tree_meta_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * The page a B+ tree keeps its root page id in. The header page only records
+ * where the meta page of each index is, which never changes, so root changes
+ * write the index's own meta page rather than the header page that all
+ * indexes share.
+ *
+ * Format (size in byte, 12 bytes in total):
+ * ---------------------------------------------
+ * | LSN (4) | PageId (4) | RootPageId (4) |
+ * ---------------------------------------------
+ */
+class BPlusTreeMetaPage {
+ public:
+  // initializes a new meta page of a tree that has no root yet
+  void Init(page_id_t page_id);
+
+  lsn_t GetLSN() const;
+  void SetLSN(lsn_t lsn);
+
+  page_id_t GetPageId() const;
+
+  page_id_t GetRootPageId() const;
+  void SetRootPageId(page_id_t root_page_id);
+
+ private:
+  lsn_t lsn_;
+  page_id_t page_id_;
+  page_id_t root_page_id_;
+};
+
+}  // namespace bustub
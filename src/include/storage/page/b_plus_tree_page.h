@@ -33,12 +33,19 @@ enum class IndexPageType { INVALID_INDEX_PAGE = 0, LEAF_PAGE, INTERNAL_PAGE };
  * It actually serves as a header part for each B+ tree page and
  * contains information shared by both leaf page and internal page.
  *
- * Header format (size in byte, 24 bytes in total):
+ * Header format (size in byte, 28 bytes in total):
  * ----------------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  * ----------------------------------------------------------------------------
- * | ParentPageId (4) | PageId(4) |
+ * | ParentPageId (4) | PageId(4) | Version (4) |
  * ----------------------------------------------------------------------------
+ *
+ * The version supports optimistic lock coupling. Writers hold the page's
+ * write latch and make the version odd while they modify the page, and even
+ * again once they are done. Readers do not latch: they remember the version
+ * before reading the page and check that it is still the same afterwards. A
+ * deleted page keeps an odd version, so readers that still have it pinned
+ * never accept what they read from it.
  */
 class BPlusTreePage {
  public:
@@ -62,6 +69,15 @@ class BPlusTreePage {
 
   void SetLSN(lsn_t lsn = INVALID_LSN);
 
+  /** @return the current version, odd while a writer is modifying the page */
+  uint32_t GetVersion() const;
+  /** @return true if the version is still version, i.e. nothing read since then was modified */
+  bool ValidateVersion(uint32_t version) const;
+  /** Makes the version odd before a modification, if it is not already. Requires the page's write latch. */
+  void LockVersion();
+  /** Makes the version even again after a modification, if it was locked. Requires the page's write latch. */
+  void UnlockVersion();
+
  private:
   // member variable, attributes that both internal and leaf page share
   IndexPageType page_type_ __attribute__((__unused__));
@@ -70,6 +86,7 @@ class BPlusTreePage {
   int max_size_ __attribute__((__unused__));
   page_id_t parent_page_id_ __attribute__((__unused__));
   page_id_t page_id_ __attribute__((__unused__));
+  uint32_t version_;
 };
 
 }  // namespace bustub
@@ -77,6 +77,14 @@ class HashTableBlockPage {
    */
   void Remove(slot_offset_t bucket_ind);
 
+  /**
+   * Frees the slot at index entirely, without leaving a tombstone. Only safe when no probe sequence needs to run
+   * through the slot anymore, e.g. for backward-shift deletion.
+   *
+   * @param bucket_ind index to free
+   */
+  void Free(slot_offset_t bucket_ind);
+
   /**
    * Returns whether or not an index is occupied (key/value pair or tombstone)
    *
@@ -30,8 +30,17 @@ namespace bustub {
  *  ----------------------------------------------------------------
  *
  *  Here '+' means concatenation.
- *  The above format omits the space required for the occupied_ and
- *  readable_ arrays. More information is in storage/page/hash_table_page_defs.h.
+ *  The above format omits the space required for the occupied_,
+ *  readable_ and fingerprints_ arrays. More information is in
+ *  storage/page/hash_table_page_defs.h.
+ *
+ *  Every slot carries an 8-bit fingerprint of its key. Lookups compare the
+ *  fingerprints of 16 (SSE2) or 32 (AVX2) slots at once and only call the
+ *  key comparator on slots whose fingerprint matches.
+ *
+ *  A bucket can also be kept sorted, by only ever modifying it through the
+ *  *Sorted methods. Its entries then fill slots [0, NumReadable()) in key
+ *  order, which lets range scans binary-search for their first key.
  *
  */
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -43,9 +52,10 @@ class HashTableBucketPage {
   /**
    * Scan the bucket and collect values that have the matching key
    *
+   * @param hash the directory hash of key, which fingerprints come from
    * @return true if at least one key matched
    */
-  bool GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result);
+  bool GetValue(KeyType key, uint32_t hash, KeyComparator cmp, std::vector<ValueType> *result);
 
   /**
    * Attempts to insert a key and value in the bucket.  Uses the occupied_
@@ -54,16 +64,47 @@ class HashTableBucketPage {
    *
    * @param key key to insert
    * @param value value to insert
+   * @param hash the directory hash of key
    * @return true if inserted, false if duplicate KV pair or bucket is full
    */
-  bool Insert(KeyType key, ValueType value, KeyComparator cmp);
+  bool Insert(KeyType key, ValueType value, uint32_t hash, KeyComparator cmp);
 
   /**
    * Removes a key and value.
    *
    * @return true if removed, false if not found
    */
-  bool Remove(KeyType key, ValueType value, KeyComparator cmp);
+  bool Remove(KeyType key, ValueType value, uint32_t hash, KeyComparator cmp);
+
+  /**
+   * Inserts a key and value into a sorted bucket, after any entries with an equal key.
+   *
+   * @param key key to insert
+   * @param value value to insert
+   * @param hash the directory hash of key
+   * @return true if inserted, false if duplicate KV pair or bucket is full
+   */
+  bool InsertSorted(KeyType key, ValueType value, uint32_t hash, KeyComparator cmp);
+
+  /**
+   * Removes a key and value from a sorted bucket, shifting the following entries down.
+   *
+   * @return true if removed, false if not found
+   */
+  bool RemoveSorted(KeyType key, ValueType value, KeyComparator cmp);
+
+  /**
+   * Binary-searches a sorted bucket.
+   *
+   * @return the index of the first entry whose key is not less than key
+   */
+  uint32_t LowerBound(const KeyType &key, KeyComparator cmp);
+
+  /**
+   * Moves the readable entries down to slots [0, NumReadable()), keeping their order. Restores the layout of a
+   * sorted bucket after entries were removed with RemoveAt.
+   */
+  void Compact();
 
   /**
    * Gets the key at an index in the bucket.
@@ -128,6 +169,31 @@ class HashTableBucketPage {
    */
   bool IsFull();
 
+  /**
+   * @return the number of slots, BUCKET_ARRAY_SIZE
+   */
+  uint32_t NumSlots() const { return BUCKET_ARRAY_SIZE; }
+
+  /**
+   * @return whether one more entry fits, i.e. the bucket is not full, whatever the key
+   */
+  bool HasSpaceFor(const KeyType & /* key */) { return !IsFull(); }
+
+  /**
+   * @return whether an entry with key fits in an empty bucket, which fixed-size entries always do
+   */
+  static constexpr bool Fits(const KeyType & /* key */) { return true; }
+
+  /**
+   * @return the bytes taken up by the readable entries
+   */
+  uint32_t BytesUsed() { return NumReadable() * sizeof(MappingType); }
+
+  /**
+   * @return the bytes taken up by the entries of a full bucket
+   */
+  static constexpr uint32_t BytesCapacity() { return BUCKET_ARRAY_SIZE * sizeof(MappingType); }
+
   /**
    * @return whether the bucket is empty
    */
@@ -139,10 +205,45 @@ class HashTableBucketPage {
   void PrintBucket();
 
  private:
+  /**
+   * @return the 8-bit fingerprint stored alongside a key: the top byte of its directory hash, independent of the
+   * low bits, at most MAX_GLOBAL_DEPTH of them, that the directory picks this bucket by
+   */
+  static uint8_t Fingerprint(uint32_t hash) { return static_cast<uint8_t>(hash >> 24); }
+
+  /**
+   * Compares the fingerprints of the PROBE_WIDTH slots starting at base against fingerprint.
+   *
+   * @param base first slot to probe, a multiple of PROBE_WIDTH
+   * @param fingerprint the fingerprint to look for
+   * @return bitmask with bit i set if slot base + i is readable and its fingerprint matches
+   */
+  uint32_t MatchFingerprint(uint32_t base, uint8_t fingerprint) const;
+
+  /**
+   * @param base first slot, a multiple of PROBE_WIDTH
+   * @return bitmask with bit i set if slot base + i is occupied
+   */
+  uint32_t OccupiedMask(uint32_t base) const;
+
+  /**
+   * @param base first slot, a multiple of PROBE_WIDTH
+   * @return bitmask with bit i set if slot base + i is readable
+   */
+  uint32_t ReadableMask(uint32_t base) const;
+
+  /**
+   * @param base first slot, a multiple of PROBE_WIDTH
+   * @return bitmask with bit i set if slot base + i exists, i.e. is below BUCKET_ARRAY_SIZE
+   */
+  static uint32_t LaneMask(uint32_t base);
+
   // For more on BUCKET_ARRAY_SIZE see storage/page/hash_table_page_defs.h
   char occupied_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
   char readable_[(BUCKET_ARRAY_SIZE - 1) / 8 + 1];
+  // Hash fingerprint of the key in each slot, only meaningful if the slot is readable.
+  uint8_t fingerprints_[BUCKET_ARRAY_SIZE];
   // Do not add any members below array_, as they will overlap.
   MappingType array_[0];
 };
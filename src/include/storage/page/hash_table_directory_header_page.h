@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_header_page.h
+//
+// Identification: src/include/storage/page/hash_table_directory_header_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <string>
+
+#include "common/config.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+
+/**
+ *
+ * Header Page for extendible hash table.
+ *
+ * The directory of an extendible hash table is split across up to DIRECTORY_HEADER_ARRAY_SIZE directory pages of
+ * DIRECTORY_ARRAY_SIZE entries each. The header page records the global depth of this logical directory and the
+ * page_id of every directory page: directory index i lives in slot (i % DIRECTORY_ARRAY_SIZE) of directory page
+ * (i / DIRECTORY_ARRAY_SIZE).
+ *
+ * Header format (size in byte):
+ * --------------------------------------------------------------------------
+ * | LSN (4) | PageId(4) | GlobalDepth(4) | DirectoryPageIds(2048) | Free(2036)
+ * --------------------------------------------------------------------------
+ */
+class HashTableDirectoryHeaderPage {
+ public:
+  /**
+   * @return the page ID of this page
+   */
+  page_id_t GetPageId() const;
+
+  /**
+   * Sets the page ID of this page
+   *
+   * @param page_id the page id to which to set the page_id_ field
+   */
+  void SetPageId(page_id_t page_id);
+
+  /**
+   * @return the lsn of this page
+   */
+  lsn_t GetLSN() const;
+
+  /**
+   * Sets the LSN of this page
+   *
+   * @param lsn the log sequence number to which to set the lsn field
+   */
+  void SetLSN(lsn_t lsn);
+
+  /**
+   * @return the global depth of the logical directory
+   */
+  uint32_t GetGlobalDepth() const;
+
+  /**
+   * @return mask of global_depth 1's and the rest 0's (with 1's from LSB upwards)
+   */
+  uint32_t GetGlobalDepthMask() const;
+
+  /**
+   * Increment the global depth of the logical directory. The caller is responsible for populating the directory
+   * pages that cover the new upper half.
+   */
+  void IncrGlobalDepth();
+
+  /**
+   * Decrement the global depth of the logical directory.
+   */
+  void DecrGlobalDepth();
+
+  /**
+   * @return the number of entries in the logical directory
+   */
+  uint32_t Size() const;
+
+  /**
+   * @return the number of directory pages in use
+   */
+  uint32_t NumDirectoryPages() const;
+
+  /**
+   * Lookup a directory page
+   *
+   * @param directory_idx which directory page to look up
+   * @return the page_id of that directory page
+   */
+  page_id_t GetDirectoryPageId(uint32_t directory_idx) const;
+
+  /**
+   * Updates the page_id of a directory page
+   *
+   * @param directory_idx which directory page to update
+   * @param directory_page_id the page_id to record
+   */
+  void SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id);
+
+  /**
+   * @param bucket_idx an index into the logical directory
+   * @return which directory page holds bucket_idx
+   */
+  static uint32_t DirectoryIndex(uint32_t bucket_idx) { return bucket_idx / DIRECTORY_ARRAY_SIZE; }
+
+  /**
+   * @param bucket_idx an index into the logical directory
+   * @return the slot of bucket_idx within its directory page
+   */
+  static uint32_t DirectorySlot(uint32_t bucket_idx) { return bucket_idx % DIRECTORY_ARRAY_SIZE; }
+
+ private:
+  page_id_t page_id_;
+  lsn_t lsn_;
+  uint32_t global_depth_{0};
+  page_id_t directory_page_ids_[DIRECTORY_HEADER_ARRAY_SIZE];
+};
+
+}  // namespace bustub
@@ -28,17 +28,38 @@
  */
 #define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
 
+/**
+ * HEADER_BLOCK_ARRAY_SIZE is the number of block page ids that fit in a linear probe hash header page after its
+ * 32 bytes of fixed fields, which bounds the size of the table.
+ */
+#define HEADER_BLOCK_ARRAY_SIZE ((PAGE_SIZE - 32) / sizeof(page_id_t))
+
 /**
  * Extendible Hashing Definitions
  */
 #define HASH_TABLE_BUCKET_TYPE HashTableBucketPage<KeyType, ValueType, KeyComparator>
 #define DIRECTORY_ARRAY_SIZE 512
 
+/**
+ * DIRECTORY_HEADER_ARRAY_SIZE is the number of directory pages an extendible hash table header page can point to. The
+ * directory pages together form one logical directory of up to DIRECTORY_ARRAY_SIZE * DIRECTORY_HEADER_ARRAY_SIZE
+ * entries, i.e. a global depth of at most MAX_GLOBAL_DEPTH.
+ *
+ * This caps a table at 2^18 = 262144 buckets. Both arrays double, so both hold a power of two entries, and 1024 page
+ * ids would leave the header page no room for its global depth; going past the cap takes another level of directory
+ * pages. Full buckets at the cap hold BUCKET_ARRAY_SIZE entries each: some 115 million (int, int) pairs, or 14 million
+ * (GenericKey<64>, RID) ones. Once the bucket of a key is full at the maximum depth, inserting it fails.
+ */
+#define DIRECTORY_HEADER_ARRAY_SIZE 512
+#define DIRECTORY_HEADER_ARRAY_DEPTH 9
+#define DIRECTORY_ARRAY_DEPTH 9
+#define MAX_GLOBAL_DEPTH (DIRECTORY_ARRAY_DEPTH + DIRECTORY_HEADER_ARRAY_DEPTH)
+
 /**
  * BUCKET_ARRAY_SIZE is the number of (key, value) pairs that can be stored in an extendible hashing bucket page.
  * It is an approximate calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType).
- * For each key/value pair, we need two additional bits for occupied_ and readable_. 4 * (PAGE_SIZE - 4) / (4 * sizeof
- * (MappingType) + 1) = (PAGE_SIZE - 4)/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required
- * to maintain the occupied and readable flags for a key value pair.
+ * For each key/value pair, we need two additional bits for occupied_ and readable_ and one byte for its fingerprint.
+ * 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 5) = PAGE_SIZE/(sizeof (MappingType) + 1.25) because 1.25 bytes = 10
+ * bits is the space required to maintain the fingerprint and the occupied and readable flags for a key value pair.
  */
-#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+#define BUCKET_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 5))
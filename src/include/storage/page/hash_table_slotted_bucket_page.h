@@ -0,0 +1,219 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_slotted_bucket_page.h
+//
+// Identification: src/include/storage/page/hash_table_slotted_bucket_page.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/index/varlen_key.h"
+#include "storage/page/hash_table_page_defs.h"
+
+namespace bustub {
+/**
+ * Extendible hash table bucket page for variable-length keys. Offers the same
+ * interface as HashTableBucketPage, with VarlenKey as the key type.
+ *
+ * Slotted bucket page format:
+ *  ------------------------------------------------------------------------------
+ * | HEADER | SLOT(1) | SLOT(2) | ... | SLOT(n) | FREE SPACE | ENTRY(n) ... ENTRY(1)
+ *  ------------------------------------------------------------------------------
+ *
+ *  Header format (size in bytes, 8 bytes in total):
+ *  ---------------------------------------------------------------
+ * | NumSlots (2) | DataSize (2) | BytesUsed (2) | NumReadable (2) |
+ *  ---------------------------------------------------------------
+ *
+ *  Each slot holds the offset and length of its entry, the key's fingerprint
+ *  and whether the slot is readable. Entries are the key bytes followed by
+ *  the value, and grow from the end of the page towards the slot array.
+ *
+ *  Removing an entry leaves its slot behind as a tombstone, so slot indexes
+ *  stay stable while a split walks the bucket. The space of removed entries
+ *  is given back by Compact, which Insert calls once the free space between
+ *  the slot array and the entries runs out.
+ *
+ *  A bucket can also be kept sorted, by only ever modifying it through the
+ *  *Sorted methods. Its slots then hold no tombstones and are in key order.
+ */
+template <typename ValueType, typename KeyComparator>
+class HashTableSlottedBucketPage {
+ public:
+  // Delete all constructor / destructor to ensure memory safety
+  HashTableSlottedBucketPage() = delete;
+
+  /**
+   * Scan the bucket and collect values that have the matching key
+   *
+   * @param hash the directory hash of key, which fingerprints come from
+   * @return true if at least one key matched
+   */
+  bool GetValue(const VarlenKey &key, uint32_t hash, KeyComparator cmp, std::vector<ValueType> *result);
+
+  /**
+   * Attempts to insert a key and value in the bucket, after the last slot.
+   *
+   * @param key key to insert
+   * @param value value to insert
+   * @param hash the directory hash of key
+   * @return true if inserted, false if duplicate KV pair or the entry does not fit
+   */
+  bool Insert(const VarlenKey &key, ValueType value, uint32_t hash, KeyComparator cmp);
+
+  /**
+   * Removes a key and value, leaving a tombstone in its slot.
+   *
+   * @return true if removed, false if not found
+   */
+  bool Remove(const VarlenKey &key, ValueType value, uint32_t hash, KeyComparator cmp);
+
+  /**
+   * Inserts a key and value into a sorted bucket, after any entries with an equal key.
+   *
+   * @return true if inserted, false if duplicate KV pair or the entry does not fit
+   */
+  bool InsertSorted(const VarlenKey &key, ValueType value, uint32_t hash, KeyComparator cmp);
+
+  /**
+   * Removes a key and value from a sorted bucket, shifting the following slots down.
+   *
+   * @return true if removed, false if not found
+   */
+  bool RemoveSorted(const VarlenKey &key, ValueType value, KeyComparator cmp);
+
+  /**
+   * Binary-searches a sorted bucket.
+   *
+   * @return the index of the first entry whose key is not less than key
+   */
+  uint32_t LowerBound(const VarlenKey &key, KeyComparator cmp);
+
+  /**
+   * Drops the tombstones from the slot array, keeping the order of the remaining slots, and packs the entries
+   * against the end of the page.
+   */
+  void Compact();
+
+  /**
+   * @param bucket_idx the index of a slot
+   * @return a copy of the key in the slot
+   */
+  VarlenKey KeyAt(uint32_t bucket_idx) const;
+
+  /**
+   * @param bucket_idx the index of a slot
+   * @return the value in the slot
+   */
+  ValueType ValueAt(uint32_t bucket_idx) const;
+
+  /**
+   * Remove the KV pair at bucket_idx, leaving a tombstone
+   */
+  void RemoveAt(uint32_t bucket_idx);
+
+  /**
+   * @return true if bucket_idx is below NumSlots(), i.e. holds an entry or a tombstone
+   */
+  bool IsOccupied(uint32_t bucket_idx) const;
+
+  /**
+   * @return true if bucket_idx holds an entry
+   */
+  bool IsReadable(uint32_t bucket_idx) const;
+
+  /**
+   * @return the number of slots, including tombstones
+   */
+  uint32_t NumSlots() const;
+
+  /**
+   * @return the number of readable elements, i.e. current size
+   */
+  uint32_t NumReadable() const;
+
+  /**
+   * @return whether an entry with key would fit, possibly after compaction
+   */
+  bool HasSpaceFor(const VarlenKey &key) const;
+
+  /**
+   * @return whether an entry with key fits in an empty bucket
+   */
+  static bool Fits(const VarlenKey &key) { return EntrySize(key) <= BytesCapacity(); }
+
+  /**
+   * @return the bytes taken up by the readable entries and their slots
+   */
+  uint32_t BytesUsed() const;
+
+  /**
+   * @return the bytes available for entries and slots in an empty bucket
+   */
+  static constexpr uint32_t BytesCapacity() { return PAGE_SIZE - HEADER_SIZE; }
+
+  /**
+   * @return whether the bucket is empty
+   */
+  bool IsEmpty() const;
+
+  /**
+   * Prints the bucket's occupancy information
+   */
+  void PrintBucket() const;
+
+ private:
+  struct Slot {
+    uint16_t offset_;
+    uint16_t key_size_;
+    uint8_t fingerprint_;
+    uint8_t readable_;
+  };
+
+  static constexpr uint32_t HEADER_SIZE = 8;
+
+  /**
+   * @return the bytes an entry with key takes up, including its slot
+   */
+  static uint32_t EntrySize(const VarlenKey &key);
+
+  /**
+   * @return the 8-bit fingerprint stored alongside a key: the top byte of its directory hash, independent of the
+   * low bits, at most MAX_GLOBAL_DEPTH of them, that the directory picks this bucket by
+   */
+  static uint8_t Fingerprint(uint32_t hash) { return static_cast<uint8_t>(hash >> 24); }
+
+  /**
+   * @return the contiguous free bytes between the slot array and the entries
+   */
+  uint32_t FreeSpace() const;
+
+  /**
+   * @return the comparator's result for the key in slot bucket_idx against key
+   */
+  int CompareAt(uint32_t bucket_idx, const VarlenKey &key, KeyComparator cmp) const;
+
+  /**
+   * Writes key and value to the entry area and fills in slot bucket_idx. The caller must have made room.
+   */
+  void WriteEntry(uint32_t bucket_idx, const VarlenKey &key, const ValueType &value, uint8_t fingerprint);
+
+  uint16_t num_slots_;
+  // bytes taken up by entries at the end of the page, including those of tombstones
+  uint16_t data_size_;
+  uint16_t bytes_used_;
+  uint16_t num_readable_;
+  // Do not add any members below slots_, as they will overlap.
+  Slot slots_[0];
+};
+
+}  // namespace bustub
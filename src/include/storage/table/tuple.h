@@ -77,6 +77,9 @@ class Tuple {
   // Generates a key tuple given schemas and attributes
   Tuple KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs);
 
+  // Generates a tuple of schema from a key tuple, with the key attributes set and all other columns NULL
+  Tuple TupleFromKey(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) const;
+
   // Is the column value null ?
   inline bool IsNull(const Schema *schema, uint32_t column_idx) const {
     Value value = GetValue(schema, column_idx);
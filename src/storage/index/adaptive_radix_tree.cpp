@@ -0,0 +1,533 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree.cpp
+//
+// Identification: src/storage/index/adaptive_radix_tree.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string_view>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "storage/index/adaptive_radix_tree.h"
+
+namespace bustub {
+
+namespace {
+
+enum class NodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+// the number of children below which a node is replaced with the next smaller one
+constexpr uint16_t NODE16_MIN_CHILDREN = 4;
+constexpr uint16_t NODE48_MIN_CHILDREN = 13;
+constexpr uint16_t NODE256_MIN_CHILDREN = 38;
+
+uint8_t ByteAt(const std::string &key, size_t depth) { return static_cast<uint8_t>(key[depth]); }
+
+// inserts byte and child into the sorted arrays of a Node4 or Node16, which have room for them
+template <typename Child, size_t N>
+void InsertSorted(uint8_t (&keys)[N], Child (&children)[N], uint16_t *num_children, uint8_t byte, Child child) {
+  uint16_t pos = std::lower_bound(keys, keys + *num_children, byte) - keys;
+  for (uint16_t i = *num_children; i > pos; i--) {
+    keys[i] = keys[i - 1];
+    children[i] = std::move(children[i - 1]);
+  }
+  keys[pos] = byte;
+  children[pos] = std::move(child);
+  (*num_children)++;
+}
+
+// removes byte and its child from the sorted arrays of a Node4 or Node16
+template <typename Child, size_t N>
+void EraseSorted(uint8_t (&keys)[N], Child (&children)[N], uint16_t *num_children, uint8_t byte) {
+  uint16_t pos = std::lower_bound(keys, keys + *num_children, byte) - keys;
+  for (uint16_t i = pos; i + 1 < *num_children; i++) {
+    keys[i] = keys[i + 1];
+    children[i] = std::move(children[i + 1]);
+  }
+  (*num_children)--;
+  keys[*num_children] = 0;
+  children[*num_children] = nullptr;
+}
+
+}  // namespace
+
+struct AdaptiveRadixTree::Node {
+  explicit Node(NodeType type) : type_(type) {}
+  virtual ~Node() = default;
+
+  NodeType type_;
+  uint16_t num_children_{0};
+  /** The key bytes all keys below an inner node share, after the byte that leads to the node. */
+  std::string prefix_;
+};
+
+struct AdaptiveRadixTree::Leaf : Node {
+  Leaf(std::string key, RID rid) : Node(NodeType::LEAF), key_(std::move(key)), rids_{rid} {}
+
+  std::string key_;
+  std::vector<RID> rids_;
+};
+
+struct AdaptiveRadixTree::Node4 : Node {
+  Node4() : Node(NodeType::NODE4) {}
+
+  uint8_t keys_[4]{};
+  std::unique_ptr<Node> children_[4];
+};
+
+struct AdaptiveRadixTree::Node16 : Node {
+  Node16() : Node(NodeType::NODE16) {}
+
+  // all 16 bytes are compared at once, so the unused ones are kept initialized
+  alignas(16) uint8_t keys_[16]{};
+  std::unique_ptr<Node> children_[16];
+};
+
+struct AdaptiveRadixTree::Node48 : Node {
+  Node48() : Node(NodeType::NODE48) {}
+
+  /** The slot of the child under each byte plus one, 0 for none. */
+  uint8_t child_index_[256]{};
+  std::unique_ptr<Node> children_[48];
+};
+
+struct AdaptiveRadixTree::Node256 : Node {
+  Node256() : Node(NodeType::NODE256) {}
+
+  std::unique_ptr<Node> children_[256];
+};
+
+AdaptiveRadixTree::AdaptiveRadixTree(bool unique) : unique_(unique) {}
+
+AdaptiveRadixTree::~AdaptiveRadixTree() = default;
+
+bool AdaptiveRadixTree::Insert(const std::string &key, RID rid) {
+  latch_.WLock();
+  bool inserted = InsertInto(&root_, key, 0, rid);
+  latch_.WUnlock();
+  return inserted;
+}
+
+bool AdaptiveRadixTree::Remove(const std::string &key, RID rid) {
+  latch_.WLock();
+  bool removed = RemoveFrom(&root_, key, 0, rid);
+  latch_.WUnlock();
+  return removed;
+}
+
+bool AdaptiveRadixTree::GetValue(const std::string &key, std::vector<RID> *result) {
+  latch_.RLock();
+  Node *node = root_.get();
+  size_t depth = 0;
+  while (node != nullptr && node->type_ != NodeType::LEAF) {
+    if (!PrefixMatches(node, key, depth)) {
+      node = nullptr;
+      break;
+    }
+    depth += node->prefix_.size();
+    std::unique_ptr<Node> *child = depth < key.size() ? FindChild(node, ByteAt(key, depth)) : nullptr;
+    node = child != nullptr ? child->get() : nullptr;
+    depth++;
+  }
+  // the path only compared some of the bytes, the leaf compares them all
+  bool found = node != nullptr && static_cast<Leaf *>(node)->key_ == key;
+  if (found) {
+    const auto &rids = static_cast<Leaf *>(node)->rids_;
+    result->insert(result->end(), rids.begin(), rids.end());
+  }
+  latch_.RUnlock();
+  return found;
+}
+
+void AdaptiveRadixTree::Scan(const std::string *low, bool low_inclusive,
+                             const std::function<bool(const std::string &, RID)> &callback) {
+  latch_.RLock();
+  if (root_ != nullptr) {
+    ScanFrom(root_.get(), 0, low, low_inclusive, callback);
+  }
+  latch_.RUnlock();
+}
+
+bool AdaptiveRadixTree::InsertInto(std::unique_ptr<Node> *node_ref, const std::string &key, size_t depth, RID rid) {
+  Node *node = node_ref->get();
+  if (node == nullptr) {
+    *node_ref = std::make_unique<Leaf>(key, rid);
+    return true;
+  }
+
+  if (node->type_ == NodeType::LEAF) {
+    auto *leaf = static_cast<Leaf *>(node);
+    if (leaf->key_ == key) {
+      if (unique_ || std::find(leaf->rids_.begin(), leaf->rids_.end(), rid) != leaf->rids_.end()) {
+        return false;
+      }
+      leaf->rids_.push_back(rid);
+      return true;
+    }
+    // branch where the keys first differ, which is before either ends as neither is a prefix of the other
+    size_t mismatch = depth;
+    while (mismatch < key.size() && mismatch < leaf->key_.size() && key[mismatch] == leaf->key_[mismatch]) {
+      mismatch++;
+    }
+    BUSTUB_ASSERT(mismatch < key.size() && mismatch < leaf->key_.size(), "a key is a prefix of another");
+    std::unique_ptr<Node> inner = std::make_unique<Node4>();
+    inner->prefix_ = key.substr(depth, mismatch - depth);
+    uint8_t leaf_byte = ByteAt(leaf->key_, mismatch);
+    AddChild(&inner, leaf_byte, std::move(*node_ref));
+    AddChild(&inner, ByteAt(key, mismatch), std::make_unique<Leaf>(key, rid));
+    *node_ref = std::move(inner);
+    return true;
+  }
+
+  // a key that leaves the prefix branches off above the node
+  size_t matched = 0;
+  while (matched < node->prefix_.size() && depth + matched < key.size() &&
+         node->prefix_[matched] == key[depth + matched]) {
+    matched++;
+  }
+  if (matched < node->prefix_.size()) {
+    BUSTUB_ASSERT(depth + matched < key.size(), "a key is a prefix of another");
+    std::unique_ptr<Node> inner = std::make_unique<Node4>();
+    inner->prefix_ = node->prefix_.substr(0, matched);
+    uint8_t node_byte = static_cast<uint8_t>(node->prefix_[matched]);
+    node->prefix_.erase(0, matched + 1);
+    AddChild(&inner, node_byte, std::move(*node_ref));
+    AddChild(&inner, ByteAt(key, depth + matched), std::make_unique<Leaf>(key, rid));
+    *node_ref = std::move(inner);
+    return true;
+  }
+
+  depth += node->prefix_.size();
+  BUSTUB_ASSERT(depth < key.size(), "a key is a prefix of another");
+  std::unique_ptr<Node> *child = FindChild(node, ByteAt(key, depth));
+  if (child != nullptr) {
+    return InsertInto(child, key, depth + 1, rid);
+  }
+  AddChild(node_ref, ByteAt(key, depth), std::make_unique<Leaf>(key, rid));
+  return true;
+}
+
+bool AdaptiveRadixTree::RemoveFrom(std::unique_ptr<Node> *node_ref, const std::string &key, size_t depth, RID rid) {
+  Node *node = node_ref->get();
+  if (node == nullptr) {
+    return false;
+  }
+
+  if (node->type_ == NodeType::LEAF) {
+    auto *leaf = static_cast<Leaf *>(node);
+    if (leaf->key_ != key) {
+      return false;
+    }
+    if (!unique_) {
+      auto it = std::find(leaf->rids_.begin(), leaf->rids_.end(), rid);
+      if (it == leaf->rids_.end()) {
+        return false;
+      }
+      leaf->rids_.erase(it);
+    }
+    if (unique_ || leaf->rids_.empty()) {
+      node_ref->reset();
+    }
+    return true;
+  }
+
+  if (!PrefixMatches(node, key, depth)) {
+    return false;
+  }
+  depth += node->prefix_.size();
+  if (depth >= key.size()) {
+    return false;
+  }
+  uint8_t byte = ByteAt(key, depth);
+  std::unique_ptr<Node> *child = FindChild(node, byte);
+  if (child == nullptr || !RemoveFrom(child, key, depth + 1, rid)) {
+    return false;
+  }
+  if (*child == nullptr) {
+    RemoveChild(node_ref, byte);
+  }
+  return true;
+}
+
+bool AdaptiveRadixTree::ScanFrom(const Node *node, size_t depth, const std::string *low, bool low_inclusive,
+                                 const std::function<bool(const std::string &, RID)> &callback) {
+  if (node->type_ == NodeType::LEAF) {
+    const auto *leaf = static_cast<const Leaf *>(node);
+    if (low != nullptr) {
+      int cmp = leaf->key_.compare(*low);
+      if (cmp < 0 || (cmp == 0 && !low_inclusive)) {
+        return true;
+      }
+    }
+    for (const RID &rid : leaf->rids_) {
+      if (!callback(leaf->key_, rid)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint8_t from = 0;
+  if (low != nullptr) {
+    // the prefix orders the keys below the node against low, unless they share it
+    std::string_view low_bytes = std::string_view(*low).substr(std::min(depth, low->size()));
+    int cmp = std::string_view(node->prefix_).compare(low_bytes.substr(0, node->prefix_.size()));
+    if (cmp < 0) {
+      return true;
+    }
+    depth += node->prefix_.size();
+    if (cmp > 0 || depth >= low->size()) {
+      low = nullptr;
+    } else {
+      from = ByteAt(*low, depth);
+    }
+  } else {
+    depth += node->prefix_.size();
+  }
+
+  return ForEachChild(node, from, [&](uint8_t byte, const Node *child) {
+    // only the keys under the byte of low can still be less than it
+    return ScanFrom(child, depth + 1, low != nullptr && byte == from ? low : nullptr, low_inclusive, callback);
+  });
+}
+
+bool AdaptiveRadixTree::PrefixMatches(const Node *node, const std::string &key, size_t depth) {
+  return depth + node->prefix_.size() <= key.size() && key.compare(depth, node->prefix_.size(), node->prefix_) == 0;
+}
+
+std::unique_ptr<AdaptiveRadixTree::Node> *AdaptiveRadixTree::FindChild(Node *node, uint8_t byte) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      for (uint16_t i = 0; i < node4->num_children_; i++) {
+        if (node4->keys_[i] == byte) {
+          return &node4->children_[i];
+        }
+      }
+      return nullptr;
+    }
+    case NodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+#ifdef __SSE2__
+      __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                       _mm_load_si128(reinterpret_cast<const __m128i *>(node16->keys_)));
+      uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches)) & ((1U << node16->num_children_) - 1);
+      return mask != 0 ? &node16->children_[__builtin_ctz(mask)] : nullptr;
+#else
+      uint8_t *end = node16->keys_ + node16->num_children_;
+      uint8_t *it = std::lower_bound(node16->keys_, end, byte);
+      return it != end && *it == byte ? &node16->children_[it - node16->keys_] : nullptr;
+#endif
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      uint8_t slot = node48->child_index_[byte];
+      return slot != 0 ? &node48->children_[slot - 1] : nullptr;
+    }
+    case NodeType::NODE256: {
+      auto *node256 = static_cast<Node256 *>(node);
+      return node256->children_[byte] != nullptr ? &node256->children_[byte] : nullptr;
+    }
+    default:
+      return nullptr;
+  }
+}
+
+void AdaptiveRadixTree::AddChild(std::unique_ptr<Node> *node_ref, uint8_t byte, std::unique_ptr<Node> child) {
+  Node *node = node_ref->get();
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      if (node4->num_children_ < 4) {
+        InsertSorted(node4->keys_, node4->children_, &node4->num_children_, byte, std::move(child));
+        return;
+      }
+      auto node16 = std::make_unique<Node16>();
+      for (uint16_t i = 0; i < 4; i++) {
+        node16->keys_[i] = node4->keys_[i];
+        node16->children_[i] = std::move(node4->children_[i]);
+      }
+      node16->num_children_ = 4;
+      node16->prefix_ = std::move(node4->prefix_);
+      *node_ref = std::move(node16);
+      break;
+    }
+    case NodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      if (node16->num_children_ < 16) {
+        InsertSorted(node16->keys_, node16->children_, &node16->num_children_, byte, std::move(child));
+        return;
+      }
+      auto node48 = std::make_unique<Node48>();
+      for (uint16_t i = 0; i < 16; i++) {
+        node48->child_index_[node16->keys_[i]] = i + 1;
+        node48->children_[i] = std::move(node16->children_[i]);
+      }
+      node48->num_children_ = 16;
+      node48->prefix_ = std::move(node16->prefix_);
+      *node_ref = std::move(node48);
+      break;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      if (node48->num_children_ < 48) {
+        uint8_t slot = 0;
+        while (node48->children_[slot] != nullptr) {
+          slot++;
+        }
+        node48->child_index_[byte] = slot + 1;
+        node48->children_[slot] = std::move(child);
+        node48->num_children_++;
+        return;
+      }
+      auto node256 = std::make_unique<Node256>();
+      for (uint16_t b = 0; b < 256; b++) {
+        if (node48->child_index_[b] != 0) {
+          node256->children_[b] = std::move(node48->children_[node48->child_index_[b] - 1]);
+        }
+      }
+      node256->num_children_ = 48;
+      node256->prefix_ = std::move(node48->prefix_);
+      *node_ref = std::move(node256);
+      break;
+    }
+    case NodeType::NODE256: {
+      auto *node256 = static_cast<Node256 *>(node);
+      node256->children_[byte] = std::move(child);
+      node256->num_children_++;
+      return;
+    }
+    default:
+      BUSTUB_ASSERT(false, "a leaf has no children");
+  }
+  // the node was full and has been replaced with a larger one
+  AddChild(node_ref, byte, std::move(child));
+}
+
+void AdaptiveRadixTree::RemoveChild(std::unique_ptr<Node> *node_ref, uint8_t byte) {
+  Node *node = node_ref->get();
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      auto *node4 = static_cast<Node4 *>(node);
+      EraseSorted(node4->keys_, node4->children_, &node4->num_children_, byte);
+      if (node4->num_children_ == 1) {
+        // a single child takes the place of the node, and an inner one its prefix
+        std::unique_ptr<Node> child = std::move(node4->children_[0]);
+        if (child->type_ != NodeType::LEAF) {
+          child->prefix_ = node4->prefix_ + static_cast<char>(node4->keys_[0]) + child->prefix_;
+        }
+        *node_ref = std::move(child);
+      }
+      return;
+    }
+    case NodeType::NODE16: {
+      auto *node16 = static_cast<Node16 *>(node);
+      EraseSorted(node16->keys_, node16->children_, &node16->num_children_, byte);
+      if (node16->num_children_ < NODE16_MIN_CHILDREN) {
+        auto node4 = std::make_unique<Node4>();
+        for (uint16_t i = 0; i < node16->num_children_; i++) {
+          node4->keys_[i] = node16->keys_[i];
+          node4->children_[i] = std::move(node16->children_[i]);
+        }
+        node4->num_children_ = node16->num_children_;
+        node4->prefix_ = std::move(node16->prefix_);
+        *node_ref = std::move(node4);
+      }
+      return;
+    }
+    case NodeType::NODE48: {
+      auto *node48 = static_cast<Node48 *>(node);
+      node48->children_[node48->child_index_[byte] - 1] = nullptr;
+      node48->child_index_[byte] = 0;
+      node48->num_children_--;
+      if (node48->num_children_ < NODE48_MIN_CHILDREN) {
+        auto node16 = std::make_unique<Node16>();
+        for (uint16_t b = 0; b < 256; b++) {
+          if (node48->child_index_[b] != 0) {
+            node16->keys_[node16->num_children_] = b;
+            node16->children_[node16->num_children_++] = std::move(node48->children_[node48->child_index_[b] - 1]);
+          }
+        }
+        node16->prefix_ = std::move(node48->prefix_);
+        *node_ref = std::move(node16);
+      }
+      return;
+    }
+    case NodeType::NODE256: {
+      auto *node256 = static_cast<Node256 *>(node);
+      node256->children_[byte] = nullptr;
+      node256->num_children_--;
+      if (node256->num_children_ < NODE256_MIN_CHILDREN) {
+        auto node48 = std::make_unique<Node48>();
+        for (uint16_t b = 0; b < 256; b++) {
+          if (node256->children_[b] != nullptr) {
+            node48->children_[node48->num_children_] = std::move(node256->children_[b]);
+            node48->child_index_[b] = ++node48->num_children_;
+          }
+        }
+        node48->prefix_ = std::move(node256->prefix_);
+        *node_ref = std::move(node48);
+      }
+      return;
+    }
+    default:
+      BUSTUB_ASSERT(false, "a leaf has no children");
+  }
+}
+
+template <typename Visitor>
+bool AdaptiveRadixTree::ForEachChild(const Node *node, uint8_t from, const Visitor &visit) {
+  switch (node->type_) {
+    case NodeType::NODE4: {
+      const auto *node4 = static_cast<const Node4 *>(node);
+      for (uint16_t i = 0; i < node4->num_children_; i++) {
+        if (node4->keys_[i] >= from && !visit(node4->keys_[i], node4->children_[i].get())) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case NodeType::NODE16: {
+      const auto *node16 = static_cast<const Node16 *>(node);
+      for (uint16_t i = 0; i < node16->num_children_; i++) {
+        if (node16->keys_[i] >= from && !visit(node16->keys_[i], node16->children_[i].get())) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case NodeType::NODE48: {
+      const auto *node48 = static_cast<const Node48 *>(node);
+      for (uint16_t b = from; b < 256; b++) {
+        uint8_t slot = node48->child_index_[b];
+        if (slot != 0 && !visit(b, node48->children_[slot - 1].get())) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case NodeType::NODE256: {
+      const auto *node256 = static_cast<const Node256 *>(node);
+      for (uint16_t b = from; b < 256; b++) {
+        if (node256->children_[b] != nullptr && !visit(b, node256->children_[b].get())) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default:
+      return true;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_index.cpp
+//
+// Identification: src/storage/index/adaptive_radix_tree_index.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/adaptive_radix_tree_index.h"
+#include "storage/index/key_encoder.h"
+
+namespace bustub {
+
+AdaptiveRadixTreeIndex::AdaptiveRadixTreeIndex(std::unique_ptr<IndexMetadata> &&metadata)
+    : Index(std::move(metadata)), container_(GetMetadata()->IsUnique()) {}
+
+void AdaptiveRadixTreeIndex::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Insert(KeyEncoder::Encode(key, GetKeySchema()), rid);
+}
+
+void AdaptiveRadixTreeIndex::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
+  container_.Remove(KeyEncoder::Encode(key, GetKeySchema()), rid);
+}
+
+void AdaptiveRadixTreeIndex::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
+  container_.GetValue(KeyEncoder::Encode(key, GetKeySchema()), result);
+}
+
+void AdaptiveRadixTreeIndex::ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                                       const std::function<bool(RID)> &callback, Transaction *transaction) {
+  ScanEntries(low, low_inclusive, high, high_inclusive,
+              [&callback](const std::string &key, RID rid) { return callback(rid); });
+}
+
+void AdaptiveRadixTreeIndex::ScanRangeKeys(const Tuple *low, bool low_inclusive, const Tuple *high,
+                                           bool high_inclusive,
+                                           const std::function<bool(const Tuple &, RID)> &callback,
+                                           Transaction *transaction) {
+  Schema *key_schema = GetKeySchema();
+  std::vector<Value> values(key_schema->GetColumnCount());
+  ScanEntries(low, low_inclusive, high, high_inclusive, [&](const std::string &key, RID rid) {
+    for (uint32_t column_idx = 0; column_idx < values.size(); column_idx++) {
+      values[column_idx] = KeyEncoder::Decode(key.data(), key.size(), key_schema, column_idx);
+    }
+    return callback(Tuple(values, key_schema), rid);
+  });
+}
+
+void AdaptiveRadixTreeIndex::ScanEntries(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                                         const std::function<bool(const std::string &, RID)> &callback) {
+  std::string low_key;
+  std::string high_key;
+  if (low != nullptr) {
+    low_key = KeyEncoder::Encode(*low, GetKeySchema());
+  }
+  if (high != nullptr) {
+    high_key = KeyEncoder::Encode(*high, GetKeySchema());
+  }
+
+  // the tree starts at low, and the scan stops at the first key past high
+  container_.Scan(low != nullptr ? &low_key : nullptr, low_inclusive, [&](const std::string &key, RID rid) {
+    if (high != nullptr) {
+      int cmp = key.compare(high_key);
+      if (cmp > 0 || (cmp == 0 && !high_inclusive)) {
+        return false;
+      }
+    }
+    return callback(key, rid);
+  });
+}
+
+}  // namespace bustub
@@ -9,29 +9,79 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstring>
+#include <functional>
 #include <string>
+#include <thread>  // NOLINT
+#include <type_traits>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/rid.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/page/b_plus_tree_meta_page.h"
 #include "storage/page/header_page.h"
 
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool unique)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      internal_max_size_(internal_max_size),
+      unique_(unique),
+      write_buffer_(KeyLess{&comparator_}),
+      flushing_writes_(KeyLess{&comparator_}) {
+  if (!unique_ && sizeof(KeyType) <= sizeof(ValueType)) {
+    throw Exception(ExceptionType::INVALID, "the keys of a non-unique B+ tree have no room for its values");
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPLUSTREE_TYPE::~BPlusTree() {
+  StopBackgroundRebalance();
+  FlushWriteBuffer();
+}
 
 /*
  * Helper function to decide whether current b+tree is empty
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
+bool BPLUSTREE_TYPE::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::KeyOf(const KeyType &key) const {
+  KeyType result = key;
+  // a non-unique tree was only created if its keys have room for a value
+  if constexpr (sizeof(KeyType) > sizeof(ValueType)) {
+    if (!unique_) {
+      memset(reinterpret_cast<char *>(&result) + sizeof(KeyType) - sizeof(ValueType), 0, sizeof(ValueType));
+    }
+  }
+  return result;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::EntryKey(const KeyType &key, const ValueType &value) const {
+  KeyType result = key;
+  if constexpr (sizeof(KeyType) > sizeof(ValueType)) {
+    memcpy(reinterpret_cast<char *>(&result) + sizeof(KeyType) - sizeof(ValueType), &value, sizeof(ValueType));
+  }
+  return result;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::LastEntryKey(const KeyType &key) const {
+  KeyType result = key;
+  if constexpr (sizeof(KeyType) > sizeof(ValueType)) {
+    memset(reinterpret_cast<char *>(&result) + sizeof(KeyType) - sizeof(ValueType), 0xFF, sizeof(ValueType));
+  }
+  return result;
+}
 /*****************************************************************************
  * SEARCH
  *****************************************************************************/
@@ -42,7 +92,339 @@ bool BPLUSTREE_TYPE::IsEmpty() const { return true; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  return false;
+  if (write_buffer_size_ > 0) {
+    return GetValueBuffered(key, result);
+  }
+  return unique_ ? GetEntry(key, result) : GetValues(key, result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetEntry(const KeyType &key, std::vector<ValueType> *result) {
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    Page *page;
+    uint32_t version;
+    if (!FindLeafOptimistic(key, LeafEdge::NONE, &page, &version)) {
+      num_restarts_++;
+      continue;
+    }
+    if (page == nullptr) {
+      num_optimistic_ops_++;
+      return false;
+    }
+    ValueType value;
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    bool found = leaf->Lookup(key, &value, comparator_);
+    bool valid = leaf->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (valid) {
+      num_optimistic_ops_++;
+      if (found) {
+        result->push_back(value);
+      }
+      return found;
+    }
+    num_restarts_++;
+  }
+
+  return GetValuePessimistic(key, result);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValues(const KeyType &key, std::vector<ValueType> *result) {
+  // the entries of key are stored under keys from KeyOf(key) on, mostly all in the leaf covering that
+  KeyType first_key = KeyOf(key);
+  size_t num_results = result->size();
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    Page *page;
+    uint32_t version;
+    if (!FindLeafOptimistic(first_key, LeafEdge::NONE, &page, &version)) {
+      num_restarts_++;
+      continue;
+    }
+    if (page == nullptr) {
+      num_optimistic_ops_++;
+      return false;
+    }
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    KeyType last_key = first_key;
+    int index = leaf->KeyIndex(first_key, comparator_);
+    for (; index < leaf->GetSize(); index++) {
+      MappingType item = leaf->GetItem(index);
+      if (comparator_(KeyOf(item.first), first_key) != 0) {
+        break;
+      }
+      result->push_back(item.second);
+      last_key = item.first;
+    }
+    bool at_end = index >= leaf->GetSize();
+    bool valid = leaf->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      result->resize(num_results);
+      num_restarts_++;
+      continue;
+    }
+    num_optimistic_ops_++;
+    if (at_end) {
+      // the entries of key may go on in the following leaves
+      ScanValues(first_key, last_key, result->size() > num_results, result);
+    }
+    return result->size() > num_results;
+  }
+
+  num_pessimistic_ops_++;
+  ScanValues(first_key, first_key, false, result);
+  return result->size() > num_results;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ScanValues(const KeyType &first_key, KeyType from_key, bool after,
+                                std::vector<ValueType> *result) {
+  std::vector<MappingType> items;
+  while (ReadLeaf(&from_key, after, false, &items) != INVALID_PAGE_ID) {
+    for (const auto &[entry_key, value] : items) {
+      if (comparator_(KeyOf(entry_key), first_key) != 0) {
+        return;
+      }
+      result->push_back(value);
+    }
+    from_key = items.back().first;
+    after = true;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValuePessimistic(const KeyType &key, std::vector<ValueType> *result) {
+  num_pessimistic_ops_++;
+  Page *page = FindLeafPageShared(key, LeafEdge::NONE);
+  if (page == nullptr) {
+    return false;
+  }
+  ValueType value;
+  bool found = reinterpret_cast<LeafPage *>(page->GetData())->Lookup(key, &value, comparator_);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (found) {
+    result->push_back(value);
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<bool> BPLUSTREE_TYPE::MultiGet(const std::vector<KeyType> &keys, std::vector<ValueType> *result,
+                                           Transaction *transaction) {
+  std::vector<bool> found(keys.size(), false);
+  if (!unique_ || write_buffer_size_ > 0) {
+    for (size_t i = 0; i < keys.size(); i++) {
+      found[i] = GetValue(keys[i], result, transaction);
+    }
+    return found;
+  }
+  std::vector<PathLevel> path;
+  ValueType value;
+  for (size_t i = 0; i < keys.size(); i++) {
+    bool done = false;
+    for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS && !done; attempt++) {
+      if (!FindLeafFromPath(keys[i], &path)) {
+        ReleasePath(&path);
+        num_restarts_++;
+        continue;
+      }
+      if (path.empty()) {
+        num_optimistic_ops_++;
+        done = true;
+        break;
+      }
+      auto *leaf = reinterpret_cast<LeafPage *>(path.back().page_->GetData());
+      bool hit = leaf->Lookup(keys[i], &value, comparator_);
+      if (!leaf->ValidateVersion(path.back().version_)) {
+        ReleasePath(&path);
+        num_restarts_++;
+        continue;
+      }
+      num_optimistic_ops_++;
+      if (hit) {
+        result->push_back(value);
+        found[i] = true;
+      }
+      done = true;
+    }
+    if (!done) {
+      // the tree is too busy around this key, so do not hold on to the pages there
+      ReleasePath(&path);
+      found[i] = GetValuePessimistic(keys[i], result);
+    }
+  }
+  ReleasePath(&path);
+  return found;
+}
+
+/*****************************************************************************
+ * BULK LOADING
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoad(const MappingType *begin, const MappingType *end, double fill_factor) {
+  FlushWriteBuffer();
+  if (unique_) {
+    return BulkLoadEntries(
+        [begin, end](const std::function<void(const MappingType &)> &emit) { std::for_each(begin, end, emit); },
+        fill_factor);
+  }
+  // the entries of each key order by their values once stored, so sort them again
+  std::vector<MappingType> entries;
+  entries.reserve(end - begin);
+  for (const MappingType *it = begin; it != end; ++it) {
+    entries.emplace_back(EntryKey(it->first, it->second), it->second);
+  }
+  std::sort(entries.begin(), entries.end(),
+            [this](const MappingType &lhs, const MappingType &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+  return BulkLoadEntries(
+      [&entries](const std::function<void(const MappingType &)> &emit) {
+        std::for_each(entries.begin(), entries.end(), emit);
+      },
+      fill_factor);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoadUnsorted(const std::function<bool(MappingType *)> &next, double fill_factor,
+                                      size_t run_size) {
+  FlushWriteBuffer();
+  if (!IsEmpty()) {
+    return false;
+  }
+  ExternalSort<KeyType, ValueType, KeyComparator> sort(buffer_pool_manager_, comparator_, run_size);
+  MappingType entry;
+  while (next(&entry)) {
+    sort.Add(unique_ ? entry.first : EntryKey(entry.first, entry.second), entry.second);
+  }
+  return BulkLoadEntries([&sort](const std::function<void(const MappingType &)> &emit) { sort.Scan(emit); },
+                         fill_factor);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::BulkLoadEntries(const EntryScan &scan, double fill_factor) {
+  // the shape of the tree is planned from the number of distinct keys
+  int64_t num_entries = 0;
+  KeyType previous_key;
+  scan([&](const MappingType &entry) {
+    int cmp = num_entries == 0 ? 1 : comparator_(entry.first, previous_key);
+    if (cmp < 0) {
+      throw Exception(ExceptionType::INVALID, "bulk load entries are not sorted");
+    }
+    num_entries += cmp > 0 ? 1 : 0;
+    previous_key = entry.first;
+  });
+
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+  if (num_entries == 0) {
+    root_latch_.WUnlock();
+    return true;
+  }
+
+  // Leaves split as soon as they are full, internal pages only once they overflow. The pages are planned before
+  // their keys are seen, so they are filled as if the keys had no bytes in common.
+  int leaf_max_size = std::max(LeafPage::MaxSize(leaf_max_size_, 0) - 1, 1);
+  int leaf_min_size = std::min(LeafPage::MaxSize(leaf_max_size_, 0) / 2, leaf_max_size);
+  int leaf_capacity =
+      std::clamp(static_cast<int>(fill_factor * leaf_max_size), std::max(leaf_min_size, 1), leaf_max_size);
+  int internal_max_size = InternalPage::MaxSize(internal_max_size_, 0);
+  int internal_min_size = (internal_max_size + 1) / 2;
+  int internal_capacity = std::clamp(static_cast<int>(fill_factor * internal_max_size),
+                                     std::max(internal_min_size, 2), internal_max_size);
+  std::vector<std::vector<int>> plan{PlanBulkLoadLevel(num_entries, leaf_capacity, leaf_min_size, leaf_max_size)};
+  while (plan.back().size() > 1) {
+    plan.push_back(PlanBulkLoadLevel(plan.back().size(), internal_capacity, internal_min_size, internal_max_size));
+  }
+
+  // the tree only becomes visible once the root is set, so none of its pages need latching
+  std::vector<BulkLoadCursor> cursors(plan.size());
+  bool first = true;
+  scan([&](const MappingType &entry) {
+    if (!first && comparator_(entry.first, previous_key) == 0) {
+      return;
+    }
+    first = false;
+    previous_key = entry.first;
+    Page *page = BulkLoadPage(0, entry.first, plan, &cursors);
+    reinterpret_cast<LeafPage *>(page->GetData())->Append(entry.first, entry.second, comparator_);
+  });
+  page_id_t root_page_id = cursors.back().page_->GetPageId();
+  for (auto &cursor : cursors) {
+    buffer_pool_manager_->UnpinPage(cursor.page_->GetPageId(), true);
+  }
+  SetRoot(root_page_id);
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+std::vector<int> BPLUSTREE_TYPE::PlanBulkLoadLevel(int64_t count, int capacity, int min_size, int max_size) {
+  std::vector<int> sizes(count / capacity, capacity);
+  int rest = static_cast<int>(count % capacity);
+  if (rest == 0) {
+    return sizes;
+  }
+  if (rest >= min_size || sizes.empty()) {
+    sizes.push_back(rest);
+    return sizes;
+  }
+  int total = sizes.back() + rest;
+  if (total <= max_size) {
+    sizes.back() = total;
+  } else {
+    // total exceeds max_size, so both halves hold at least (max_size + 1) / 2, which is no less than min_size
+    sizes.back() = total - total / 2;
+    sizes.push_back(total / 2);
+  }
+  return sizes;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::BulkLoadPage(size_t level, const KeyType &key, const std::vector<std::vector<int>> &plan,
+                                   std::vector<BulkLoadCursor> *cursors) {
+  BulkLoadCursor &cursor = (*cursors)[level];
+  if (cursor.page_ != nullptr && cursor.size_ < plan[level][cursor.num_pages_ - 1]) {
+    cursor.size_++;
+    return cursor.page_;
+  }
+
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to bulk load into");
+  }
+  page_id_t parent_page_id = INVALID_PAGE_ID;
+  if (level + 1 < plan.size()) {
+    KeyType separator = key;
+    if (level == 0 && cursor.page_ != nullptr) {
+      auto *previous = reinterpret_cast<LeafPage *>(cursor.page_->GetData());
+      separator = SeparatorKey(previous->KeyAt(previous->GetSize() - 1), key);
+    }
+    Page *parent_page = BulkLoadPage(level + 1, separator, plan, cursors);
+    reinterpret_cast<InternalPage *>(parent_page->GetData())->Append(separator, page_id, comparator_);
+    parent_page_id = parent_page->GetPageId();
+  }
+  if (level == 0) {
+    reinterpret_cast<LeafPage *>(page->GetData())->Init(page_id, parent_page_id, leaf_max_size_);
+  } else {
+    reinterpret_cast<InternalPage *>(page->GetData())->Init(page_id, parent_page_id, internal_max_size_);
+  }
+
+  if (cursor.page_ != nullptr) {
+    if (level == 0) {
+      reinterpret_cast<LeafPage *>(cursor.page_->GetData())->SetNextPageId(page_id);
+      reinterpret_cast<LeafPage *>(page->GetData())->SetPrevPageId(cursor.page_->GetPageId());
+    }
+    buffer_pool_manager_->UnpinPage(cursor.page_->GetPageId(), true);
+  }
+  cursor.page_ = page;
+  cursor.num_pages_++;
+  cursor.size_ = 1;
+  return page;
 }
 
 /*****************************************************************************
@@ -56,7 +438,84 @@ bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) { return false; }
+bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  KeyType entry_key = unique_ ? key : EntryKey(key, value);
+  if (write_buffer_size_ > 0) {
+    return InsertBuffered(entry_key, value, transaction);
+  }
+  return InsertEntry(entry_key, value, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertEntry(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    Page *page;
+    uint32_t version;
+    if (!FindLeafOptimistic(key, LeafEdge::NONE, &page, &version)) {
+      num_restarts_++;
+      continue;
+    }
+    if (page == nullptr) {
+      // starting a new tree changes the root
+      break;
+    }
+    page->WLatch();
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (!leaf->ValidateVersion(version)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      num_restarts_++;
+      continue;
+    }
+    ValueType existing;
+    if (leaf->Lookup(key, &existing, comparator_)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      num_optimistic_ops_++;
+      return false;
+    }
+    if (!IsSafe(leaf, Operation::INSERT, key)) {
+      // the leaf would split, which needs its ancestors latched
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      break;
+    }
+    leaf->LockVersion();
+    leaf->Insert(key, value, comparator_);
+    leaf->UnlockVersion();
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    num_optimistic_ops_++;
+    return true;
+  }
+
+  num_pessimistic_ops_++;
+  if (transaction != nullptr) {
+    return InsertPessimistic(key, value, transaction);
+  }
+  Transaction local_transaction(INVALID_TXN_ID);
+  return InsertPessimistic(key, value, &local_transaction);
+}
+
+/*
+ * Insert by write-latch crabbing from the root, splitting pages as needed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertPessimistic(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  bool inserted = true;
+  PrevLink prev_link;
+  if (IsEmpty()) {
+    StartNewTree(key, value);
+  } else {
+    inserted = InsertIntoLeaf(key, value, transaction, &prev_link);
+  }
+  ReleaseWritePages(transaction);
+  LinkPrevPage(prev_link);
+  return inserted;
+}
+
 /*
  * Insert constant key & value pair into an empty tree
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
@@ -64,7 +523,18 @@ bool BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  * tree's root page id and insert entry directly into leaf page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
+void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a root page");
+  }
+  auto *root = reinterpret_cast<LeafPage *>(page->GetData());
+  root->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+  root->Insert(key, value, comparator_);
+  SetRoot(page_id);
+  buffer_pool_manager_->UnpinPage(page_id, true);
+}
 
 /*
  * Insert constant key & value pair into leaf page
@@ -75,8 +545,33 @@ void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {}
  * keys return false, otherwise return true.
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction,
+                                    PrevLink *prev_link) {
+  Page *page = FindLeafPageExclusive(key, Operation::INSERT, transaction);
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  ValueType existing;
+  if (leaf->Lookup(key, &existing, comparator_)) {
+    return false;
+  }
+  leaf->LockVersion();
+  // a key that shares fewer bytes with the others widens every entry, and they may no longer fit without a split
+  bool split_first = !leaf->HasRoomFor(key);
+  if (!split_first && leaf->Insert(key, value, comparator_) < leaf->GetMaxSize()) {
+    return true;
+  }
+  LeafPage *new_leaf = Split(leaf);
+  if (split_first) {
+    (comparator_(key, new_leaf->KeyAt(0)) < 0 ? leaf : new_leaf)->Insert(key, value, comparator_);
+  }
+  new_leaf->SetNextPageId(leaf->GetNextPageId());
+  new_leaf->SetPrevPageId(leaf->GetPageId());
+  leaf->SetNextPageId(new_leaf->GetPageId());
+  if (new_leaf->GetNextPageId() != INVALID_PAGE_ID) {
+    prev_link->page_ = FetchPage(new_leaf->GetPageId());
+  }
+  InsertIntoParent(leaf, SeparatorKey(leaf->KeyAt(leaf->GetSize() - 1), new_leaf->KeyAt(0)), new_leaf, transaction);
+  buffer_pool_manager_->UnpinPage(new_leaf->GetPageId(), true);
+  return true;
 }
 
 /*
@@ -89,7 +584,37 @@ bool BPLUSTREE_TYPE::InsertIntoLeaf(const KeyType &key, const ValueType &value,
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
-  return nullptr;
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to split into");
+  }
+  // the new page is only reachable once its parent is released, so it needs no latch of its own
+  auto *new_node = reinterpret_cast<N *>(page->GetData());
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    new_node->Init(page_id, node->GetParentPageId(), leaf_max_size_);
+    node->MoveHalfTo(new_node);
+  } else {
+    new_node->Init(page_id, node->GetParentPageId(), internal_max_size_);
+    node->MoveHalfTo(new_node, buffer_pool_manager_);
+  }
+  return new_node;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+KeyType BPLUSTREE_TYPE::SeparatorKey(const KeyType &left, const KeyType &right) const {
+  // the comparator orders keys by their values, not their bytes, so each prefix is checked against both leaves
+  KeyType separator;
+  auto *bytes = reinterpret_cast<char *>(&separator);
+  const auto *right_bytes = reinterpret_cast<const char *>(&right);
+  memset(bytes, 0, sizeof(KeyType));
+  for (size_t length = 0; length < sizeof(KeyType); length++) {
+    if (comparator_(left, separator) < 0 && comparator_(separator, right) <= 0) {
+      return separator;
+    }
+    bytes[length] = right_bytes[length];
+  }
+  return right;
 }
 
 /*
@@ -103,7 +628,41 @@ N *BPLUSTREE_TYPE::Split(N *node) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
-                                      Transaction *transaction) {}
+                                      Transaction *transaction) {
+  if (old_node->IsRootPage()) {
+    page_id_t root_page_id;
+    Page *page = buffer_pool_manager_->NewPage(&root_page_id);
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a root page");
+    }
+    auto *root = reinterpret_cast<InternalPage *>(page->GetData());
+    root->Init(root_page_id, INVALID_PAGE_ID, internal_max_size_);
+    root->PopulateNewRoot(old_node->GetPageId(), key, new_node->GetPageId(), comparator_);
+    old_node->SetParentPageId(root_page_id);
+    new_node->SetParentPageId(root_page_id);
+    SetRoot(root_page_id);
+    buffer_pool_manager_->UnpinPage(root_page_id, true);
+    return;
+  }
+
+  // the parent is unsafe for this insert, so it is still write-latched in the page set
+  Page *parent_page = FetchPage(old_node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  parent->LockVersion();
+  bool split_first = !parent->HasRoomFor(key);
+  if (split_first ||
+      parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId(), comparator_) > parent->GetMaxSize()) {
+    InternalPage *new_parent = Split(parent);
+    if (split_first) {
+      InternalPage *half = new_parent->ValueIndex(old_node->GetPageId()) == -1 ? parent : new_parent;
+      half->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId(), comparator_);
+      new_node->SetParentPageId(half->GetPageId());
+    }
+    InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+    buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+  }
+  buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,7 +675,109 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
  * necessary.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
+void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
+  if (unique_) {
+    Remove(key, ValueType{}, transaction);
+    return;
+  }
+  // then all values of key are in the tree
+  FlushWriteBuffer(transaction);
+  std::vector<ValueType> values;
+  GetValues(key, &values);
+  for (const auto &value : values) {
+    RemoveEntry(EntryKey(key, value), transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::Remove(const KeyType &key, const ValueType &value, Transaction *transaction) {
+  KeyType entry_key = unique_ ? key : EntryKey(key, value);
+  if (write_buffer_size_ > 0) {
+    RemoveBuffered(entry_key, value, transaction);
+    return;
+  }
+  RemoveEntry(entry_key, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveEntry(const KeyType &key, Transaction *transaction) {
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    Page *page;
+    uint32_t version;
+    if (!FindLeafOptimistic(key, LeafEdge::NONE, &page, &version)) {
+      num_restarts_++;
+      continue;
+    }
+    if (page == nullptr) {
+      num_optimistic_ops_++;
+      return;
+    }
+    page->WLatch();
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (!leaf->ValidateVersion(version)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      num_restarts_++;
+      continue;
+    }
+    ValueType existing;
+    if (!leaf->Lookup(key, &existing, comparator_)) {
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      num_optimistic_ops_++;
+      return;
+    }
+    bool safe = IsSafe(leaf, Operation::REMOVE, key);
+    bool deferred = !safe && merges_deferred_ && !leaf->IsRootPage() && leaf->GetSize() > 1;
+    if (!safe && !deferred) {
+      // the leaf would underflow, which needs its parent and a sibling latched
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      break;
+    }
+    leaf->LockVersion();
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+    leaf->UnlockVersion();
+    page->WUnlatch();
+    if (deferred) {
+      std::scoped_lock lock(merge_candidates_latch_);
+      merge_candidates_.insert(page->GetPageId());
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+    num_optimistic_ops_++;
+    return;
+  }
+
+  num_pessimistic_ops_++;
+  if (transaction != nullptr) {
+    RemovePessimistic(key, transaction);
+    return;
+  }
+  Transaction local_transaction(INVALID_TXN_ID);
+  RemovePessimistic(key, &local_transaction);
+}
+
+/*
+ * Remove by write-latch crabbing from the root, merging or redistributing pages as needed
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemovePessimistic(const KeyType &key, Transaction *transaction) {
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  PrevLink prev_link;
+  if (!IsEmpty()) {
+    Page *page = FindLeafPageExclusive(key, Operation::REMOVE, transaction);
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType existing;
+    if (leaf->Lookup(key, &existing, comparator_)) {
+      leaf->LockVersion();
+      leaf->RemoveAndDeleteRecord(key, comparator_);
+      CoalesceOrRedistribute(leaf, transaction, &prev_link);
+    }
+  }
+  ReleaseWritePages(transaction);
+  LinkPrevPage(prev_link);
+}
 
 /*
  * User needs to first find the sibling of input page. If sibling's size + input
@@ -127,8 +788,51 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) {
-  return false;
+bool BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction, PrevLink *prev_link) {
+  if (node->IsRootPage()) {
+    if (!AdjustRoot(node)) {
+      return false;
+    }
+    transaction->AddIntoDeletedPageSet(node->GetPageId());
+    return true;
+  }
+  if (node->GetSize() >= node->GetMinSize()) {
+    return false;
+  }
+
+  // the parent is unsafe for this remove, so it is still write-latched in the page set
+  Page *parent_page = FetchPage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  int index = parent->ValueIndex(node->GetPageId());
+  Page *neighbor_page = FetchPage(parent->ValueAt(index == 0 ? 1 : index - 1));
+  neighbor_page->WLatch();
+  auto *neighbor = reinterpret_cast<N *>(neighbor_page->GetData());
+  parent->LockVersion();
+  neighbor->LockVersion();
+
+  // leaves split as soon as they are full, internal pages only once they overflow
+  int max_size;
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    max_size = node->MaxSizeMergedWith(neighbor) - 1;
+  } else {
+    max_size = node->MaxSizeMergedWith(neighbor, parent->KeyAt(index == 0 ? 1 : index));
+  }
+  bool node_deleted = false;
+  if (neighbor->GetSize() + node->GetSize() <= max_size) {
+    Coalesce(&neighbor, &node, &parent, index, transaction, prev_link);
+    node_deleted = transaction->GetDeletedPageSet()->count(node->GetPageId()) > 0;
+  } else {
+    Redistribute(neighbor, node, index, transaction);
+  }
+
+  // a deleted page keeps its odd version, so that optimistic readers still holding it never accept it
+  if (transaction->GetDeletedPageSet()->count(neighbor_page->GetPageId()) == 0) {
+    reinterpret_cast<BPlusTreePage *>(neighbor_page->GetData())->UnlockVersion();
+  }
+  neighbor_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(neighbor_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  return node_deleted;
 }
 
 /*
@@ -147,8 +851,38 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
                               BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> **parent, int index,
-                              Transaction *transaction) {
-  return false;
+                              Transaction *transaction, PrevLink *prev_link) {
+  // always merge the right page into the left one, so that the leaf chain only needs the left page updated
+  N *left = *neighbor_node;
+  N *right = *node;
+  int right_index = index;
+  if (index == 0) {
+    std::swap(left, right);
+    right_index = 1;
+  }
+  MoveAll(right, left, (*parent)->KeyAt(right_index));
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    if (left->GetNextPageId() != INVALID_PAGE_ID) {
+      prev_link->page_ = FetchPage(left->GetPageId());
+      prev_link->merged_page_ = FetchPage(right->GetPageId());
+    }
+  }
+  transaction->AddIntoDeletedPageSet(right->GetPageId());
+  (*parent)->Remove(right_index);
+  return CoalesceOrRedistribute(*parent, transaction, prev_link);
+}
+
+/*
+ * Move all entries of node to the end of recipient, its left sibling
+ */
+INDEX_TEMPLATE_ARGUMENTS
+template <typename N>
+void BPLUSTREE_TYPE::MoveAll(N *node, N *recipient, const KeyType &middle_key) {
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    node->MoveAllTo(recipient);
+  } else {
+    node->MoveAllTo(recipient, middle_key, comparator_, buffer_pool_manager_);
+  }
 }
 
 /*
@@ -162,7 +896,57 @@ bool BPLUSTREE_TYPE::Coalesce(N **neighbor_node, N **node,
  */
 INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
-void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
+void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index, Transaction *transaction) {
+  Page *parent_page = FetchPage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+  N *left = node;
+  N *right = neighbor_node;
+  if (index == 0) {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      // a leaf left underflowing by deferred merges may be short of more than one entry
+      do {
+        neighbor_node->MoveFirstToEndOf(node);
+      } while (node->GetSize() < node->GetMinSize() && neighbor_node->GetSize() > neighbor_node->GetMinSize());
+    } else {
+      neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(1), comparator_, buffer_pool_manager_);
+    }
+  } else {
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      do {
+        neighbor_node->MoveLastToFrontOf(node);
+      } while (node->GetSize() < node->GetMinSize() && neighbor_node->GetSize() > neighbor_node->GetMinSize());
+    } else {
+      neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(index), comparator_, buffer_pool_manager_);
+    }
+    std::swap(left, right);
+  }
+  // leaves are separated by the shortest key between them, internal pages by the first key of the right one
+  if constexpr (std::is_same_v<N, LeafPage>) {
+    SetSeparator(parent, index == 0 ? 1 : index, SeparatorKey(left->KeyAt(left->GetSize() - 1), right->KeyAt(0)),
+                 transaction);
+  } else {
+    SetSeparator(parent, index == 0 ? 1 : index, right->KeyAt(0), transaction);
+  }
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetSeparator(InternalPage *parent, int index, const KeyType &key, Transaction *transaction) {
+  if (parent->HasRoomFor(key)) {
+    parent->SetKeyAt(index, key, comparator_);
+    return;
+  }
+  // the parent is not safe, so its own parent is still write-latched in the page set
+  InternalPage *new_parent = Split(parent);
+  if (index < parent->GetSize()) {
+    parent->SetKeyAt(index, key, comparator_);
+  } else {
+    // the first key of new_parent is the one pushed up, so at index == parent->GetSize() it is replaced as well
+    new_parent->SetKeyAt(index - parent->GetSize(), key, comparator_);
+  }
+  InsertIntoParent(parent, new_parent->KeyAt(0), new_parent, transaction);
+  buffer_pool_manager_->UnpinPage(new_parent->GetPageId(), true);
+}
 /*
  * Update root page if necessary
  * NOTE: size of root page can be less than min size and this method is only
@@ -174,7 +958,403 @@ void BPLUSTREE_TYPE::Redistribute(N *neighbor_node, N *node, int index) {}
  * happend
  */
 INDEX_TEMPLATE_ARGUMENTS
-bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
+bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) {
+  if (old_root_node->IsLeafPage()) {
+    if (old_root_node->GetSize() > 0) {
+      return false;
+    }
+    old_root_node->LockVersion();
+    SetRoot(INVALID_PAGE_ID);
+    return true;
+  }
+  if (old_root_node->GetSize() > 1) {
+    return false;
+  }
+  // the only child was just merged into, so it is still write-latched
+  old_root_node->LockVersion();
+  page_id_t child_page_id = reinterpret_cast<InternalPage *>(old_root_node)->RemoveAndReturnOnlyChild();
+  Page *child_page = FetchPage(child_page_id);
+  reinterpret_cast<BPlusTreePage *>(child_page->GetData())->SetParentPageId(INVALID_PAGE_ID);
+  buffer_pool_manager_->UnpinPage(child_page_id, true);
+  SetRoot(child_page_id);
+  return true;
+}
+
+/*****************************************************************************
+ * DEFERRED MERGES
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetDeferredMerges(bool deferred) {
+  merges_deferred_ = deferred;
+  if (!deferred) {
+    Rebalance();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+size_t BPLUSTREE_TYPE::Rebalance(Transaction *transaction) {
+  std::unordered_set<page_id_t> candidates;
+  {
+    std::scoped_lock lock(merge_candidates_latch_);
+    candidates.swap(merge_candidates_);
+  }
+  Transaction local_transaction(INVALID_TXN_ID);
+  if (transaction == nullptr) {
+    transaction = &local_transaction;
+  }
+  size_t num_rebalanced = 0;
+  for (page_id_t page_id : candidates) {
+    KeyType key;
+    if (!UnderflowingLeafKey(page_id, &key)) {
+      continue;
+    }
+    // a leaf far below its minimum size may take several merges to fill up again
+    while (RebalanceLeaf(key, transaction)) {
+      num_rebalanced++;
+    }
+  }
+  return num_rebalanced;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::UnderflowingLeafKey(page_id_t page_id, KeyType *key) {
+  // the page may have been deleted since, and even reused, which the descent from the root with its key sorts out
+  Page *page = FetchPage(page_id);
+  page->RLatch();
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  bool underflows = leaf->IsLeafPage() && (leaf->GetVersion() & 1) == 0 && !leaf->IsRootPage() &&
+                    leaf->GetSize() > 0 && leaf->GetSize() < leaf->GetMinSize();
+  if (underflows) {
+    *key = leaf->KeyAt(0);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  return underflows;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RebalanceLeaf(const KeyType &key, Transaction *transaction) {
+  std::vector<PathLevel> path;
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    if (!FindLeafFromPath(key, &path)) {
+      ReleasePath(&path);
+      num_restarts_++;
+      continue;
+    }
+    if (path.size() < 2) {
+      // a root leaf never underflows
+      ReleasePath(&path);
+      return false;
+    }
+    // the parent is latched before the leaf, as by writers crabbing down from the root
+    PathLevel &parent_level = path[path.size() - 2];
+    Page *parent_page = parent_level.page_;
+    Page *page = path.back().page_;
+    parent_page->WLatch();
+    page->WLatch();
+    auto *parent = reinterpret_cast<InternalPage *>(parent_page->GetData());
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    if (!parent->ValidateVersion(parent_level.version_) || !leaf->ValidateVersion(path.back().version_)) {
+      page->WUnlatch();
+      parent_page->WUnlatch();
+      ReleasePath(&path);
+      num_restarts_++;
+      continue;
+    }
+    bool underflows = leaf->GetSize() < leaf->GetMinSize();
+    if (!underflows || !IsSafe(parent, Operation::REMOVE, key)) {
+      page->WUnlatch();
+      parent_page->WUnlatch();
+      ReleasePath(&path);
+      return underflows && RebalanceLeafPessimistic(key, transaction);
+    }
+
+    // the parent keeps enough children and room for a new separator, so nothing above it changes
+    path.resize(path.size() - 2);
+    ReleasePath(&path);
+    transaction->AddIntoPageSet(parent_page);
+    transaction->AddIntoPageSet(page);
+    PrevLink prev_link;
+    leaf->LockVersion();
+    CoalesceOrRedistribute(leaf, transaction, &prev_link);
+    ReleaseWritePages(transaction);
+    LinkPrevPage(prev_link);
+    return true;
+  }
+  return RebalanceLeafPessimistic(key, transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::RebalanceLeafPessimistic(const KeyType &key, Transaction *transaction) {
+  num_pessimistic_ops_++;
+  root_latch_.WLock();
+  transaction->AddIntoPageSet(nullptr);
+  PrevLink prev_link;
+  bool rebalanced = false;
+  if (!IsEmpty()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(FindLeafPageExclusive(key, Operation::REMOVE, transaction)->GetData());
+    if (!leaf->IsRootPage() && leaf->GetSize() < leaf->GetMinSize()) {
+      leaf->LockVersion();
+      CoalesceOrRedistribute(leaf, transaction, &prev_link);
+      rebalanced = true;
+    }
+  }
+  ReleaseWritePages(transaction);
+  LinkPrevPage(prev_link);
+  return rebalanced;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StartBackgroundRebalance(std::chrono::milliseconds interval) {
+  StopBackgroundRebalance();
+  stop_rebalance_thread_ = false;
+  rebalance_thread_ = std::thread([this, interval] {
+    std::unique_lock lock(rebalance_thread_latch_);
+    while (!rebalance_thread_cv_.wait_for(lock, interval, [this] { return stop_rebalance_thread_; })) {
+      lock.unlock();
+      Rebalance();
+      lock.lock();
+    }
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::StopBackgroundRebalance() {
+  if (!rebalance_thread_.joinable()) {
+    return;
+  }
+  {
+    std::scoped_lock lock(rebalance_thread_latch_);
+    stop_rebalance_thread_ = true;
+  }
+  rebalance_thread_cv_.notify_all();
+  rebalance_thread_.join();
+}
+
+/*****************************************************************************
+ * WRITE BUFFER
+ *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetWriteBufferSize(size_t size) {
+  write_buffer_size_ = size;
+  if (size == 0) {
+    FlushWriteBuffer();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FlushWriteBuffer(Transaction *transaction) {
+  std::scoped_lock flush_lock(write_buffer_flush_latch_);
+  FlushWriteBufferLocked(transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FlushWriteBufferLocked(Transaction *transaction) {
+  {
+    std::scoped_lock lock(write_buffer_latch_);
+    if (write_buffer_.empty()) {
+      return;
+    }
+    flushing_writes_.swap(write_buffer_);
+  }
+  // the writes stay visible to lookups until they are all in the tree
+  ApplyWrites(flushing_writes_, transaction);
+  std::scoped_lock lock(write_buffer_latch_);
+  flushing_writes_.clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ApplyWrites(const std::map<KeyType, BufferedWrite, KeyLess> &writes, Transaction *transaction) {
+  // the path to the last leaf written to stays pinned, so the next leaf is usually reached from its parent
+  std::vector<PathLevel> path;
+  auto iterator = writes.begin();
+  while (iterator != writes.end()) {
+    Page *page = nullptr;
+    for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS && page == nullptr; attempt++) {
+      if (!FindLeafFromPath(iterator->first, &path)) {
+        ReleasePath(&path);
+        num_restarts_++;
+        continue;
+      }
+      if (path.empty()) {
+        // starting a new tree changes the root
+        break;
+      }
+      page = path.back().page_;
+      page->WLatch();
+      if (!reinterpret_cast<LeafPage *>(page->GetData())->ValidateVersion(path.back().version_)) {
+        page->WUnlatch();
+        ReleasePath(&path);
+        num_restarts_++;
+        page = nullptr;
+      }
+    }
+
+    size_t num_applied = 0;
+    if (page != nullptr) {
+      auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+      leaf->LockVersion();
+      while (iterator != writes.end() && Covers(path.back(), iterator->first) &&
+             ApplyWriteToLeaf(leaf, iterator->first, iterator->second)) {
+        ++iterator;
+        num_applied++;
+      }
+      leaf->UnlockVersion();
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), num_applied > 0);
+      path.pop_back();
+      num_optimistic_ops_ += num_applied > 0 ? 1 : 0;
+    }
+    if (num_applied == 0) {
+      // the write would split or underflow its leaf, so it latches from the root on its own
+      ReleasePath(&path);
+      const auto &[entry_key, write] = *iterator;
+      if (!write.insert_ || write.replaces_) {
+        RemoveEntry(entry_key, transaction);
+      }
+      if (write.insert_) {
+        InsertEntry(entry_key, write.value_, transaction);
+      }
+      ++iterator;
+    }
+  }
+  ReleasePath(&path);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::ApplyWriteToLeaf(LeafPage *leaf, const KeyType &key, const BufferedWrite &write) const {
+  ValueType existing;
+  bool present = leaf->Lookup(key, &existing, comparator_);
+  if (!write.insert_) {
+    if (!present) {
+      return true;
+    }
+    if (!IsSafe(leaf, Operation::REMOVE, key)) {
+      return false;
+    }
+    leaf->RemoveAndDeleteRecord(key, comparator_);
+    return true;
+  }
+  if (present) {
+    // an entry that is still there is kept, as InsertEntry would, unless the write replaces it in place
+    if (write.replaces_) {
+      leaf->RemoveAndDeleteRecord(key, comparator_);
+      leaf->Insert(key, write.value_, comparator_);
+    }
+    return true;
+  }
+  if (!IsSafe(leaf, Operation::INSERT, key)) {
+    return false;
+  }
+  leaf->Insert(key, write.value_, comparator_);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::InsertBuffered(const KeyType &entry_key, const ValueType &value, Transaction *transaction) {
+  {
+    std::scoped_lock lock(write_buffer_latch_);
+    auto iterator = write_buffer_.find(entry_key);
+    if (iterator != write_buffer_.end()) {
+      BufferedWrite &write = iterator->second;
+      if (write.insert_) {
+        return false;
+      }
+      write = BufferedWrite{true, value, true};
+      return true;
+    }
+    // a write being flushed decides as if it were in the tree already, as it will be before this one is flushed
+    auto flushing = flushing_writes_.find(entry_key);
+    if (flushing != flushing_writes_.end()) {
+      if (flushing->second.insert_) {
+        return false;
+      }
+    } else {
+      std::vector<ValueType> values;
+      if (GetEntry(entry_key, &values)) {
+        return false;
+      }
+    }
+    write_buffer_.emplace(entry_key, BufferedWrite{true, value, false});
+    if (write_buffer_.size() < write_buffer_size_) {
+      return true;
+    }
+  }
+  FlushFullWriteBuffer(transaction);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RemoveBuffered(const KeyType &entry_key, const ValueType &value, Transaction *transaction) {
+  {
+    std::scoped_lock lock(write_buffer_latch_);
+    auto iterator = write_buffer_.find(entry_key);
+    if (iterator != write_buffer_.end()) {
+      BufferedWrite &write = iterator->second;
+      if (write.insert_ && !write.replaces_) {
+        // the entry never made it to the tree, or will be removed from it by the flush running
+        write_buffer_.erase(iterator);
+      } else {
+        write = BufferedWrite{false, value, false};
+      }
+      return;
+    }
+    write_buffer_.emplace(entry_key, BufferedWrite{false, value, false});
+    if (write_buffer_.size() < write_buffer_size_) {
+      return;
+    }
+  }
+  FlushFullWriteBuffer(transaction);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::FlushFullWriteBuffer(Transaction *transaction) {
+  // a writer that fills the buffer while a flush is running leaves it to the next one, rather than wait
+  std::unique_lock flush_lock(write_buffer_flush_latch_, std::try_to_lock);
+  if (flush_lock.owns_lock()) {
+    FlushWriteBufferLocked(transaction);
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::GetValueBuffered(const KeyType &key, std::vector<ValueType> *result) {
+  // the writes being flushed come first, as the buffered writes come after them
+  std::vector<BufferedWrite> writes;
+  {
+    std::scoped_lock lock(write_buffer_latch_);
+    for (const auto *buffer : {&flushing_writes_, &write_buffer_}) {
+      auto begin = buffer->lower_bound(KeyOf(key));
+      auto end = buffer->upper_bound(unique_ ? key : LastEntryKey(key));
+      for (auto iterator = begin; iterator != end; ++iterator) {
+        writes.push_back(iterator->second);
+      }
+    }
+  }
+  if (unique_ && !writes.empty()) {
+    if (writes.back().insert_) {
+      result->push_back(writes.back().value_);
+    }
+    return writes.back().insert_;
+  }
+
+  // a write that was flushed since the buffer was read may show in the tree as well
+  std::vector<ValueType> values;
+  if (unique_) {
+    GetEntry(key, &values);
+  } else {
+    GetValues(key, &values);
+  }
+  for (const auto &write : writes) {
+    auto iterator = std::find(values.begin(), values.end(), write.value_);
+    if (write.insert_ && iterator == values.end()) {
+      values.push_back(write.value_);
+    } else if (!write.insert_ && iterator != values.end()) {
+      values.erase(iterator);
+    }
+  }
+  result->insert(result->end(), values.begin(), values.end());
+  return !values.empty();
+}
 
 /*****************************************************************************
  * INDEX ITERATOR
@@ -185,7 +1365,12 @@ bool BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) { return false; }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() {
+  FlushWriteBuffer();
+  std::vector<MappingType> items;
+  page_id_t page_id = ReadLeaf(nullptr, false, false, &items);
+  return INDEXITERATOR_TYPE(this, std::move(items), page_id);
+}
 
 /*
  * Input parameter is low key, find the leaf page that contains the input key
@@ -193,7 +1378,41 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin() { return INDEXITERATOR_TYPE(); }
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERATOR_TYPE(); }
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) {
+  FlushWriteBuffer();
+  std::vector<MappingType> items;
+  KeyType first_key = KeyOf(key);
+  page_id_t page_id = ReadLeaf(&first_key, false, false, &items);
+  return INDEXITERATOR_TYPE(this, std::move(items), page_id);
+}
+
+/*
+ * Find the right most leaf page first, then construct an index iterator that
+ * runs backwards
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin() {
+  FlushWriteBuffer();
+  std::vector<MappingType> items;
+  page_id_t page_id = ReadLeaf(nullptr, false, true, &items);
+  return INDEXITERATOR_TYPE(this, std::move(items), page_id, true);
+}
+
+/*
+ * Input parameter is high key, find the leaf page that contains the input key
+ * first, then construct an index iterator that runs backwards from the last
+ * key not greater than it
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE BPLUSTREE_TYPE::RBegin(const KeyType &key) {
+  FlushWriteBuffer();
+  std::vector<MappingType> items;
+  KeyType last_key = unique_ ? key : LastEntryKey(key);
+  page_id_t page_id = ReadLeaf(&last_key, false, true, &items);
+  return INDEXITERATOR_TYPE(this, std::move(items), page_id, true);
+}
 
 /*
  * Input parameter is void, construct an index iterator representing the end
@@ -203,43 +1422,691 @@ INDEXITERATOR_TYPE BPLUSTREE_TYPE::Begin(const KeyType &key) { return INDEXITERA
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_TYPE::End() { return INDEXITERATOR_TYPE(); }
 
+INDEX_TEMPLATE_ARGUMENTS
+page_id_t BPLUSTREE_TYPE::ReadLeaf(const KeyType *key, bool after, bool reverse, std::vector<MappingType> *items) {
+  page_id_t page_id;
+  for (int attempt = 0; attempt < MAX_OPTIMISTIC_ATTEMPTS; attempt++) {
+    if (ReadLeafOptimistic(key, after, reverse, items, &page_id)) {
+      return page_id;
+    }
+    num_restarts_++;
+  }
+  // the leaf keeps changing, so it is read under its latch, which holds writers off until it is copied
+  num_pessimistic_ops_++;
+  while (!ReadLeafLatched(key, after, reverse, items, &page_id)) {
+    num_restarts_++;
+  }
+  return page_id;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::ReadLeafOptimistic(const KeyType *key, bool after, bool reverse, std::vector<MappingType> *items,
+                                        page_id_t *page_id) {
+  items->clear();
+  Page *page;
+  uint32_t version;
+  LeafEdge edge = key != nullptr ? LeafEdge::NONE : (reverse ? LeafEdge::RIGHT_MOST : LeafEdge::LEFT_MOST);
+  if (!FindLeafOptimistic(key == nullptr ? KeyType{} : *key, edge, &page, &version)) {
+    return false;
+  }
+  if (page == nullptr) {
+    *page_id = INVALID_PAGE_ID;
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = ReadIndex(leaf, key, after, reverse);
+  while (true) {
+    CopyItems(leaf, index, reverse, items);
+    page_id_t next_page_id = reverse ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+    if (!leaf->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    if (!items->empty() || next_page_id == INVALID_PAGE_ID) {
+      *page_id = items->empty() ? INVALID_PAGE_ID : page->GetPageId();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return true;
+    }
+
+    // Nothing left in this leaf, so move on to the next one, which stays in place as long as this one does, as a page
+    // is only deleted by merging it into its left sibling. Backwards, a deleted leaf stays pinned until no leaf links
+    // back to it (see LinkPrevPage).
+    Page *next_page = FetchPage(next_page_id);
+    auto *next_leaf = reinterpret_cast<LeafPage *>(next_page->GetData());
+    uint32_t next_version = next_leaf->GetVersion();
+    bool valid = (next_version & 1) == 0;
+    if (reverse) {
+      // the previous page id may be out of date until the writer that changed the leaves links them back
+      valid = valid && next_leaf->IsLeafPage() && next_leaf->GetNextPageId() == page->GetPageId() &&
+              next_leaf->ValidateVersion(next_version);
+    }
+    valid = valid && leaf->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      return false;
+    }
+    page = next_page;
+    leaf = next_leaf;
+    version = next_version;
+    index = reverse ? leaf->GetSize() : 0;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::ReadLeafLatched(const KeyType *key, bool after, bool reverse, std::vector<MappingType> *items,
+                                     page_id_t *page_id) {
+  items->clear();
+  LeafEdge edge = key != nullptr ? LeafEdge::NONE : (reverse ? LeafEdge::RIGHT_MOST : LeafEdge::LEFT_MOST);
+  Page *page = FindLeafPageShared(key == nullptr ? KeyType{} : *key, edge);
+  if (page == nullptr) {
+    *page_id = INVALID_PAGE_ID;
+    return true;
+  }
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  int index = ReadIndex(leaf, key, after, reverse);
+  while (true) {
+    CopyItems(leaf, index, reverse, items);
+    page_id_t next_page_id = reverse ? leaf->GetPrevPageId() : leaf->GetNextPageId();
+    if (!items->empty() || next_page_id == INVALID_PAGE_ID) {
+      *page_id = items->empty() ? INVALID_PAGE_ID : page->GetPageId();
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return true;
+    }
+
+    // Latching the next leaf while holding this one could deadlock with a merge, so this one is released first. It
+    // stays pinned, and the next leaf still follows it as long as this one did not change in the meantime.
+    uint32_t version = leaf->GetVersion();
+    Page *next_page = FetchPage(next_page_id);
+    page->RUnlatch();
+    next_page->RLatch();
+    auto *next_leaf = reinterpret_cast<LeafPage *>(next_page->GetData());
+    // a read-latched page with an odd version was deleted
+    bool valid = (next_leaf->GetVersion() & 1) == 0;
+    if (reverse) {
+      valid = valid && next_leaf->IsLeafPage() && next_leaf->GetNextPageId() == page->GetPageId();
+    }
+    valid = valid && leaf->ValidateVersion(version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      next_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(next_page_id, false);
+      return false;
+    }
+    page = next_page;
+    leaf = next_leaf;
+    index = reverse ? leaf->GetSize() : 0;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int BPLUSTREE_TYPE::ReadIndex(LeafPage *leaf, const KeyType *key, bool after, bool reverse) const {
+  if (key == nullptr) {
+    return reverse ? leaf->GetSize() : 0;
+  }
+  int index = leaf->KeyIndex(*key, comparator_);
+  if (after != reverse && index < leaf->GetSize() && comparator_(leaf->KeyAt(index), *key) == 0) {
+    index++;
+  }
+  return index;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CopyItems(LeafPage *leaf, int index, bool reverse, std::vector<MappingType> *items) const {
+  if (reverse) {
+    for (int i = std::min(index, leaf->GetSize()) - 1; i >= 0; i--) {
+      items->push_back(leaf->GetItem(i));
+    }
+  } else {
+    for (int i = index; i < leaf->GetSize(); i++) {
+      items->push_back(leaf->GetItem(i));
+    }
+  }
+}
+
 /*****************************************************************************
  * UTILITIES AND DEBUG
  *****************************************************************************/
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreeConcurrencyStats BPLUSTREE_TYPE::GetConcurrencyStats() const {
+  BPlusTreeConcurrencyStats stats;
+  stats.num_optimistic_ops_ = num_optimistic_ops_;
+  stats.num_restarts_ = num_restarts_;
+  stats.num_pessimistic_ops_ = num_pessimistic_ops_;
+  return stats;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreeStats<KeyType> BPLUSTREE_TYPE::CollectStats(double sample_rate, size_t num_buckets) {
+  BPlusTreeStats<KeyType> stats;
+  std::vector<LeafSample> leaves;
+  Page *root_page = nullptr;
+  root_latch_.RLock();
+  if (!IsEmpty()) {
+    // every leaf is at the same depth, so the left most path tells the height
+    page_id_t page_id = root_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+      Page *page = FetchPage(page_id);
+      page->RLatch();
+      auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      page_id = node->IsLeafPage() ? INVALID_PAGE_ID : reinterpret_cast<InternalPage *>(node)->ValueAt(0);
+      page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      stats.height_++;
+    }
+    stats.levels_.resize(stats.height_);
+    stats.levels_[0].num_pages_ = 1;
+    root_page = FetchPage(root_page_id_);
+  }
+  root_latch_.RUnlock();
+  if (root_page == nullptr) {
+    return stats;
+  }
+  // the first leaf is always read
+  double sample_credit = 1;
+  CollectPageStats(root_page, 0, sample_rate, &sample_credit, &stats, &leaves);
+
+  for (auto &level : stats.levels_) {
+    if (level.num_pages_read_ > 0) {
+      level.avg_fill_ /= level.num_pages_read_;
+    }
+  }
+  // each leaf read stands in for the leaves skipped next to it
+  const auto &leaf_level = stats.levels_.back();
+  double leaves_per_sample =
+      leaf_level.num_pages_read_ > 0 ? static_cast<double>(leaf_level.num_pages_) / leaf_level.num_pages_read_ : 0;
+  stats.num_entries_ = static_cast<uint64_t>(leaf_level.num_entries_read_ * leaves_per_sample + 0.5);
+
+  size_t num_linked = 0;
+  size_t num_scattered = 0;
+  for (const auto &leaf : leaves) {
+    if (leaf.next_page_id_ != INVALID_PAGE_ID) {
+      num_linked++;
+      num_scattered += leaf.next_page_id_ != leaf.page_id_ + 1 ? 1 : 0;
+    }
+  }
+  stats.leaf_fragmentation_ = num_linked > 0 ? static_cast<double>(num_scattered) / num_linked : 0;
+
+  // closes a bucket once it holds its share of the entries, so buckets are no finer than a leaf
+  double bucket_size = static_cast<double>(stats.num_entries_) / std::max<size_t>(num_buckets, 1);
+  double bucket_entries = 0;
+  for (const auto &leaf : leaves) {
+    if (leaf.size_ == 0) {
+      continue;
+    }
+    if (stats.key_distribution_.empty() || bucket_entries >= bucket_size) {
+      stats.key_distribution_.emplace_back(KeyOf(leaf.first_key_), 0);
+      bucket_entries = 0;
+    }
+    bucket_entries += leaf.size_ * leaves_per_sample;
+    stats.key_distribution_.back().second = static_cast<uint64_t>(bucket_entries + 0.5);
+  }
+  return stats;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollectPageStats(Page *page, size_t depth, double sample_rate, double *sample_credit,
+                                      BPlusTreeStats<KeyType> *stats, std::vector<LeafSample> *leaves) {
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  std::vector<page_id_t> children;
+  page->RLatch();
+  uint32_t version = node->GetVersion();
+  // a page deleted since it was pinned keeps an odd version, and so does the rest of its subtree
+  if ((version & 1) == 0) {
+    CollectNodeStats(node, depth, sample_rate, sample_credit, stats, leaves, &children);
+  }
+  page->RUnlatch();
+
+  // The children are walked with no latch held on this page. A child may have been merged away and deleted by then,
+  // which is ruled out for as long as this page has not changed since it was read; once it has, the children left
+  // are skipped.
+  for (page_id_t child_page_id : children) {
+    Page *child_page = FetchPage(child_page_id);
+    if (!node->ValidateVersion(version)) {
+      buffer_pool_manager_->UnpinPage(child_page_id, false);
+      break;
+    }
+    CollectPageStats(child_page, depth + 1, sample_rate, sample_credit, stats, leaves);
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::CollectNodeStats(BPlusTreePage *node, size_t depth, double sample_rate, double *sample_credit,
+                                      BPlusTreeStats<KeyType> *stats, std::vector<LeafSample> *leaves,
+                                      std::vector<page_id_t> *children) {
+  auto &level = stats->levels_[depth];
+  double fill = static_cast<double>(node->GetSize()) / node->GetMaxSize();
+  level.min_fill_ = level.num_pages_read_ == 0 ? fill : std::min(level.min_fill_, fill);
+  level.avg_fill_ += fill;
+  level.num_pages_read_++;
+  level.num_entries_read_ += node->GetSize();
+  level.num_underflowing_ += !node->IsRootPage() && node->GetSize() < node->GetMinSize() ? 1 : 0;
+
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    LeafSample sample;
+    sample.first_key_ = leaf->GetSize() > 0 ? leaf->KeyAt(0) : KeyType{};
+    sample.size_ = leaf->GetSize();
+    sample.page_id_ = leaf->GetPageId();
+    sample.next_page_id_ = leaf->GetNextPageId();
+    leaves->push_back(sample);
+  } else if (depth + 1 < stats->levels_.size()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    stats->levels_[depth + 1].num_pages_ += internal->GetSize();
+    // the leaves are sampled as their parents are walked, without fetching the ones skipped
+    bool sampling = depth + 2 == stats->levels_.size() && sample_rate < 1;
+    for (int i = 0; i < internal->GetSize(); i++) {
+      if (sampling) {
+        *sample_credit += sample_rate;
+        if (*sample_credit < 1) {
+          continue;
+        }
+        *sample_credit -= 1;
+      }
+      children->push_back(internal->ValueAt(i));
+    }
+  }
+}
+
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
  */
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) {
-  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Implement this for test");
+  Page *page = FindLeafPageShared(key, leftMost ? LeafEdge::LEFT_MOST : LeafEdge::NONE);
+  if (page != nullptr) {
+    page->RUnlatch();
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FindLeafOptimistic(const KeyType &key, LeafEdge edge, Page **leaf_page, uint32_t *version) {
+  uint32_t root_version = root_version_;
+  if ((root_version & 1) != 0) {
+    return false;
+  }
+  page_id_t page_id = root_page_id_;
+  if (page_id == INVALID_PAGE_ID) {
+    *leaf_page = nullptr;
+    return root_version_ == root_version;
+  }
+  Page *page = FetchPage(page_id);
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  uint32_t node_version = node->GetVersion();
+  if ((node_version & 1) != 0 || root_version_ != root_version) {
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    return false;
+  }
+
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id;
+    if (edge == LeafEdge::NONE) {
+      child_page_id = internal->Lookup(key, comparator_);
+    } else {
+      child_page_id = internal->ValueAt(edge == LeafEdge::LEFT_MOST ? 0 : internal->GetSize() - 1);
+    }
+    // the child page id may be torn by a concurrent writer, so check before fetching it
+    if (!node->ValidateVersion(node_version)) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      return false;
+    }
+    Page *child_page = FetchPage(child_page_id);
+    auto *child = reinterpret_cast<BPlusTreePage *>(child_page->GetData());
+    uint32_t child_version = child->GetVersion();
+    // the child was not deleted before it was pinned as long as its parent did not change
+    bool valid = (child_version & 1) == 0 && node->ValidateVersion(node_version);
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (!valid) {
+      buffer_pool_manager_->UnpinPage(child_page_id, false);
+      return false;
+    }
+    page = child_page;
+    node = child;
+    node_version = child_version;
+  }
+  *leaf_page = page;
+  *version = node_version;
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::FindLeafFromPath(const KeyType &key, std::vector<PathLevel> *path) {
+  while (!path->empty() && !Covers(path->back(), key)) {
+    buffer_pool_manager_->UnpinPage(path->back().page_->GetPageId(), false);
+    path->pop_back();
+  }
+
+  if (path->empty()) {
+    uint32_t root_version = root_version_;
+    if ((root_version & 1) != 0) {
+      return false;
+    }
+    page_id_t page_id = root_page_id_;
+    if (page_id == INVALID_PAGE_ID) {
+      return root_version_ == root_version;
+    }
+    PathLevel root;
+    root.page_ = FetchPage(page_id);
+    root.version_ = reinterpret_cast<BPlusTreePage *>(root.page_->GetData())->GetVersion();
+    path->push_back(root);
+    if ((root.version_ & 1) != 0 || root_version_ != root_version) {
+      return false;
+    }
+  }
+
+  auto *node = reinterpret_cast<BPlusTreePage *>(path->back().page_->GetData());
+  if (!node->ValidateVersion(path->back().version_)) {
+    return false;
+  }
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    PathLevel child = path->back();
+    int index = internal->LookupIndex(key, comparator_);
+    if (index > 0) {
+      child.low_ = internal->KeyAt(index);
+      child.has_low_ = true;
+    }
+    if (index + 1 < internal->GetSize()) {
+      child.high_ = internal->KeyAt(index + 1);
+      child.has_high_ = true;
+    }
+    page_id_t child_page_id = internal->ValueAt(index);
+    // the child page id and the keys may be torn by a concurrent writer, so check before using them
+    if (!node->ValidateVersion(path->back().version_)) {
+      return false;
+    }
+    child.page_ = FetchPage(child_page_id);
+    auto *child_node = reinterpret_cast<BPlusTreePage *>(child.page_->GetData());
+    child.version_ = child_node->GetVersion();
+    path->push_back(child);
+    // the child was not deleted before it was pinned as long as its parent did not change
+    if ((child.version_ & 1) != 0 || !node->ValidateVersion((*path)[path->size() - 2].version_)) {
+      return false;
+    }
+    node = child_node;
+  }
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Covers(const PathLevel &level, const KeyType &key) const {
+  return (!level.has_low_ || comparator_(key, level.low_) >= 0) &&
+         (!level.has_high_ || comparator_(key, level.high_) < 0);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleasePath(std::vector<PathLevel> *path) {
+  for (const auto &level : *path) {
+    buffer_pool_manager_->UnpinPage(level.page_->GetPageId(), false);
+  }
+  path->clear();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageShared(const KeyType &key, LeafEdge edge) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  Page *page = FetchPage(root_page_id_);
+  page->RLatch();
+  root_latch_.RUnlock();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page_id_t child_page_id;
+    if (edge == LeafEdge::NONE) {
+      child_page_id = internal->Lookup(key, comparator_);
+    } else {
+      child_page_id = internal->ValueAt(edge == LeafEdge::LEFT_MOST ? 0 : internal->GetSize() - 1);
+    }
+    Page *child_page = FetchPage(child_page_id);
+    child_page->RLatch();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    page = child_page;
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FindLeafPageExclusive(const KeyType &key, Operation operation, Transaction *transaction) {
+  Page *page = FetchPage(root_page_id_);
+  page->WLatch();
+  auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  if (IsSafe(node, operation, key)) {
+    ReleaseWritePages(transaction);
+  }
+  transaction->AddIntoPageSet(page);
+  while (!node->IsLeafPage()) {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    page = FetchPage(internal->Lookup(key, comparator_));
+    page->WLatch();
+    node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    if (IsSafe(node, operation, key)) {
+      ReleaseWritePages(transaction);
+    }
+    transaction->AddIntoPageSet(page);
+  }
+  return page;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::IsSafe(BPlusTreePage *node, Operation operation, const KeyType &key) const {
+  // an internal page below this size has room for one more child under any key, however few bytes the keys share
+  int internal_max_size = InternalPage::MaxSize(internal_max_size_, 0);
+  if (operation == Operation::INSERT) {
+    return node->IsLeafPage() ? node->GetSize() + 1 < reinterpret_cast<LeafPage *>(node)->MaxSizeWith(key)
+                              : node->GetSize() < internal_max_size;
+  }
+  if (!node->IsLeafPage() && internal_max_size < internal_max_size_ && node->GetSize() >= internal_max_size) {
+    // a page that only fits thanks to compression may have to split when one of its keys is replaced
+    return false;
+  }
+  if (node->IsRootPage()) {
+    // a root leaf is only deleted once empty, a root internal page once it has a single child
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+  }
+  return node->GetSize() > node->GetMinSize();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::ReleaseWritePages(Transaction *transaction) {
+  auto page_set = transaction->GetPageSet();
+  auto deleted_page_set = transaction->GetDeletedPageSet();
+  for (Page *page : *page_set) {
+    if (page == nullptr) {
+      root_latch_.WUnlock();
+      continue;
+    }
+    auto *node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+    bool deleted = deleted_page_set->count(page->GetPageId()) > 0;
+    bool modified = (node->GetVersion() & 1) != 0;
+    if (!deleted) {
+      node->UnlockVersion();
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), modified && !deleted);
+  }
+  page_set->clear();
+  if (deleted_page_set->empty()) {
+    return;
+  }
+  std::vector<page_id_t> page_ids(deleted_page_set->begin(), deleted_page_set->end());
+  deleted_page_set->clear();
+  DeletePages(page_ids);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::DeletePages(const std::vector<page_id_t> &page_ids) {
+  std::scoped_lock lock(pending_deletes_latch_);
+  pending_deletes_.insert(pending_deletes_.end(), page_ids.begin(), page_ids.end());
+  if (pending_deletes_.empty()) {
+    return;
+  }
+  // an optimistic reader may still have a page pinned, then it is retried after a later operation
+  std::scoped_lock candidates_lock(merge_candidates_latch_);
+  auto it = std::remove_if(pending_deletes_.begin(), pending_deletes_.end(), [this](page_id_t page_id) {
+    if (!buffer_pool_manager_->DeletePage(page_id)) {
+      return false;
+    }
+    merge_candidates_.erase(page_id);
+    return true;
+  });
+  pending_deletes_.erase(it, pending_deletes_.end());
 }
 
 /*
- * Update/Insert root page id in header page(where page_id = 0, header_page is
- * defined under include/page/header_page.h)
- * Call this method everytime root page id is changed.
- * @parameter: insert_record      defualt value is false. When set to true,
- * insert a record <index_name, root_page_id> into header page instead of
- * updating it.
+ * A writer cannot latch the right sibling of a leaf it splits or merges into: holding one leaf while waiting for
+ * another could deadlock with a writer that coalesces upwards. Instead it links the sibling back once it has released
+ * all its latches, and only if the sibling still follows the leaf then; otherwise whoever changed that links it.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::UpdateRootPageId(int insert_record) {
-  HeaderPage *header_page = static_cast<HeaderPage *>(buffer_pool_manager_->FetchPage(HEADER_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_name + root_page_id> in header_page
-    header_page->InsertRecord(index_name_, root_page_id_);
-  } else {
-    // update root_page_id in header_page
-    header_page->UpdateRecord(index_name_, root_page_id_);
+void BPLUSTREE_TYPE::LinkPrevPage(const PrevLink &prev_link) {
+  if (prev_link.page_ == nullptr) {
+    return;
   }
-  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+  Page *page = prev_link.page_;
+  auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+  while (true) {
+    uint32_t version = leaf->GetVersion();
+    if ((version & 1) != 0) {
+      // the leaf is being modified, or was deleted, which keeps its version odd for good
+      page->RLatch();
+      bool deleted = (leaf->GetVersion() & 1) != 0;
+      page->RUnlatch();
+      if (deleted) {
+        break;
+      }
+      continue;
+    }
+    page_id_t next_page_id = leaf->GetNextPageId();
+    if (!leaf->ValidateVersion(version)) {
+      continue;
+    }
+    if (next_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    Page *next_page = FetchPage(next_page_id);
+    next_page->WLatch();
+    // the sibling cannot be merged into the leaf while it is latched, so it still follows the leaf if the leaf did
+    // not change
+    bool linked = leaf->ValidateVersion(version);
+    if (linked) {
+      auto *next_leaf = reinterpret_cast<LeafPage *>(next_page->GetData());
+      next_leaf->LockVersion();
+      next_leaf->SetPrevPageId(page->GetPageId());
+      next_leaf->UnlockVersion();
+    }
+    next_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(next_page_id, linked);
+    if (linked) {
+      break;
+    }
+  }
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (prev_link.merged_page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(prev_link.merged_page_->GetPageId(), false);
+  }
+  // the merged leaf, and the leaf itself if it was deleted meanwhile, could not be deleted while pinned
+  DeletePages({});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+Page *BPLUSTREE_TYPE::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a b+ tree page");
+  }
+  return page;
 }
 
 /*
- * This method is used for test only
- * Read data from file and insert one by one
+ * Change the root page id. Callers hold the root latch exclusively.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::SetRoot(page_id_t root_page_id) {
+  root_version_++;
+  root_page_id_ = root_page_id;
+  root_version_++;
+  UpdateRootPageId();
+}
+
+/*
+ * Update root page id in the meta page of the tree (see
+ * include/storage/page/b_plus_tree_meta_page.h), which is created along with
+ * the first root, and recorded as <index_name, meta_page_id> in the header
+ * page (where page_id = 0, header_page is defined under
+ * include/page/header_page.h).
+ * Call this method everytime root page id is changed, with the root latch held.
  */
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::UpdateRootPageId() {
+  if (meta_page_id_ != INVALID_PAGE_ID) {
+    Page *page = FetchPage(meta_page_id_);
+    page->WLatch();
+    reinterpret_cast<BPlusTreeMetaPage *>(page->GetData())->SetRootPageId(root_page_id_);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(meta_page_id_, true);
+    return;
+  }
+
+  page_id_t meta_page_id;
+  Page *page = buffer_pool_manager_->NewPage(&meta_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a meta page");
+  }
+  auto *meta_page = reinterpret_cast<BPlusTreeMetaPage *>(page->GetData());
+  meta_page->Init(meta_page_id);
+  meta_page->SetRootPageId(root_page_id_);
+  buffer_pool_manager_->UnpinPage(meta_page_id, true);
+  meta_page_id_ = meta_page_id;
+
+  auto *header_page = static_cast<HeaderPage *>(FetchPage(HEADER_PAGE_ID));
+  // other indexes share the header page
+  header_page->WLatch();
+  // an index that was created again under the same name takes over its record
+  if (!header_page->InsertRecord(index_name_, meta_page_id)) {
+    header_page->UpdateRecord(index_name_, meta_page_id);
+  }
+  header_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, true);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_TYPE::Open() {
+  auto *header_page = static_cast<HeaderPage *>(FetchPage(HEADER_PAGE_ID));
+  header_page->RLatch();
+  page_id_t meta_page_id;
+  bool found = header_page->GetRootId(index_name_, &meta_page_id);
+  header_page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(HEADER_PAGE_ID, false);
+  if (!found) {
+    return false;
+  }
+
+  Page *page = FetchPage(meta_page_id);
+  page->RLatch();
+  page_id_t root_page_id = reinterpret_cast<BPlusTreeMetaPage *>(page->GetData())->GetRootPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(meta_page_id, false);
+
+  root_latch_.WLock();
+  meta_page_id_ = meta_page_id;
+  root_version_++;
+  root_page_id_ = root_page_id;
+  root_version_++;
+  root_latch_.WUnlock();
+  return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertFromFile(const std::string &file_name, Transaction *transaction) {
   int64_t key;
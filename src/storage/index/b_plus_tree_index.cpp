@@ -9,6 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
+#include "common/exception.h"
 #include "storage/index/b_plus_tree_index.h"
 
 namespace bustub {
@@ -19,35 +22,140 @@ INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_INDEX_TYPE::BPlusTreeIndex(std::unique_ptr<IndexMetadata> &&metadata, BufferPoolManager *buffer_pool_manager)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, LEAF_PAGE_SIZE, INTERNAL_PAGE_SIZE,
+                 GetMetadata()->IsUnique()) {
+  // a non-unique tree stores the RID of each entry over the last bytes of its key, which the key must leave free
+  if (!GetMetadata()->IsUnique() && !StoresFullKeys()) {
+    throw Exception(ExceptionType::INVALID, "the keys of a non-unique B+ tree index do not fit next to a RID");
+  }
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
-  container_.Insert(index_key, rid, transaction);
+  InsertWithBloomFilter([this, &index_key] { return BloomFilterHash(index_key); },
+                        [&] { container_.Insert(index_key, rid, transaction); });
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
-  container_.Remove(index_key, transaction);
+  container_.Remove(index_key, rid, transaction);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
+  auto bloom_filter = LoadBloomFilter();
+  if (bloom_filter != nullptr && !bloom_filter->MayContain(BloomFilterHash(index_key))) {
+    return;
+  }
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                                     const std::function<bool(RID)> &callback, Transaction *transaction) {
+  ScanEntries(low, low_inclusive, high, high_inclusive,
+              [&callback](const KeyType &key, const ValueType &rid) { return callback(rid); });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRangeKeys(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                                         const std::function<bool(const Tuple &, RID)> &callback,
+                                         Transaction *transaction) {
+  Schema *key_schema = GetKeySchema();
+  std::vector<Value> values(key_schema->GetColumnCount());
+  ScanEntries(low, low_inclusive, high, high_inclusive, [&](const KeyType &key, const ValueType &rid) {
+    KeyType index_key = container_.KeyOf(key);
+    for (uint32_t column_idx = 0; column_idx < values.size(); column_idx++) {
+      values[column_idx] = index_key.ToValue(key_schema, column_idx);
+    }
+    return callback(Tuple(values, key_schema), rid);
+  });
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::StoresFullKeys() const {
+  return KeyFits(GetKeySchema(), GetMetadata()->IsUnique());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::KeyFits(const Schema *key_schema, bool is_unique) {
+  uint32_t room = sizeof(KeyType) - (is_unique ? 0 : sizeof(ValueType));
+  return KeyEncoder::MaxLength(key_schema) <= room;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+template <typename Callback>
+void BPLUSTREE_INDEX_TYPE::ScanEntries(const Tuple *low, bool low_inclusive, const Tuple *high, bool high_inclusive,
+                                       const Callback &callback) {
+  KeyType low_key;
+  KeyType high_key;
+  if (low != nullptr) {
+    low_key.SetFromKey(*low, GetKeySchema());
+    low_key = container_.KeyOf(low_key);
+  }
+  if (high != nullptr) {
+    high_key.SetFromKey(*high, GetKeySchema());
+    high_key = container_.KeyOf(high_key);
+  }
+
+  // start at the first key not less than low, and stop at the first key past high
+  auto iterator = low != nullptr ? container_.Begin(low_key) : container_.Begin();
+  for (; iterator != container_.End(); ++iterator) {
+    KeyType key = container_.KeyOf((*iterator).first);
+    if (low != nullptr && !low_inclusive && comparator_(key, low_key) == 0) {
+      continue;
+    }
+    if (high != nullptr) {
+      int cmp = comparator_(key, high_key);
+      if (cmp > 0 || (cmp == 0 && !high_inclusive)) {
+        return;
+      }
+    }
+    if (!callback((*iterator).first, (*iterator).second)) {
+      return;
+    }
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+bool BPLUSTREE_INDEX_TYPE::BulkLoad(const std::function<bool(MappingType *)> &next, double fill_factor,
+                                    size_t run_size) {
+  auto bloom_filter = LoadBloomFilter();
+  if (bloom_filter == nullptr) {
+    return container_.BulkLoadUnsorted(next, fill_factor, run_size);
+  }
+  return container_.BulkLoadUnsorted(
+      [this, &next, &bloom_filter](MappingType *entry) {
+        if (!next(entry)) {
+          return false;
+        }
+        bloom_filter->Insert(BloomFilterHash(entry->first));
+        return true;
+      },
+      fill_factor, run_size);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::RebuildBloomFilter(size_t bits_per_key) {
+  RebuildBloomFilterFrom(bits_per_key, [this](const auto &add) {
+    for (auto iterator = container_.Begin(); iterator != container_.End(); ++iterator) {
+      add(BloomFilterHash((*iterator).first));
+    }
+  });
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 INDEXITERATOR_TYPE BPLUSTREE_INDEX_TYPE::GetBeginIterator() { return container_.Begin(); }
 
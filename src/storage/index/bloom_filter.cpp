@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.cpp
+//
+// Identification: src/storage/index/bloom_filter.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "storage/index/bloom_filter.h"
+
+namespace bustub {
+
+namespace {
+
+// odd multipliers that spread the lower half of a hash over the words of a block, as in Parquet's split block filter
+constexpr uint32_t SALTS[] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                              0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+}  // namespace
+
+BloomFilter::BloomFilter(size_t num_keys, size_t bits_per_key)
+    : blocks_(std::max<size_t>(1, (num_keys * bits_per_key + 8 * sizeof(Block) - 1) / (8 * sizeof(Block)))) {}
+
+void BloomFilter::Insert(hash_t hash) {
+  uint64_t mask[WORDS_PER_BLOCK];
+  MaskOf(hash, mask);
+  Block &block = blocks_[BlockOf(hash)];
+  for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+    // concurrent inserts into the same word must not lose each other's bits
+    block.words_[i].fetch_or(mask[i], std::memory_order_relaxed);
+  }
+}
+
+bool BloomFilter::MayContain(hash_t hash) const {
+  alignas(16) uint64_t mask[WORDS_PER_BLOCK];
+  MaskOf(hash, mask);
+  // a probe racing an insert may see any of its bits, so the words need no ordering
+  const Block &block = blocks_[BlockOf(hash)];
+  alignas(16) uint64_t words[WORDS_PER_BLOCK];
+  for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+    words[i] = block.words_[i].load(std::memory_order_relaxed);
+  }
+#ifdef __SSE2__
+  // collect the bits of the mask missing from the block, two words at a time
+  __m128i missing = _mm_setzero_si128();
+  for (size_t i = 0; i < WORDS_PER_BLOCK; i += 2) {
+    __m128i block_words = _mm_load_si128(reinterpret_cast<const __m128i *>(&words[i]));
+    __m128i bits = _mm_load_si128(reinterpret_cast<const __m128i *>(&mask[i]));
+    missing = _mm_or_si128(missing, _mm_andnot_si128(block_words, bits));
+  }
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) == 0xFFFF;
+#else
+  uint64_t missing = 0;
+  for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+    missing |= mask[i] & ~words[i];
+  }
+  return missing == 0;
+#endif
+}
+
+size_t BloomFilter::BlockOf(hash_t hash) const {
+  // maps the upper half onto the blocks without a division
+  return ((hash >> 32) * blocks_.size()) >> 32;
+}
+
+void BloomFilter::MaskOf(hash_t hash, uint64_t *mask) {
+  auto key = static_cast<uint32_t>(hash);
+  for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+    mask[i] = uint64_t{1} << ((key * SALTS[i]) >> 26);
+  }
+}
+
+}  // namespace bustub
@@ -9,25 +9,27 @@ namespace bustub {
 template <typename KeyType, typename ValueType, typename KeyComparator>
 HASH_TABLE_INDEX_TYPE::ExtendibleHashTableIndex(std::unique_ptr<IndexMetadata> &&metadata,
                                                 BufferPoolManager *buffer_pool_manager,
-                                                const HashFunction<KeyType> &hash_fn)
+                                                const HashFunction<KeyType> &hash_fn,
+                                                const ExtendibleHashTableOptions &options)
     : Index(std::move(metadata)),
       comparator_(GetMetadata()->GetKeySchema()),
-      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn) {}
+      container_(GetMetadata()->GetName(), buffer_pool_manager, comparator_, hash_fn, options) {}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
-  container_.Insert(transaction, index_key, rid);
+  InsertWithBloomFilter([&index_key] { return BloomFilterHash(index_key); },
+                        [&] { container_.Insert(transaction, index_key, rid); });
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
   container_.Remove(transaction, index_key, rid);
 }
@@ -36,14 +38,51 @@ template <typename KeyType, typename ValueType, typename KeyComparator>
 void HASH_TABLE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetKeySchema());
 
+  auto bloom_filter = LoadBloomFilter();
+  if (bloom_filter != nullptr && !bloom_filter->MayContain(BloomFilterHash(index_key))) {
+    return;
+  }
   container_.GetValue(transaction, index_key, result);
 }
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_INDEX_TYPE::RebuildBloomFilter(size_t bits_per_key) {
+  RebuildBloomFilterFrom(bits_per_key, [this](const auto &add) {
+    for (auto iterator = container_.Begin(); !iterator.IsEnd(); ++iterator) {
+      add(BloomFilterHash((*iterator).first));
+    }
+  });
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> HASH_TABLE_INDEX_TYPE::GetBeginIterator() {
+  return container_.Begin();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> HASH_TABLE_INDEX_TYPE::GetBeginIterator(
+    uint32_t partition, uint32_t num_partitions) {
+  return container_.Begin(partition, num_partitions);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExtendibleHashTableIterator<KeyType, ValueType, KeyComparator> HASH_TABLE_INDEX_TYPE::GetBeginIterator(
+    const Tuple &low, const Tuple &high) {
+  KeyType low_key;
+  low_key.SetFromKey(low, GetKeySchema());
+  KeyType high_key;
+  high_key.SetFromKey(high, GetKeySchema());
+  return container_.Begin(low_key, high_key);
+}
+
 template class ExtendibleHashTableIndex<GenericKey<4>, RID, GenericComparator<4>>;
 template class ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>;
 template class ExtendibleHashTableIndex<GenericKey<16>, RID, GenericComparator<16>>;
 template class ExtendibleHashTableIndex<GenericKey<32>, RID, GenericComparator<32>>;
 template class ExtendibleHashTableIndex<GenericKey<64>, RID, GenericComparator<64>>;
 
+template class ExtendibleHashTableIndex<VarlenKey, RID, VarlenComparator>;
+
 }  // namespace bustub
@@ -0,0 +1,207 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort.cpp
+//
+// Identification: src/storage/index/external_sort.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <queue>
+
+#include "common/exception.h"
+#include "common/rid.h"
+#include "storage/index/external_sort.h"
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExternalSort<KeyType, ValueType, KeyComparator>::ExternalSort(BufferPoolManager *buffer_pool_manager,
+                                                              const KeyComparator &comparator, size_t run_size)
+    : buffer_pool_manager_(buffer_pool_manager),
+      comparator_(comparator),
+      run_size_(std::max<size_t>(run_size, 1)),
+      fan_in_(std::max<size_t>(buffer_pool_manager->GetPoolSize() / 4, 2)) {}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+ExternalSort<KeyType, ValueType, KeyComparator>::~ExternalSort() {
+  for (const auto &run : runs_) {
+    DeleteRun(run);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ExternalSort<KeyType, ValueType, KeyComparator>::Add(const KeyType &key, const ValueType &value) {
+  BUSTUB_ASSERT(!sorted_, "entries cannot be added to a sort that was scanned");
+  if (entries_.size() == run_size_) {
+    WriteRun();
+  }
+  entries_.emplace_back(key, value);
+  size_++;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ExternalSort<KeyType, ValueType, KeyComparator>::Scan(const std::function<void(const Entry &)> &callback) {
+  if (!sorted_) {
+    if (runs_.empty()) {
+      std::stable_sort(entries_.begin(), entries_.end(),
+                       [this](const Entry &lhs, const Entry &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+    } else {
+      if (!entries_.empty()) {
+        WriteRun();
+      }
+      // merge groups of neighbouring runs, so that ties still go to the entry added first
+      while (runs_.size() > fan_in_) {
+        std::vector<Run> merged_runs;
+        for (size_t first = 0; first < runs_.size(); first += fan_in_) {
+          std::vector<Run> group(runs_.begin() + first, runs_.begin() + std::min(first + fan_in_, runs_.size()));
+          if (group.size() == 1) {
+            merged_runs.push_back(group[0]);
+            continue;
+          }
+          RunWriter writer;
+          Merge(group, true, [this, &writer](const Entry &entry) { Append(&writer, entry); });
+          merged_runs.push_back(Finish(&writer));
+        }
+        runs_ = std::move(merged_runs);
+      }
+    }
+    sorted_ = true;
+  }
+
+  if (runs_.empty()) {
+    for (const auto &entry : entries_) {
+      callback(entry);
+    }
+  } else {
+    Merge(runs_, false, callback);
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ExternalSort<KeyType, ValueType, KeyComparator>::WriteRun() {
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [this](const Entry &lhs, const Entry &rhs) { return comparator_(lhs.first, rhs.first) < 0; });
+  RunWriter writer;
+  for (const auto &entry : entries_) {
+    Append(&writer, entry);
+  }
+  runs_.push_back(Finish(&writer));
+  entries_.clear();
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ExternalSort<KeyType, ValueType, KeyComparator>::Merge(const std::vector<Run> &runs, bool consume,
+                                                             const std::function<void(const Entry &)> &emit) {
+  // the cursor with the smallest entry on top
+  auto greater = [this](const RunCursor &lhs, const RunCursor &rhs) {
+    int cmp = comparator_(PageEntries(lhs.page_)[lhs.index_].first, PageEntries(rhs.page_)[rhs.index_].first);
+    return cmp != 0 ? cmp > 0 : lhs.run_ > rhs.run_;
+  };
+  std::priority_queue<RunCursor, std::vector<RunCursor>, decltype(greater)> cursors(greater);
+  for (size_t i = 0; i < runs.size(); i++) {
+    RunCursor cursor;
+    cursor.page_ = FetchPage(runs[i].first_page_id_);
+    cursor.run_ = i;
+    cursors.push(cursor);
+  }
+  while (!cursors.empty()) {
+    RunCursor cursor = cursors.top();
+    cursors.pop();
+    emit(PageEntries(cursor.page_)[cursor.index_]);
+    if (Advance(&cursor, consume)) {
+      cursors.push(cursor);
+    }
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool ExternalSort<KeyType, ValueType, KeyComparator>::Advance(RunCursor *cursor, bool consume) {
+  if (++cursor->index_ < PageSize(cursor->page_)) {
+    return true;
+  }
+  page_id_t page_id = cursor->page_->GetPageId();
+  page_id_t next_page_id = NextPageId(cursor->page_);
+  buffer_pool_manager_->UnpinPage(page_id, false);
+  if (consume) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  if (next_page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  cursor->page_ = FetchPage(next_page_id);
+  cursor->index_ = 0;
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ExternalSort<KeyType, ValueType, KeyComparator>::Append(RunWriter *writer, const Entry &entry) {
+  if (writer->page_ == nullptr || PageSize(writer->page_) == ENTRIES_PER_PAGE) {
+    page_id_t page_id;
+    Page *page = NewPage(&page_id);
+    NextPageId(page) = INVALID_PAGE_ID;
+    PageSize(page) = 0;
+    if (writer->page_ == nullptr) {
+      writer->run_.first_page_id_ = page_id;
+    } else {
+      NextPageId(writer->page_) = page_id;
+      buffer_pool_manager_->UnpinPage(writer->page_->GetPageId(), true);
+    }
+    writer->page_ = page;
+  }
+  PageEntries(writer->page_)[PageSize(writer->page_)++] = entry;
+  writer->run_.size_++;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+typename ExternalSort<KeyType, ValueType, KeyComparator>::Run ExternalSort<KeyType, ValueType, KeyComparator>::Finish(
+    RunWriter *writer) {
+  if (writer->page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(writer->page_->GetPageId(), true);
+    writer->page_ = nullptr;
+  }
+  return writer->run_;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void ExternalSort<KeyType, ValueType, KeyComparator>::DeleteRun(const Run &run) {
+  page_id_t page_id = run.first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = FetchPage(page_id);
+    page_id_t next_page_id = NextPageId(page);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *ExternalSort<KeyType, ValueType, KeyComparator>::NewPage(page_id_t *page_id) {
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot allocate a page to sort into");
+  }
+  return page;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+Page *ExternalSort<KeyType, ValueType, KeyComparator>::FetchPage(page_id_t page_id) {
+  Page *page = buffer_pool_manager_->FetchPage(page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a page of a sorted run");
+  }
+  return page;
+}
+
+template class ExternalSort<GenericKey<4>, RID, GenericComparator<4>>;
+template class ExternalSort<GenericKey<8>, RID, GenericComparator<8>>;
+template class ExternalSort<GenericKey<16>, RID, GenericComparator<16>>;
+template class ExternalSort<GenericKey<32>, RID, GenericComparator<32>>;
+template class ExternalSort<GenericKey<64>, RID, GenericComparator<64>>;
+
+}  // namespace bustub
@@ -0,0 +1,217 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_encoder.cpp
+//
+// Identification: src/storage/index/key_encoder.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "common/exception.h"
+#include "storage/index/key_encoder.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+// the number of bytes a value of a fixed-length type takes encoded, 0 for other types
+uint32_t FixedWidth(TypeId type) {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return 1;
+    case TypeId::SMALLINT:
+      return 2;
+    case TypeId::INTEGER:
+      return 4;
+    case TypeId::BIGINT:
+    case TypeId::DECIMAL:
+    case TypeId::TIMESTAMP:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+uint64_t SignBit(uint32_t width) { return uint64_t{1} << (8 * width - 1); }
+
+// writes the low width bytes of bits in big-endian byte order, as far as they fit
+void PutBigEndian(uint64_t bits, uint32_t width, char *out, uint32_t size) {
+  for (uint32_t i = 0; i < width && i < size; i++) {
+    out[i] = static_cast<char>(bits >> (8 * (width - 1 - i)));
+  }
+}
+
+// reads width bytes in big-endian byte order, the ones past size as zeros
+uint64_t GetBigEndian(const char *data, uint32_t width, uint32_t size) {
+  uint64_t bits = 0;
+  for (uint32_t i = 0; i < width; i++) {
+    bits = (bits << 8) | (i < size ? static_cast<uint8_t>(data[i]) : 0);
+  }
+  return bits;
+}
+
+}  // namespace
+
+void KeyEncoder::Encode(const Tuple &key, const Schema *key_schema, char *out, uint32_t size) {
+  memset(out, 0, size);
+  uint32_t offset = 0;
+  for (uint32_t column_idx = 0; column_idx < key_schema->GetColumnCount() && offset < size; column_idx++) {
+    offset += EncodeValue(key.GetValue(key_schema, column_idx), out + offset, size - offset);
+  }
+}
+
+std::string KeyEncoder::Encode(const Tuple &key, const Schema *key_schema) {
+  std::string encoded;
+  for (uint32_t column_idx = 0; column_idx < key_schema->GetColumnCount(); column_idx++) {
+    Value value = key.GetValue(key_schema, column_idx);
+    size_t offset = encoded.size();
+    encoded.resize(offset + EncodeValue(value, nullptr, 0));
+    EncodeValue(value, encoded.data() + offset, encoded.size() - offset);
+  }
+  return encoded;
+}
+
+uint32_t KeyEncoder::MaxLength(const Schema *key_schema) {
+  uint32_t length = 0;
+  for (const auto &column : key_schema->GetColumns()) {
+    uint32_t width = FixedWidth(column.GetType());
+    if (width == 0) {
+      return UINT32_MAX;
+    }
+    length += width;
+  }
+  return length;
+}
+
+uint32_t KeyEncoder::EncodeValue(const Value &value, char *out, uint32_t size) {
+  TypeId type = value.GetTypeId();
+  uint32_t width = FixedWidth(type);
+  uint64_t bits;
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      bits = static_cast<uint8_t>(value.GetAs<int8_t>()) ^ SignBit(width);
+      break;
+    case TypeId::SMALLINT:
+      bits = static_cast<uint16_t>(value.GetAs<int16_t>()) ^ SignBit(width);
+      break;
+    case TypeId::INTEGER:
+      bits = static_cast<uint32_t>(value.GetAs<int32_t>()) ^ SignBit(width);
+      break;
+    case TypeId::BIGINT:
+      bits = static_cast<uint64_t>(value.GetAs<int64_t>()) ^ SignBit(width);
+      break;
+    case TypeId::DECIMAL: {
+      double decimal = value.GetAs<double>() + 0.0;
+      memcpy(&bits, &decimal, sizeof(bits));
+      bits = (bits & SignBit(width)) != 0 ? ~bits : bits | SignBit(width);
+      break;
+    }
+    case TypeId::TIMESTAMP:
+      bits = value.GetAs<uint64_t>();
+      break;
+    case TypeId::VARCHAR: {
+      uint32_t length = 0;
+      auto put = [&](char byte) {
+        if (length < size) {
+          out[length] = byte;
+        }
+        length++;
+      };
+      if (value.IsNull()) {
+        put(0);
+        return length;
+      }
+      put(1);
+      // the stored length counts the terminating zero
+      const char *chars = value.GetData();
+      uint32_t num_chars = value.GetLength() > 0 ? value.GetLength() - 1 : 0;
+      for (uint32_t i = 0; i < num_chars; i++) {
+        put(chars[i]);
+        if (chars[i] == 0) {
+          put(static_cast<char>(0xFF));
+        }
+      }
+      put(0);
+      put(0);
+      return length;
+    }
+    default:
+      throw Exception(ExceptionType::UNKNOWN_TYPE, "cannot encode a key column of this type");
+  }
+  PutBigEndian(bits, width, out, size);
+  return width;
+}
+
+Value KeyEncoder::Decode(const char *data, uint32_t size, const Schema *key_schema, uint32_t column_idx) {
+  uint32_t offset = 0;
+  for (uint32_t i = 0;; i++) {
+    uint32_t length;
+    Value value = DecodeValue(key_schema->GetColumn(i).GetType(), data + std::min(offset, size),
+                              offset < size ? size - offset : 0, &length);
+    if (i == column_idx) {
+      return value;
+    }
+    offset += length;
+  }
+}
+
+Value KeyEncoder::DecodeValue(TypeId type, const char *data, uint32_t size, uint32_t *length) {
+  uint32_t width = FixedWidth(type);
+  uint64_t bits = GetBigEndian(data, width, size);
+  *length = width;
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return Value(type, static_cast<int8_t>(bits ^ SignBit(width)));
+    case TypeId::SMALLINT:
+      return Value(type, static_cast<int16_t>(bits ^ SignBit(width)));
+    case TypeId::INTEGER:
+      return Value(type, static_cast<int32_t>(bits ^ SignBit(width)));
+    case TypeId::BIGINT:
+      return Value(type, static_cast<int64_t>(bits ^ SignBit(width)));
+    case TypeId::DECIMAL: {
+      bits = (bits & SignBit(width)) != 0 ? bits & ~SignBit(width) : ~bits;
+      double decimal;
+      memcpy(&decimal, &bits, sizeof(decimal));
+      return Value(type, decimal);
+    }
+    case TypeId::TIMESTAMP:
+      return Value(type, bits);
+    case TypeId::VARCHAR: {
+      if (size == 0 || data[0] == 0) {
+        *length = 1;
+        return ValueFactory::GetNullValueByType(type);
+      }
+      std::string chars;
+      uint32_t i = 1;
+      while (i < size) {
+        if (data[i] != 0) {
+          chars.push_back(data[i++]);
+        } else if (i + 1 < size && static_cast<uint8_t>(data[i + 1]) == 0xFF) {
+          chars.push_back(0);
+          i += 2;
+        } else {
+          // the terminator
+          i += 2;
+          break;
+        }
+      }
+      *length = i;
+      return Value(type, chars);
+    }
+    default:
+      throw Exception(ExceptionType::UNKNOWN_TYPE, "cannot decode a key column of this type");
+  }
+}
+
+}  // namespace bustub
@@ -9,8 +9,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "storage/page/b_plus_tree_internal_page.h"
@@ -25,34 +27,86 @@ namespace bustub {
  * max page size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::INTERNAL_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  max_size_limit_ = max_size;
+  array_.Init();
+  UpdateMaxSize();
+}
 /*
  * Helper method to get/set the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+KeyType B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const { return array_.KeyAt(index); }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key, const KeyComparator &comparator) {
+  array_.SetKeyAt(index, key, comparator.KeyHead(key), GetSize());
+  UpdateMaxSize();
+}
 
 /*
  * Helper method to find and return array index(or offset), so that its value
  * equals to input "value"
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const { return 0; }
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueIndex(const ValueType &value) const {
+  for (int index = 0; index < GetSize(); index++) {
+    if (array_.ValueAt(index) == value) {
+      return index;
+    }
+  }
+  return -1;
+}
 
 /*
  * Helper method to get the value associated with input "index"(a.k.a array
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return array_.ValueAt(index); }
+
+/*****************************************************************************
+ * CAPACITY
+ *****************************************************************************/
+/*
+ * @return whether a child under key fits, or key can replace a key of mine, even if the entries have to be widened
+ * for it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_INTERNAL_PAGE_TYPE::HasRoomFor(const KeyType &key) const {
+  return array_.HasRoomFor(key, GetSize());
+}
+
+/*
+ * @return the max size of the page that holds my children, those of sibling and middle_key
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSizeMergedWith(const BPlusTreeInternalPage *sibling,
+                                                      const KeyType &middle_key) const {
+  return MaxSize(max_size_limit_, array_.CommonSizeWith(sibling->array_, sibling->GetSize(), GetSize(), &middle_key));
+}
+
+/*
+ * @return the max size of an internal page whose keys have common_size bytes in common. A page overflows by one
+ * child before it splits, and either half of it, plus the key inserted when it splits, has to fit with no bytes in
+ * common.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::MaxSize(int max_size_limit, int common_size) {
+  int uncompressed_max_size = std::min(max_size_limit, KeyArray::Capacity(0) - 1);
+  return std::min({max_size_limit, KeyArray::Capacity(common_size) - 1,
+                   std::max(uncompressed_max_size, 2 * uncompressed_max_size - 2)});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::UpdateMaxSize() {
+  SetMaxSize(MaxSize(max_size_limit_, array_.GetCommonSize(GetSize())));
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -64,7 +118,13 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const { return 0; }
  */
 INDEX_TEMPLATE_ARGUMENTS
 ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const {
-  return INVALID_PAGE_ID;
+  return array_.ValueAt(LookupIndex(key, comparator));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator) const {
+  // find the first key greater than key; the child before it covers key
+  return array_.Search(key, true, 1, GetSize(), comparator) - 1;
 }
 
 /*****************************************************************************
@@ -78,7 +138,14 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCo
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value, const KeyType &new_key,
-                                                     const ValueType &new_value) {}
+                                                     const ValueType &new_value, const KeyComparator &comparator) {
+  // the first key is never looked at, but it takes part in the compression, so new_key is the best fit
+  uint32_t head = comparator.KeyHead(new_key);
+  array_.Insert(0, new_key, old_value, head, 0);
+  array_.Insert(1, new_key, new_value, head, 1);
+  SetSize(2);
+  UpdateMaxSize();
+}
 /*
  * Insert new_key & new_value pair right after the pair with its value ==
  * old_value
@@ -86,8 +153,25 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::PopulateNewRoot(const ValueType &old_value,
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value, const KeyType &new_key,
-                                                    const ValueType &new_value) {
-  return 0;
+                                                    const ValueType &new_value, const KeyComparator &comparator) {
+  int index = ValueIndex(old_value) + 1;
+  array_.Insert(index, new_key, new_value, comparator.KeyHead(new_key), GetSize());
+  IncreaseSize(1);
+  UpdateMaxSize();
+  return GetSize();
+}
+
+/*
+ * Append key & value pair after all others. Used to fill pages when bulk
+ * loading, where the child already has me as its parent, so unlike
+ * CopyLastFrom this does not adopt it.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Append(const KeyType &key, const ValueType &value,
+                                            const KeyComparator &comparator) {
+  array_.Insert(GetSize(), key, value, comparator.KeyHead(key), GetSize());
+  IncreaseSize(1);
+  UpdateMaxSize();
 }
 
 /*****************************************************************************
@@ -98,14 +182,36 @@ int B_PLUS_TREE_INTERNAL_PAGE_TYPE::InsertNodeAfter(const ValueType &old_value,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveHalfTo(BPlusTreeInternalPage *recipient,
-                                                BufferPoolManager *buffer_pool_manager) {}
+                                                BufferPoolManager *buffer_pool_manager) {
+  // the first key moved becomes the recipient's invalid key, and is pushed up to the parent by the caller
+  int keep = (GetSize() + 1) / 2;
+  std::vector<MappingType> items;
+  std::vector<uint32_t> heads;
+  for (int index = keep; index < GetSize(); index++) {
+    items.push_back(array_.ItemAt(index));
+    heads.push_back(array_.HeadAt(index));
+  }
+  recipient->CopyNFrom(items.data(), heads.data(), items.size(), buffer_pool_manager);
+  SetSize(keep);
+  // the keys left behind may have more bytes in common
+  array_.Compact(keep);
+  UpdateMaxSize();
+}
 
-/* Copy entries into me, starting from {items} and copy {size} entries.
+/* Copy entries into me, starting from {items} and their {heads} and copy {size} entries.
  * Since it is an internal page, for all entries (pages) moved, their parents page now changes to me.
  * So I need to 'adopt' them by changing their parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, const uint32_t *heads, int size,
+                                               BufferPoolManager *buffer_pool_manager) {
+  for (int index = 0; index < size; index++) {
+    array_.Insert(GetSize(), items[index].first, items[index].second, heads[index], GetSize());
+    Adopt(items[index].second, buffer_pool_manager);
+    IncreaseSize(1);
+  }
+  UpdateMaxSize();
+}
 
 /*****************************************************************************
  * REMOVE
@@ -116,14 +222,20 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyNFrom(MappingType *items, int size, Buf
  * NOTE: store key&value pair continuously after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Remove(int index) {
+  array_.Remove(index, GetSize());
+  IncreaseSize(-1);
+}
 
 /*
  * Remove the only key & value pair in internal page and return the value
  * NOTE: only call this method within AdjustRoot()(in b_plus_tree.cpp)
  */
 INDEX_TEMPLATE_ARGUMENTS
-ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return INVALID_PAGE_ID; }
+ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() {
+  SetSize(0);
+  return ValueAt(0);
+}
 /*****************************************************************************
  * MERGE
  *****************************************************************************/
@@ -136,7 +248,18 @@ ValueType B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAndReturnOnlyChild() { return IN
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                               BufferPoolManager *buffer_pool_manager) {}
+                                               const KeyComparator &comparator,
+                                               BufferPoolManager *buffer_pool_manager) {
+  SetKeyAt(0, middle_key, comparator);
+  std::vector<MappingType> items;
+  std::vector<uint32_t> heads;
+  for (int index = 0; index < GetSize(); index++) {
+    items.push_back(array_.ItemAt(index));
+    heads.push_back(array_.HeadAt(index));
+  }
+  recipient->CopyNFrom(items.data(), heads.data(), items.size(), buffer_pool_manager);
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -151,14 +274,25 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveAllTo(BPlusTreeInternalPage *recipient,
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                      BufferPoolManager *buffer_pool_manager) {}
+                                                      const KeyComparator &comparator,
+                                                      BufferPoolManager *buffer_pool_manager) {
+  // my first key is invalid, so the moved child goes under middle_key, and my second key becomes the new separator
+  recipient->CopyLastFrom(MappingType(middle_key, ValueAt(0)), comparator.KeyHead(middle_key), buffer_pool_manager);
+  Remove(0);
+}
 
 /* Append an entry at the end.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, uint32_t head,
+                                                  BufferPoolManager *buffer_pool_manager) {
+  array_.Insert(GetSize(), pair.first, pair.second, head, GetSize());
+  Adopt(pair.second, buffer_pool_manager);
+  IncreaseSize(1);
+  UpdateMaxSize();
+}
 
 /*
  * Remove the last key & value pair from this page to head of "recipient" page.
@@ -169,14 +303,40 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeInternalPage *recipient, const KeyType &middle_key,
-                                                       BufferPoolManager *buffer_pool_manager) {}
+                                                       const KeyComparator &comparator,
+                                                       BufferPoolManager *buffer_pool_manager) {
+  // the recipient's old first child now sits under middle_key, and the moved key is left in its invalid first key,
+  // from where the caller pushes it up as the new separator
+  recipient->SetKeyAt(0, middle_key, comparator);
+  recipient->CopyFirstFrom(array_.ItemAt(GetSize() - 1), array_.HeadAt(GetSize() - 1), buffer_pool_manager);
+  IncreaseSize(-1);
+}
 
 /* Append an entry at the beginning.
  * Since it is an internal page, the moved entry(page)'s parent needs to be updated.
  * So I need to 'adopt' it by changing its parent page id, which needs to be persisted with BufferPoolManger
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, BufferPoolManager *buffer_pool_manager) {}
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyFirstFrom(const MappingType &pair, uint32_t head,
+                                                   BufferPoolManager *buffer_pool_manager) {
+  array_.Insert(0, pair.first, pair.second, head, GetSize());
+  Adopt(pair.second, buffer_pool_manager);
+  IncreaseSize(1);
+  UpdateMaxSize();
+}
+
+/*
+ * Make me the parent of the child page, persisting the change through the buffer pool manager
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Adopt(page_id_t child_page_id, BufferPoolManager *buffer_pool_manager) {
+  Page *page = buffer_pool_manager->FetchPage(child_page_id);
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot fetch a child page to adopt");
+  }
+  reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(GetPageId());
+  buffer_pool_manager->UnpinPage(child_page_id, true);
+}
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -9,7 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "common/exception.h"
 #include "common/rid.h"
@@ -24,46 +26,98 @@ namespace bustub {
 /**
  * Init method after creating a new leaf page
  * Including set page type, set current size to zero, set page id/parent id, set
- * next page id and set max size
+ * next/prev page id and set max size
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  SetPageType(IndexPageType::LEAF_PAGE);
+  SetSize(0);
+  SetPageId(page_id);
+  SetParentPageId(parent_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
+  max_size_limit_ = max_size;
+  array_.Init();
+  UpdateMaxSize();
+}
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next/prev page id
  */
 INDEX_TEMPLATE_ARGUMENTS
-page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return INVALID_PAGE_ID; }
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const { return next_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) {}
+page_id_t B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
 
 /**
  * Helper method to find the first index i so that array[i].first >= key
  * NOTE: This method is only used when generating index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::KeyIndex(const KeyType &key, const KeyComparator &comparator) const {
+  return array_.Search(key, false, 0, GetSize(), comparator);
+}
 
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const {
-  // replace with your own code
-  KeyType key{};
-  return key;
-}
+KeyType B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const { return array_.KeyAt(index); }
 
 /*
  * Helper method to find and return the key & value pair associated with input
  * "index"(a.k.a array offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
-  // replace with your own code
-  return array_[0];
+MappingType B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) const { return array_.ItemAt(index); }
+
+/*****************************************************************************
+ * CAPACITY
+ *****************************************************************************/
+/*
+ * @return whether an entry with key fits, even if the entries have to be widened for it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+bool B_PLUS_TREE_LEAF_PAGE_TYPE::HasRoomFor(const KeyType &key) const { return array_.HasRoomFor(key, GetSize()); }
+
+/*
+ * @return the max size once an entry with key is inserted
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeWith(const KeyType &key) const {
+  return MaxSize(max_size_limit_, array_.CommonSizeWith(key, GetSize()));
+}
+
+/*
+ * @return the max size of the page that holds both my entries and those of sibling
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSizeMergedWith(const BPlusTreeLeafPage *sibling) const {
+  return MaxSize(max_size_limit_, array_.CommonSizeWith(sibling->array_, sibling->GetSize(), GetSize()));
+}
+
+/*
+ * @return the max size of a leaf page whose keys have common_size bytes in common. A page is full at max size, and
+ * either half of a full page, plus the key inserted when it splits, has to fit with no bytes in common.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+int B_PLUS_TREE_LEAF_PAGE_TYPE::MaxSize(int max_size_limit, int common_size) {
+  int uncompressed_max_size = std::min(max_size_limit, KeyArray::Capacity(0));
+  return std::min({max_size_limit, KeyArray::Capacity(common_size),
+                   std::max(uncompressed_max_size, 2 * uncompressed_max_size - 3)});
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::UpdateMaxSize() {
+  SetMaxSize(MaxSize(max_size_limit_, array_.GetCommonSize(GetSize())));
 }
 
 /*****************************************************************************
@@ -75,7 +129,24 @@ const MappingType &B_PLUS_TREE_LEAF_PAGE_TYPE::GetItem(int index) {
  */
 INDEX_TEMPLATE_ARGUMENTS
 int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
-  return 0;
+  int index = KeyIndex(key, comparator);
+  if (index < GetSize() && comparator(array_.KeyAt(index), key) == 0) {
+    // only unique keys are supported
+    return GetSize();
+  }
+  array_.Insert(index, key, value, comparator.KeyHead(key), GetSize());
+  IncreaseSize(1);
+  UpdateMaxSize();
+  return GetSize();
+}
+
+/*
+ * Append key & value pair after all others, which the caller guarantees are
+ * smaller. Used to fill pages when bulk loading.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::Append(const KeyType &key, const ValueType &value, const KeyComparator &comparator) {
+  CopyLastFrom(MappingType(key, value), comparator.KeyHead(key));
 }
 
 /*****************************************************************************
@@ -85,13 +156,32 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &valu
  * Remove half of key & value pairs from this page to "recipient" page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveHalfTo(BPlusTreeLeafPage *recipient) {
+  int keep = GetSize() / 2;
+  std::vector<MappingType> items;
+  std::vector<uint32_t> heads;
+  for (int index = keep; index < GetSize(); index++) {
+    items.push_back(array_.ItemAt(index));
+    heads.push_back(array_.HeadAt(index));
+  }
+  recipient->CopyNFrom(items.data(), heads.data(), items.size());
+  SetSize(keep);
+  // the keys left behind may have more bytes in common
+  array_.Compact(keep);
+  UpdateMaxSize();
+}
 
 /*
- * Copy starting from items, and copy {size} number of elements into me.
+ * Copy starting from items and their heads, and copy {size} number of elements into me.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, const uint32_t *heads, int size) {
+  for (int index = 0; index < size; index++) {
+    array_.Insert(GetSize(), items[index].first, items[index].second, heads[index], GetSize());
+    IncreaseSize(1);
+  }
+  UpdateMaxSize();
+}
 
 /*****************************************************************************
  * LOOKUP
@@ -103,7 +193,12 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyNFrom(MappingType *items, int size) {}
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, const KeyComparator &comparator) const {
-  return false;
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_.KeyAt(index), key) != 0) {
+    return false;
+  }
+  *value = array_.ValueAt(index);
+  return true;
 }
 
 /*****************************************************************************
@@ -116,7 +211,15 @@ bool B_PLUS_TREE_LEAF_PAGE_TYPE::Lookup(const KeyType &key, ValueType *value, co
  * @return   page size after deletion
  */
 INDEX_TEMPLATE_ARGUMENTS
-int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) { return 0; }
+int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const KeyComparator &comparator) {
+  int index = KeyIndex(key, comparator);
+  if (index == GetSize() || comparator(array_.KeyAt(index), key) != 0) {
+    return GetSize();
+  }
+  array_.Remove(index, GetSize());
+  IncreaseSize(-1);
+  return GetSize();
+}
 
 /*****************************************************************************
  * MERGE
@@ -126,7 +229,17 @@ int B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAndDeleteRecord(const KeyType &key, const
  * to update the next_page id in the sibling page
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {
+  std::vector<MappingType> items;
+  std::vector<uint32_t> heads;
+  for (int index = 0; index < GetSize(); index++) {
+    items.push_back(array_.ItemAt(index));
+    heads.push_back(array_.HeadAt(index));
+  }
+  recipient->CopyNFrom(items.data(), heads.data(), items.size());
+  recipient->SetNextPageId(GetNextPageId());
+  SetSize(0);
+}
 
 /*****************************************************************************
  * REDISTRIBUTE
@@ -135,25 +248,40 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveAllTo(BPlusTreeLeafPage *recipient) {}
  * Remove the first key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveFirstToEndOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyLastFrom(array_.ItemAt(0), array_.HeadAt(0));
+  array_.Remove(0, GetSize());
+  IncreaseSize(-1);
+}
 
 /*
- * Copy the item into the end of my item list. (Append item to my array)
+ * Copy the item, whose key has head, into the end of my item list. (Append item to my array)
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyLastFrom(const MappingType &item, uint32_t head) {
+  array_.Insert(GetSize(), item.first, item.second, head, GetSize());
+  IncreaseSize(1);
+  UpdateMaxSize();
+}
 
 /*
  * Remove the last key & value pair from this page to "recipient" page.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveLastToFrontOf(BPlusTreeLeafPage *recipient) {
+  recipient->CopyFirstFrom(array_.ItemAt(GetSize() - 1), array_.HeadAt(GetSize() - 1));
+  IncreaseSize(-1);
+}
 
 /*
- * Insert item at the front of my items. Move items accordingly.
+ * Insert item, whose key has head, at the front of my items. Move items accordingly.
  */
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item) {}
+void B_PLUS_TREE_LEAF_PAGE_TYPE::CopyFirstFrom(const MappingType &item, uint32_t head) {
+  array_.Insert(0, item.first, item.second, head, GetSize());
+  IncreaseSize(1);
+  UpdateMaxSize();
+}
 
 template class BPlusTreeLeafPage<GenericKey<4>, RID, GenericComparator<4>>;
 template class BPlusTreeLeafPage<GenericKey<8>, RID, GenericComparator<8>>;
@@ -0,0 +1,33 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// b_plus_tree_meta_page.cpp
+//
+// Identification: src/storage/page/b_plus_tree_meta_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/b_plus_tree_meta_page.h"
+
+namespace bustub {
+
+void BPlusTreeMetaPage::Init(page_id_t page_id) {
+  lsn_ = INVALID_LSN;
+  page_id_ = page_id;
+  root_page_id_ = INVALID_PAGE_ID;
+}
+
+lsn_t BPlusTreeMetaPage::GetLSN() const { return lsn_; }
+
+void BPlusTreeMetaPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+page_id_t BPlusTreeMetaPage::GetPageId() const { return page_id_; }
+
+page_id_t BPlusTreeMetaPage::GetRootPageId() const { return root_page_id_; }
+
+void BPlusTreeMetaPage::SetRootPageId(page_id_t root_page_id) { root_page_id_ = root_page_id; }
+
+}  // namespace bustub
@@ -9,6 +9,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+
 #include "storage/page/b_plus_tree_page.h"
 
 namespace bustub {
@@ -17,45 +19,71 @@ namespace bustub {
  * Helper methods to get/set page type
  * Page type enum class is defined in b_plus_tree_page.h
  */
-bool BPlusTreePage::IsLeafPage() const { return false; }
-bool BPlusTreePage::IsRootPage() const { return false; }
-void BPlusTreePage::SetPageType(IndexPageType page_type) {}
+bool BPlusTreePage::IsLeafPage() const { return page_type_ == IndexPageType::LEAF_PAGE; }
+bool BPlusTreePage::IsRootPage() const { return parent_page_id_ == INVALID_PAGE_ID; }
+void BPlusTreePage::SetPageType(IndexPageType page_type) { page_type_ = page_type; }
 
 /*
  * Helper methods to get/set size (number of key/value pairs stored in that
  * page)
  */
-int BPlusTreePage::GetSize() const { return 0; }
-void BPlusTreePage::SetSize(int size) {}
-void BPlusTreePage::IncreaseSize(int amount) {}
+int BPlusTreePage::GetSize() const { return size_; }
+void BPlusTreePage::SetSize(int size) { size_ = size; }
+void BPlusTreePage::IncreaseSize(int amount) { size_ += amount; }
 
 /*
  * Helper methods to get/set max size (capacity) of the page
  */
-int BPlusTreePage::GetMaxSize() const { return 0; }
-void BPlusTreePage::SetMaxSize(int size) {}
+int BPlusTreePage::GetMaxSize() const { return max_size_; }
+void BPlusTreePage::SetMaxSize(int size) { max_size_ = size; }
 
 /*
  * Helper method to get min page size
  * Generally, min page size == max page size / 2
+ * Internal pages hold one more child than keys, hence the rounding up.
  */
-int BPlusTreePage::GetMinSize() const { return 0; }
+int BPlusTreePage::GetMinSize() const { return IsLeafPage() ? max_size_ / 2 : (max_size_ + 1) / 2; }
 
 /*
  * Helper methods to get/set parent page id
  */
-page_id_t BPlusTreePage::GetParentPageId() const { return 0; }
-void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) {}
+page_id_t BPlusTreePage::GetParentPageId() const { return parent_page_id_; }
+void BPlusTreePage::SetParentPageId(page_id_t parent_page_id) { parent_page_id_ = parent_page_id; }
 
 /*
  * Helper methods to get/set self page id
  */
-page_id_t BPlusTreePage::GetPageId() const { return 0; }
-void BPlusTreePage::SetPageId(page_id_t page_id) {}
+page_id_t BPlusTreePage::GetPageId() const { return page_id_; }
+void BPlusTreePage::SetPageId(page_id_t page_id) { page_id_ = page_id; }
 
 /*
  * Helper methods to set lsn
  */
 void BPlusTreePage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
 
+/*
+ * Helper methods for optimistic lock coupling, a sequence lock on the page contents
+ */
+uint32_t BPlusTreePage::GetVersion() const { return __atomic_load_n(&version_, __ATOMIC_ACQUIRE); }
+
+bool BPlusTreePage::ValidateVersion(uint32_t version) const {
+  // keep the reads of the page contents from moving past the second read of the version
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return __atomic_load_n(&version_, __ATOMIC_RELAXED) == version;
+}
+
+void BPlusTreePage::LockVersion() {
+  if ((version_ & 1) == 0) {
+    __atomic_store_n(&version_, version_ + 1, __ATOMIC_RELAXED);
+    // keep the writes to the page contents from moving ahead of the odd version
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+}
+
+void BPlusTreePage::UnlockVersion() {
+  if ((version_ & 1) != 0) {
+    __atomic_store_n(&version_, version_ + 1, __ATOMIC_RELEASE);
+  }
+}
+
 }  // namespace bustub
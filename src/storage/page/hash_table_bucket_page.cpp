@@ -10,6 +10,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
 #include "storage/page/hash_table_bucket_page.h"
 #include "common/logger.h"
 #include "common/util/hash_util.h"
@@ -19,63 +26,248 @@
 
 namespace bustub {
 
+// Number of fingerprints compared per probe step; also the width of the occupied/readable masks.
+#ifdef __AVX2__
+static constexpr uint32_t PROBE_WIDTH = 32;
+#else
+static constexpr uint32_t PROBE_WIDTH = 16;
+#endif
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, KeyComparator cmp, std::vector<ValueType> *result) {
+bool HASH_TABLE_BUCKET_TYPE::GetValue(KeyType key, uint32_t hash, KeyComparator cmp, std::vector<ValueType> *result) {
+  uint8_t fingerprint = Fingerprint(hash);
+  bool found = false;
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE; base += PROBE_WIDTH) {
+    if (OccupiedMask(base) == 0) {
+      break;
+    }
+    for (uint32_t match = MatchFingerprint(base, fingerprint); match != 0; match &= match - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(match);
+      if (cmp(key, array_[bucket_idx].first) == 0) {
+        result->push_back(array_[bucket_idx].second);
+        found = true;
+      }
+    }
+  }
+  return found;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, uint32_t hash, KeyComparator cmp) {
+  uint8_t fingerprint = Fingerprint(hash);
+  uint32_t free_idx = BUCKET_ARRAY_SIZE;
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE; base += PROBE_WIDTH) {
+    if (free_idx == BUCKET_ARRAY_SIZE) {
+      uint32_t free = ~ReadableMask(base) & LaneMask(base);
+      if (free != 0) {
+        free_idx = base + __builtin_ctz(free);
+      }
+    }
+    if (OccupiedMask(base) == 0) {
+      break;
+    }
+    for (uint32_t match = MatchFingerprint(base, fingerprint); match != 0; match &= match - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(match);
+      if (cmp(key, array_[bucket_idx].first) == 0 && value == array_[bucket_idx].second) {
+        return false;
+      }
+    }
+  }
+  if (free_idx == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  array_[free_idx] = MappingType(key, value);
+  fingerprints_[free_idx] = fingerprint;
+  SetOccupied(free_idx);
+  SetReadable(free_idx);
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, uint32_t hash, KeyComparator cmp) {
+  uint8_t fingerprint = Fingerprint(hash);
+  for (uint32_t base = 0; base < BUCKET_ARRAY_SIZE; base += PROBE_WIDTH) {
+    if (OccupiedMask(base) == 0) {
+      break;
+    }
+    for (uint32_t match = MatchFingerprint(base, fingerprint); match != 0; match &= match - 1) {
+      uint32_t bucket_idx = base + __builtin_ctz(match);
+      if (cmp(key, array_[bucket_idx].first) == 0 && value == array_[bucket_idx].second) {
+        RemoveAt(bucket_idx);
+        return true;
+      }
+    }
+  }
   return false;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::Insert(KeyType key, ValueType value, KeyComparator cmp) {
+bool HASH_TABLE_BUCKET_TYPE::InsertSorted(KeyType key, ValueType value, uint32_t hash, KeyComparator cmp) {
+  uint32_t num_readable = NumReadable();
+  uint32_t insert_idx = LowerBound(key, cmp);
+  for (; insert_idx < num_readable && cmp(key, array_[insert_idx].first) == 0; insert_idx++) {
+    if (value == array_[insert_idx].second) {
+      return false;
+    }
+  }
+  if (num_readable == BUCKET_ARRAY_SIZE) {
+    return false;
+  }
+  std::copy_backward(array_ + insert_idx, array_ + num_readable, array_ + num_readable + 1);
+  std::copy_backward(fingerprints_ + insert_idx, fingerprints_ + num_readable, fingerprints_ + num_readable + 1);
+  array_[insert_idx] = MappingType(key, value);
+  fingerprints_[insert_idx] = Fingerprint(hash);
+  SetOccupied(num_readable);
+  SetReadable(num_readable);
   return true;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-bool HASH_TABLE_BUCKET_TYPE::Remove(KeyType key, ValueType value, KeyComparator cmp) {
+bool HASH_TABLE_BUCKET_TYPE::RemoveSorted(KeyType key, ValueType value, KeyComparator cmp) {
+  uint32_t num_readable = NumReadable();
+  for (uint32_t bucket_idx = LowerBound(key, cmp); bucket_idx < num_readable && cmp(key, array_[bucket_idx].first) == 0;
+       bucket_idx++) {
+    if (value == array_[bucket_idx].second) {
+      std::copy(array_ + bucket_idx + 1, array_ + num_readable, array_ + bucket_idx);
+      std::copy(fingerprints_ + bucket_idx + 1, fingerprints_ + num_readable, fingerprints_ + bucket_idx);
+      RemoveAt(num_readable - 1);
+      return true;
+    }
+  }
   return false;
 }
 
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::LowerBound(const KeyType &key, KeyComparator cmp) {
+  uint32_t low = 0;
+  uint32_t high = NumReadable();
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (cmp(array_[mid].first, key) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void HASH_TABLE_BUCKET_TYPE::Compact() {
+  uint32_t num_readable = 0;
+  for (uint32_t bucket_idx = 0; bucket_idx < BUCKET_ARRAY_SIZE && IsOccupied(bucket_idx); bucket_idx++) {
+    if (!IsReadable(bucket_idx)) {
+      continue;
+    }
+    if (bucket_idx != num_readable) {
+      array_[num_readable] = array_[bucket_idx];
+      fingerprints_[num_readable] = fingerprints_[bucket_idx];
+      RemoveAt(bucket_idx);
+      SetReadable(num_readable);
+    }
+    num_readable++;
+  }
+}
+
 template <typename KeyType, typename ValueType, typename KeyComparator>
 KeyType HASH_TABLE_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const {
-  return {};
+  return array_[bucket_idx].first;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 ValueType HASH_TABLE_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const {
-  return {};
+  return array_[bucket_idx].second;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] &= static_cast<char>(~(1 << (bucket_idx % 8)));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const {
-  return false;
+  return (occupied_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetOccupied(uint32_t bucket_idx) {
+  occupied_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const {
-  return false;
+  return (readable_[bucket_idx / 8] & (1 << (bucket_idx % 8))) != 0;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
-void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {}
+void HASH_TABLE_BUCKET_TYPE::SetReadable(uint32_t bucket_idx) {
+  readable_[bucket_idx / 8] |= static_cast<char>(1 << (bucket_idx % 8));
+}
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsFull() {
-  return false;
+  return NumReadable() == BUCKET_ARRAY_SIZE;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 uint32_t HASH_TABLE_BUCKET_TYPE::NumReadable() {
-  return 0;
+  uint32_t num_readable = 0;
+  for (size_t byte_idx = 0; byte_idx < sizeof(readable_); byte_idx++) {
+    num_readable += __builtin_popcount(static_cast<unsigned char>(readable_[byte_idx]));
+  }
+  return num_readable;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
 bool HASH_TABLE_BUCKET_TYPE::IsEmpty() {
-  return false;
+  for (size_t byte_idx = 0; byte_idx < sizeof(readable_); byte_idx++) {
+    if (readable_[byte_idx] != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::MatchFingerprint(uint32_t base, uint8_t fingerprint) const {
+  uint32_t match = 0;
+#if defined(__AVX2__)
+  __m256i needle = _mm256_set1_epi8(static_cast<char>(fingerprint));
+  __m256i slots = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(fingerprints_ + base));
+  match = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(needle, slots)));
+#elif defined(__SSE2__)
+  __m128i needle = _mm_set1_epi8(static_cast<char>(fingerprint));
+  __m128i slots = _mm_loadu_si128(reinterpret_cast<const __m128i *>(fingerprints_ + base));
+  match = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(needle, slots)));
+#else
+  for (uint32_t lane = 0; lane < PROBE_WIDTH && base + lane < BUCKET_ARRAY_SIZE; lane++) {
+    match |= static_cast<uint32_t>(fingerprints_[base + lane] == fingerprint) << lane;
+  }
+#endif
+  // Lanes past the end of the bucket read whatever follows fingerprints_; ReadableMask clears them.
+  return match & ReadableMask(base);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::OccupiedMask(uint32_t base) const {
+  uint32_t mask = 0;
+  memcpy(&mask, occupied_ + base / 8, std::min<size_t>(PROBE_WIDTH / 8, sizeof(occupied_) - base / 8));
+  return mask & LaneMask(base);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::ReadableMask(uint32_t base) const {
+  uint32_t mask = 0;
+  memcpy(&mask, readable_ + base / 8, std::min<size_t>(PROBE_WIDTH / 8, sizeof(readable_) - base / 8));
+  return mask & LaneMask(base);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_BUCKET_TYPE::LaneMask(uint32_t base) {
+  if (base + PROBE_WIDTH <= BUCKET_ARRAY_SIZE) {
+    return static_cast<uint32_t>((uint64_t{1} << PROBE_WIDTH) - 1);
+  }
+  return (1U << (BUCKET_ARRAY_SIZE - base)) - 1;
 }
 
 template <typename KeyType, typename ValueType, typename KeyComparator>
@@ -0,0 +1,54 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_directory_header_page.cpp
+//
+// Identification: src/storage/page/hash_table_directory_header_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/hash_table_directory_header_page.h"
+
+namespace bustub {
+page_id_t HashTableDirectoryHeaderPage::GetPageId() const { return page_id_; }
+
+void HashTableDirectoryHeaderPage::SetPageId(bustub::page_id_t page_id) { page_id_ = page_id; }
+
+lsn_t HashTableDirectoryHeaderPage::GetLSN() const { return lsn_; }
+
+void HashTableDirectoryHeaderPage::SetLSN(lsn_t lsn) { lsn_ = lsn; }
+
+uint32_t HashTableDirectoryHeaderPage::GetGlobalDepth() const { return global_depth_; }
+
+uint32_t HashTableDirectoryHeaderPage::GetGlobalDepthMask() const { return (1U << global_depth_) - 1; }
+
+void HashTableDirectoryHeaderPage::IncrGlobalDepth() {
+  assert(global_depth_ < MAX_GLOBAL_DEPTH);
+  global_depth_++;
+}
+
+void HashTableDirectoryHeaderPage::DecrGlobalDepth() {
+  assert(global_depth_ > 0);
+  global_depth_--;
+}
+
+uint32_t HashTableDirectoryHeaderPage::Size() const { return 1U << global_depth_; }
+
+uint32_t HashTableDirectoryHeaderPage::NumDirectoryPages() const {
+  return global_depth_ <= DIRECTORY_ARRAY_DEPTH ? 1 : 1U << (global_depth_ - DIRECTORY_ARRAY_DEPTH);
+}
+
+page_id_t HashTableDirectoryHeaderPage::GetDirectoryPageId(uint32_t directory_idx) const {
+  assert(directory_idx < DIRECTORY_HEADER_ARRAY_SIZE);
+  return directory_page_ids_[directory_idx];
+}
+
+void HashTableDirectoryHeaderPage::SetDirectoryPageId(uint32_t directory_idx, page_id_t directory_page_id) {
+  assert(directory_idx < DIRECTORY_HEADER_ARRAY_SIZE);
+  directory_page_ids_[directory_idx] = directory_page_id;
+}
+
+}  // namespace bustub
@@ -0,0 +1,247 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_slotted_bucket_page.cpp
+//
+// Identification: src/storage/page/hash_table_slotted_bucket_page.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+
+#include "storage/page/hash_table_slotted_bucket_page.h"
+#include "common/logger.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+#define HASH_TABLE_SLOTTED_BUCKET_TYPE HashTableSlottedBucketPage<ValueType, KeyComparator>
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::GetValue(const VarlenKey &key, uint32_t hash, KeyComparator cmp,
+                                              std::vector<ValueType> *result) {
+  uint8_t fingerprint = Fingerprint(hash);
+  bool found = false;
+  for (uint32_t bucket_idx = 0; bucket_idx < num_slots_; bucket_idx++) {
+    const Slot &slot = slots_[bucket_idx];
+    if (slot.readable_ != 0 && slot.fingerprint_ == fingerprint && CompareAt(bucket_idx, key, cmp) == 0) {
+      result->push_back(ValueAt(bucket_idx));
+      found = true;
+    }
+  }
+  return found;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::Insert(const VarlenKey &key, ValueType value, uint32_t hash, KeyComparator cmp) {
+  uint8_t fingerprint = Fingerprint(hash);
+  for (uint32_t bucket_idx = 0; bucket_idx < num_slots_; bucket_idx++) {
+    const Slot &slot = slots_[bucket_idx];
+    if (slot.readable_ != 0 && slot.fingerprint_ == fingerprint && CompareAt(bucket_idx, key, cmp) == 0 &&
+        value == ValueAt(bucket_idx)) {
+      return false;
+    }
+  }
+  if (!HasSpaceFor(key)) {
+    return false;
+  }
+  if (FreeSpace() < EntrySize(key)) {
+    Compact();
+  }
+  WriteEntry(num_slots_++, key, value, fingerprint);
+  return true;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::Remove(const VarlenKey &key, ValueType value, uint32_t hash, KeyComparator cmp) {
+  uint8_t fingerprint = Fingerprint(hash);
+  for (uint32_t bucket_idx = 0; bucket_idx < num_slots_; bucket_idx++) {
+    const Slot &slot = slots_[bucket_idx];
+    if (slot.readable_ != 0 && slot.fingerprint_ == fingerprint && CompareAt(bucket_idx, key, cmp) == 0 &&
+        value == ValueAt(bucket_idx)) {
+      RemoveAt(bucket_idx);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::InsertSorted(const VarlenKey &key, ValueType value, uint32_t hash,
+                                                  KeyComparator cmp) {
+  uint32_t insert_idx = LowerBound(key, cmp);
+  for (; insert_idx < num_slots_ && CompareAt(insert_idx, key, cmp) == 0; insert_idx++) {
+    if (value == ValueAt(insert_idx)) {
+      return false;
+    }
+  }
+  if (!HasSpaceFor(key)) {
+    return false;
+  }
+  if (FreeSpace() < EntrySize(key)) {
+    Compact();
+  }
+  memmove(slots_ + insert_idx + 1, slots_ + insert_idx, (num_slots_ - insert_idx) * sizeof(Slot));
+  num_slots_++;
+  WriteEntry(insert_idx, key, value, Fingerprint(hash));
+  return true;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::RemoveSorted(const VarlenKey &key, ValueType value, KeyComparator cmp) {
+  for (uint32_t bucket_idx = LowerBound(key, cmp); bucket_idx < num_slots_ && CompareAt(bucket_idx, key, cmp) == 0;
+       bucket_idx++) {
+    if (value == ValueAt(bucket_idx)) {
+      // the entry's bytes stay behind until the next compaction
+      RemoveAt(bucket_idx);
+      memmove(slots_ + bucket_idx, slots_ + bucket_idx + 1, (num_slots_ - bucket_idx - 1) * sizeof(Slot));
+      num_slots_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+template <typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_SLOTTED_BUCKET_TYPE::LowerBound(const VarlenKey &key, KeyComparator cmp) {
+  uint32_t low = 0;
+  uint32_t high = num_slots_;
+  while (low < high) {
+    uint32_t mid = low + (high - low) / 2;
+    if (CompareAt(mid, key, cmp) < 0) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+template <typename ValueType, typename KeyComparator>
+void HASH_TABLE_SLOTTED_BUCKET_TYPE::Compact() {
+  // Copy the live entries aside first, since packing them may overwrite entries that have not been moved yet.
+  char entries[PAGE_SIZE];
+  char *page = reinterpret_cast<char *>(this);
+  uint32_t num_slots = 0;
+  uint32_t data_size = 0;
+  for (uint32_t bucket_idx = 0; bucket_idx < num_slots_; bucket_idx++) {
+    Slot slot = slots_[bucket_idx];
+    if (slot.readable_ == 0) {
+      continue;
+    }
+    uint32_t entry_size = slot.key_size_ + sizeof(ValueType);
+    data_size += entry_size;
+    memcpy(entries + PAGE_SIZE - data_size, page + slot.offset_, entry_size);
+    slot.offset_ = static_cast<uint16_t>(PAGE_SIZE - data_size);
+    slots_[num_slots++] = slot;
+  }
+  memcpy(page + PAGE_SIZE - data_size, entries + PAGE_SIZE - data_size, data_size);
+  num_slots_ = static_cast<uint16_t>(num_slots);
+  data_size_ = static_cast<uint16_t>(data_size);
+}
+
+template <typename ValueType, typename KeyComparator>
+VarlenKey HASH_TABLE_SLOTTED_BUCKET_TYPE::KeyAt(uint32_t bucket_idx) const {
+  const Slot &slot = slots_[bucket_idx];
+  return VarlenKey(reinterpret_cast<const char *>(this) + slot.offset_, slot.key_size_);
+}
+
+template <typename ValueType, typename KeyComparator>
+ValueType HASH_TABLE_SLOTTED_BUCKET_TYPE::ValueAt(uint32_t bucket_idx) const {
+  const Slot &slot = slots_[bucket_idx];
+  ValueType value;
+  memcpy(&value, reinterpret_cast<const char *>(this) + slot.offset_ + slot.key_size_, sizeof(ValueType));
+  return value;
+}
+
+template <typename ValueType, typename KeyComparator>
+void HASH_TABLE_SLOTTED_BUCKET_TYPE::RemoveAt(uint32_t bucket_idx) {
+  Slot &slot = slots_[bucket_idx];
+  if (slot.readable_ == 0) {
+    return;
+  }
+  slot.readable_ = 0;
+  bytes_used_ -= sizeof(Slot) + slot.key_size_ + sizeof(ValueType);
+  num_readable_--;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::IsOccupied(uint32_t bucket_idx) const {
+  return bucket_idx < num_slots_;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::IsReadable(uint32_t bucket_idx) const {
+  return bucket_idx < num_slots_ && slots_[bucket_idx].readable_ != 0;
+}
+
+template <typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_SLOTTED_BUCKET_TYPE::NumSlots() const {
+  return num_slots_;
+}
+
+template <typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_SLOTTED_BUCKET_TYPE::NumReadable() const {
+  return num_readable_;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::HasSpaceFor(const VarlenKey &key) const {
+  return bytes_used_ + EntrySize(key) <= BytesCapacity();
+}
+
+template <typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_SLOTTED_BUCKET_TYPE::BytesUsed() const {
+  return bytes_used_;
+}
+
+template <typename ValueType, typename KeyComparator>
+bool HASH_TABLE_SLOTTED_BUCKET_TYPE::IsEmpty() const {
+  return num_readable_ == 0;
+}
+
+template <typename ValueType, typename KeyComparator>
+void HASH_TABLE_SLOTTED_BUCKET_TYPE::PrintBucket() const {
+  LOG_INFO("Bucket Capacity: %u bytes, Used: %u bytes, Slots: %u, Taken: %u, Free: %u bytes", BytesCapacity(),
+           BytesUsed(), NumSlots(), NumReadable(), FreeSpace());
+}
+
+template <typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_SLOTTED_BUCKET_TYPE::EntrySize(const VarlenKey &key) {
+  return sizeof(Slot) + key.GetSize() + sizeof(ValueType);
+}
+
+template <typename ValueType, typename KeyComparator>
+uint32_t HASH_TABLE_SLOTTED_BUCKET_TYPE::FreeSpace() const {
+  return PAGE_SIZE - HEADER_SIZE - num_slots_ * sizeof(Slot) - data_size_;
+}
+
+template <typename ValueType, typename KeyComparator>
+int HASH_TABLE_SLOTTED_BUCKET_TYPE::CompareAt(uint32_t bucket_idx, const VarlenKey &key, KeyComparator cmp) const {
+  return cmp(KeyAt(bucket_idx), key);
+}
+
+template <typename ValueType, typename KeyComparator>
+void HASH_TABLE_SLOTTED_BUCKET_TYPE::WriteEntry(uint32_t bucket_idx, const VarlenKey &key, const ValueType &value,
+                                                uint8_t fingerprint) {
+  char *page = reinterpret_cast<char *>(this);
+  data_size_ += key.GetSize() + sizeof(ValueType);
+  uint32_t offset = PAGE_SIZE - data_size_;
+  memcpy(page + offset, key.GetData(), key.GetSize());
+  memcpy(page + offset + key.GetSize(), &value, sizeof(ValueType));
+
+  Slot &slot = slots_[bucket_idx];
+  slot.offset_ = static_cast<uint16_t>(offset);
+  slot.key_size_ = static_cast<uint16_t>(key.GetSize());
+  slot.fingerprint_ = fingerprint;
+  slot.readable_ = 1;
+  bytes_used_ += EntrySize(key);
+  num_readable_++;
+}
+
+template class HashTableSlottedBucketPage<RID, VarlenComparator>;
+
+}  // namespace bustub
@@ -17,6 +17,7 @@
 #include <vector>
 
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -105,6 +106,19 @@ Tuple Tuple::KeyFromTuple(const Schema &schema, const Schema &key_schema, const
   return Tuple(values, &key_schema);
 }
 
+Tuple Tuple::TupleFromKey(const Schema &schema, const Schema &key_schema,
+                          const std::vector<uint32_t> &key_attrs) const {
+  std::vector<Value> values;
+  values.reserve(schema.GetColumnCount());
+  for (const auto &column : schema.GetColumns()) {
+    values.emplace_back(ValueFactory::GetNullValueByType(column.GetType()));
+  }
+  for (uint32_t key_idx = 0; key_idx < key_attrs.size(); key_idx++) {
+    values[key_attrs[key_idx]] = this->GetValue(&key_schema, key_idx);
+  }
+  return Tuple(values, &schema);
+}
+
 const char *Tuple::GetDataPtr(const Schema *schema, const uint32_t column_idx) const {
   assert(schema);
   assert(data_);
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -18,6 +20,9 @@
 #include "catalog/catalog.h"
 #include "catalog/table_generator.h"
 #include "execution/executor_context.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/index_scan_plan.h"
 #include "gtest/gtest.h"
 #include "type/value_factory.h"
 
@@ -298,6 +303,386 @@ TEST(CatalogTest, DISABLED_CreateIndex3) {
   EXPECT_EQ(tuple.GetRid().Get(), index_rid[0].Get());
 }
 
+TEST(CatalogTest, CreateBPlusTreeIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  // the B+ tree records its root in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+
+  Transaction txn{0};
+
+  auto exec_ctx = std::make_unique<ExecutorContext>(&txn, catalog.get(), bpm.get(), nullptr, nullptr);
+
+  TableGenerator gen{exec_ctx.get()};
+  gen.GenerateTestTables();
+
+  auto *table_info = exec_ctx->GetCatalog()->GetTable("test_1");
+  EXPECT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  Schema &schema = table_info->schema_;
+
+  std::vector<Column> key_columns{Column{"colA", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+
+  auto *index_info = catalog->CreateBPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      &txn, "index1", "test_1", schema, key_schema, {0}, BIGINT_SIZE);
+  EXPECT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  // the index name is taken
+  auto *duplicate_info = catalog->CreateBPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      &txn, "index1", "test_1", schema, key_schema, {0}, BIGINT_SIZE);
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, duplicate_info);
+  // the key size has to be the size of the key type
+  auto *mismatched_info = catalog->CreateBPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      &txn, "index2", "test_1", schema, key_schema, {0}, BIGINT_SIZE / 2);
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, mismatched_info);
+
+  // every tuple of the table is in the index
+  size_t num_tuples = 0;
+  for (auto tuple = table_info->table_->Begin(&txn); tuple != table_info->table_->End(); ++tuple) {
+    std::vector<RID> index_rid{};
+    index_info->index_->ScanKey(tuple->KeyFromTuple(schema, key_schema, index_info->index_->GetKeyAttrs()),
+                                &index_rid, &txn);
+    ASSERT_EQ(1, index_rid.size());
+    EXPECT_EQ(tuple->GetRid(), index_rid[0]);
+    num_tuples++;
+  }
+  EXPECT_GT(num_tuples, 0);
+
+  bpm->UnpinPage(header_page_id, true);
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, BPlusTreeIndexScanRange) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  // the B+ tree records its root in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+
+  Transaction txn{0};
+
+  auto exec_ctx = std::make_unique<ExecutorContext>(&txn, catalog.get(), bpm.get(), nullptr, nullptr);
+
+  TableGenerator gen{exec_ctx.get()};
+  gen.GenerateTestTables();
+
+  auto *table_info = exec_ctx->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+
+  std::vector<Column> key_columns{Column{"colA", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+
+  auto *index_info = catalog->CreateBPlusTreeIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      &txn, "index1", "test_1", schema, key_schema, {0}, BIGINT_SIZE);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  // colA counts up from 0, so the range scan returns the tuples with colA in the range in order
+  auto scan = [&](const int32_t *low, bool low_inclusive, const int32_t *high, bool high_inclusive, size_t limit) {
+    std::vector<int32_t> values;
+    Tuple low_key;
+    Tuple high_key;
+    if (low != nullptr) {
+      low_key = Tuple({ValueFactory::GetIntegerValue(*low)}, &key_schema);
+    }
+    if (high != nullptr) {
+      high_key = Tuple({ValueFactory::GetIntegerValue(*high)}, &key_schema);
+    }
+    index_info->index_->ScanRange(
+        low != nullptr ? &low_key : nullptr, low_inclusive, high != nullptr ? &high_key : nullptr, high_inclusive,
+        [&](RID rid) {
+          Tuple tuple;
+          EXPECT_TRUE(table_info->table_->GetTuple(rid, &tuple, &txn));
+          values.push_back(tuple.GetValue(&schema, 0).GetAs<int32_t>());
+          return values.size() < limit;
+        },
+        &txn);
+    return values;
+  };
+  auto range = [](int32_t begin, int32_t end) {
+    std::vector<int32_t> values;
+    for (int32_t value = begin; value < end; value++) {
+      values.push_back(value);
+    }
+    return values;
+  };
+
+  int32_t low = 100;
+  int32_t high = 200;
+  EXPECT_EQ(range(100, 201), scan(&low, true, &high, true, TEST1_SIZE));
+  EXPECT_EQ(range(101, 200), scan(&low, false, &high, false, TEST1_SIZE));
+  EXPECT_EQ(range(100, 110), scan(&low, true, &high, true, 10));
+  EXPECT_EQ(range(0, 201), scan(nullptr, true, &high, true, TEST1_SIZE));
+  EXPECT_EQ(range(100, TEST1_SIZE), scan(&low, true, nullptr, true, TEST1_SIZE));
+  EXPECT_EQ(range(0, TEST1_SIZE), scan(nullptr, true, nullptr, true, TEST1_SIZE));
+  EXPECT_TRUE(scan(&high, true, &low, true, TEST1_SIZE).empty());
+  EXPECT_EQ(range(100, 101), scan(&low, true, &low, true, TEST1_SIZE));
+  EXPECT_TRUE(scan(&low, false, &low, true, TEST1_SIZE).empty());
+
+  bpm->UnpinPage(header_page_id, true);
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, NonUniqueBPlusTreeIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  // the B+ tree records its root in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+
+  Transaction txn{0};
+
+  auto exec_ctx = std::make_unique<ExecutorContext>(&txn, catalog.get(), bpm.get(), nullptr, nullptr);
+
+  TableGenerator gen{exec_ctx.get()};
+  gen.GenerateTestTables();
+
+  auto *table_info = exec_ctx->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+
+  // colB only takes the values 0 to 9, each many times over; the keys leave room for a RID
+  std::vector<Column> key_columns{Column{"colB", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateBPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      &txn, "index1", "test_1", schema, key_schema, {1}, 16, 0.9, false);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  EXPECT_FALSE(index_info->index_->GetMetadata()->IsUnique());
+
+  auto col_b = [&](RID rid) {
+    Tuple tuple;
+    EXPECT_TRUE(table_info->table_->GetTuple(rid, &tuple, &txn));
+    return tuple.GetValue(&schema, 1).GetAs<int32_t>();
+  };
+  auto scan_key = [&](int32_t value) {
+    std::vector<RID> rids;
+    index_info->index_->ScanKey(Tuple({ValueFactory::GetIntegerValue(value)}, &key_schema), &rids, &txn);
+    for (auto rid : rids) {
+      EXPECT_EQ(col_b(rid), value);
+    }
+    return rids;
+  };
+
+  // every tuple is found under its key
+  size_t num_tuples = 0;
+  for (int32_t value = 0; value < 10; value++) {
+    num_tuples += scan_key(value).size();
+  }
+  EXPECT_EQ(num_tuples, TEST1_SIZE);
+
+  // a range scan returns all tuples of each key in the range, key after key
+  Tuple low_key({ValueFactory::GetIntegerValue(3)}, &key_schema);
+  Tuple high_key({ValueFactory::GetIntegerValue(5)}, &key_schema);
+  std::vector<int32_t> values;
+  index_info->index_->ScanRange(
+      &low_key, false, &high_key, true,
+      [&](RID rid) {
+        values.push_back(col_b(rid));
+        return true;
+      },
+      &txn);
+  EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+  EXPECT_EQ(values.size(), scan_key(4).size() + scan_key(5).size());
+  EXPECT_TRUE(values.empty() || values.front() == 4);
+
+  // deleting an entry leaves the other tuples with the same key
+  std::vector<RID> rids = scan_key(7);
+  ASSERT_FALSE(rids.empty());
+  index_info->index_->DeleteEntry(Tuple({ValueFactory::GetIntegerValue(7)}, &key_schema), rids[0], &txn);
+  EXPECT_EQ(scan_key(7).size(), rids.size() - 1);
+
+  // a composite key that fills the key next to the RID keeps keys that differ in their last column apart
+  std::vector<Column> pair_columns{Column{"colB", TypeId::INTEGER}, Column{"colC", TypeId::INTEGER}};
+  Schema pair_schema{pair_columns};
+  auto *pair_info = catalog->CreateBPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      &txn, "index2", "test_1", schema, pair_schema, {1, 2}, 16, 0.9, false);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, pair_info);
+  size_t num_checked = 0;
+  for (auto tuple = table_info->table_->Begin(&txn); num_checked < 100; ++tuple, num_checked++) {
+    rids.clear();
+    pair_info->index_->ScanKey(tuple->KeyFromTuple(schema, pair_schema, {1, 2}), &rids, &txn);
+    EXPECT_NE(std::find(rids.begin(), rids.end(), tuple->GetRid()), rids.end());
+    for (auto rid : rids) {
+      Tuple stored;
+      EXPECT_TRUE(table_info->table_->GetTuple(rid, &stored, &txn));
+      EXPECT_EQ(stored.GetValue(&schema, 1).GetAs<int32_t>(), tuple->GetValue(&schema, 1).GetAs<int32_t>());
+      EXPECT_EQ(stored.GetValue(&schema, 2).GetAs<int32_t>(), tuple->GetValue(&schema, 2).GetAs<int32_t>());
+    }
+  }
+
+  // one more column would be overwritten by the RID, so the index is refused
+  std::vector<Column> triple_columns{Column{"colB", TypeId::INTEGER}, Column{"colC", TypeId::INTEGER},
+                                     Column{"colD", TypeId::INTEGER}};
+  Schema triple_schema{triple_columns};
+  auto *triple_info = catalog->CreateBPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>(
+      &txn, "index3", "test_1", schema, triple_schema, {1, 2, 3}, 16, 0.9, false);
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO, triple_info);
+  using PairIndex = BPlusTreeIndex<GenericKey<16>, RID, GenericComparator<16>>;
+  EXPECT_THROW(PairIndex(std::make_unique<IndexMetadata>("index3", "test_1", &schema, std::vector<uint32_t>{1, 2, 3},
+                                                         false),
+                         bpm.get()),
+               Exception);
+
+  bpm->UnpinPage(header_page_id, true);
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, IndexOnlyScan) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  // the B+ tree records its root in the header page
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+
+  Transaction txn{0};
+
+  auto exec_ctx = std::make_unique<ExecutorContext>(&txn, catalog.get(), bpm.get(), nullptr, nullptr);
+
+  TableGenerator gen{exec_ctx.get()};
+  gen.GenerateTestTables();
+
+  auto *table_info = exec_ctx->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+
+  std::vector<Column> key_columns{Column{"colA", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateBPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>(
+      &txn, "index1", "test_1", schema, key_schema, {0}, 8);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  EXPECT_TRUE(index_info->index_->StoresFullKeys());
+
+  // SELECT colA FROM test_1 WHERE colA < 150 only reads the key column, SELECT colB does not
+  ColumnValueExpression col_a{0, 0, TypeId::INTEGER};
+  ColumnValueExpression col_b{0, 1, TypeId::INTEGER};
+  ConstantValueExpression bound{ValueFactory::GetIntegerValue(150)};
+  ComparisonExpression predicate{&col_a, &bound, ComparisonType::LessThan};
+  ComparisonExpression predicate_b{&col_b, &bound, ComparisonType::LessThan};
+  Schema out_a{{Column{"colA", TypeId::INTEGER, &col_a}}};
+  Schema out_b{{Column{"colB", TypeId::INTEGER, &col_b}}};
+  EXPECT_TRUE(IndexScanPlanNode::IsCovering(&out_a, &predicate, index_info));
+  EXPECT_TRUE(IndexScanPlanNode::IsCovering(&out_a, nullptr, index_info));
+  EXPECT_FALSE(IndexScanPlanNode::IsCovering(&out_b, &predicate, index_info));
+  EXPECT_FALSE(IndexScanPlanNode::IsCovering(&out_a, &predicate_b, index_info));
+
+  // the tuples rebuilt from the keys agree with the table on the key columns, and evaluate the predicate alike
+  Tuple low_key({ValueFactory::GetIntegerValue(100)}, &key_schema);
+  std::vector<int32_t> values;
+  index_info->index_->ScanRangeKeys(
+      &low_key, true, nullptr, true,
+      [&](const Tuple &key, RID rid) {
+        Tuple stored;
+        EXPECT_TRUE(table_info->table_->GetTuple(rid, &stored, &txn));
+        Tuple rebuilt = key.TupleFromKey(schema, key_schema, index_info->index_->GetKeyAttrs());
+        EXPECT_EQ(rebuilt.GetValue(&schema, 0).GetAs<int32_t>(), stored.GetValue(&schema, 0).GetAs<int32_t>());
+        EXPECT_TRUE(rebuilt.GetValue(&schema, 1).IsNull());
+        if (!predicate.Evaluate(&rebuilt, &schema).GetAs<bool>()) {
+          return false;
+        }
+        values.push_back(out_a.GetColumn(0).GetExpr()->Evaluate(&rebuilt, &schema).GetAs<int32_t>());
+        return true;
+      },
+      &txn);
+  std::vector<int32_t> expected(50);
+  std::iota(expected.begin(), expected.end(), 100);
+  EXPECT_EQ(values, expected);
+
+  // a plan node only records the choice
+  IndexScanPlanNode plan{&out_a, &predicate, index_info->index_oid_, {}, {}, true};
+  EXPECT_TRUE(plan.IsIndexOnly());
+  EXPECT_FALSE(IndexScanPlanNode(&out_a, &predicate, index_info->index_oid_).IsIndexOnly());
+
+  // keys that do not fit their key type are stored cut short, and never cover a scan
+  std::vector<Column> wide_columns{Column{"colA", TypeId::INTEGER}, Column{"colB", TypeId::INTEGER}};
+  Schema wide_schema{wide_columns};
+  auto *wide_info = catalog->CreateBPlusTreeIndex<GenericKey<4>, RID, GenericComparator<4>>(
+      &txn, "index2", "test_1", schema, wide_schema, {0, 1}, 4);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, wide_info);
+  EXPECT_FALSE(wide_info->index_->StoresFullKeys());
+  EXPECT_FALSE(IndexScanPlanNode::IsCovering(&out_a, nullptr, wide_info));
+
+  bpm->UnpinPage(header_page_id, true);
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+TEST(CatalogTest, AdaptiveRadixTreeIndex) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+
+  Transaction txn{0};
+
+  auto exec_ctx = std::make_unique<ExecutorContext>(&txn, catalog.get(), bpm.get(), nullptr, nullptr);
+
+  TableGenerator gen{exec_ctx.get()};
+  gen.GenerateTestTables();
+
+  auto *table_info = exec_ctx->GetCatalog()->GetTable("test_1");
+  Schema &schema = table_info->schema_;
+
+  std::vector<Column> key_columns{Column{"colA", TypeId::INTEGER}};
+  Schema key_schema{key_columns};
+  auto *index_info = catalog->CreateAdaptiveRadixTreeIndex(&txn, "index1", "test_1", schema, key_schema, {0});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  EXPECT_EQ(index_info, catalog->GetIndex("index1", "test_1"));
+  EXPECT_EQ(Catalog::NULL_INDEX_INFO,
+            catalog->CreateAdaptiveRadixTreeIndex(&txn, "index1", "test_1", schema, key_schema, {0}));
+
+  auto key = [&](int32_t value) { return Tuple({ValueFactory::GetIntegerValue(value)}, &key_schema); };
+  std::vector<RID> rids;
+  index_info->index_->ScanKey(key(42), &rids, &txn);
+  ASSERT_EQ(rids.size(), 1);
+  Tuple tuple;
+  EXPECT_TRUE(table_info->table_->GetTuple(rids[0], &tuple, &txn));
+  EXPECT_EQ(tuple.GetValue(&schema, 0).GetAs<int32_t>(), 42);
+
+  // the keys come back in order, and whole, so the index covers scans of its key columns
+  Tuple low = key(100);
+  Tuple high = key(200);
+  std::vector<int32_t> values;
+  index_info->index_->ScanRangeKeys(
+      &low, false, &high, true,
+      [&](const Tuple &key, RID rid) {
+        values.push_back(key.GetValue(&key_schema, 0).GetAs<int32_t>());
+        return true;
+      },
+      &txn);
+  std::vector<int32_t> expected(100);
+  std::iota(expected.begin(), expected.end(), 101);
+  EXPECT_EQ(values, expected);
+  ColumnValueExpression col_a{0, 0, TypeId::INTEGER};
+  Schema out_a{{Column{"colA", TypeId::INTEGER, &col_a}}};
+  EXPECT_TRUE(IndexScanPlanNode::IsCovering(&out_a, nullptr, index_info));
+
+  index_info->index_->DeleteEntry(key(42), rids[0], &txn);
+  rids.clear();
+  index_info->index_->ScanKey(key(42), &rids, &txn);
+  EXPECT_TRUE(rids.empty());
+
+  // a non-unique index keeps every tuple of each key
+  std::vector<Column> b_columns{Column{"colB", TypeId::INTEGER}};
+  Schema b_schema{b_columns};
+  auto *b_info = catalog->CreateAdaptiveRadixTreeIndex(&txn, "index2", "test_1", schema, b_schema, {1}, false);
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, b_info);
+  size_t num_tuples = 0;
+  b_info->index_->ScanRange(
+      nullptr, true, nullptr, true,
+      [&](RID rid) {
+        num_tuples++;
+        return true;
+      },
+      &txn);
+  EXPECT_EQ(num_tuples, TEST1_SIZE);
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 // Vanilla index queries by name
 TEST(CatalogTest, DISABLED_QueryIndex1) {
   auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
@@ -0,0 +1,134 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_util_test.cpp
+//
+// Identification: test/common/hash_util_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/logger.h"
+#include "common/util/hash_util.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static const std::vector<std::pair<HashAlgorithm, std::string>> ALGORITHMS = {
+    {HashAlgorithm::ROTATE_XOR, "ROTATE_XOR"},
+    {HashAlgorithm::MURMUR3, "MURMUR3"},
+    {HashAlgorithm::WYHASH, "WYHASH"},
+    {HashAlgorithm::CRC32C, "CRC32C"},
+};
+
+// chi-square statistic of sequential 8-byte keys spread over 2^bits buckets by the low or high bits of the hash
+static double ChiSquare(HashAlgorithm algorithm, bool high_bits) {
+  const int bits = 10;
+  const int num_buckets = 1 << bits;
+  const int num_keys = 64 * num_buckets;
+  std::vector<int> counts(num_buckets, 0);
+  for (int64_t key = 0; key < num_keys; key++) {
+    hash_t hash = HashUtil::HashBytes(algorithm, reinterpret_cast<const char *>(&key), sizeof(key));
+    counts[high_bits ? hash >> (64 - bits) : hash & (num_buckets - 1)]++;
+  }
+  double expected = static_cast<double>(num_keys) / num_buckets;
+  double chi_square = 0;
+  for (int count : counts) {
+    chi_square += (count - expected) * (count - expected) / expected;
+  }
+  return chi_square;
+}
+
+// worst deviation from 1/2 of the probability that flipping one input bit flips one output bit, over all bit pairs
+static double AvalancheBias(HashAlgorithm algorithm) {
+  const int num_samples = 2000;
+  std::mt19937_64 rng(15445);
+  std::vector<std::vector<int>> flips(64, std::vector<int>(64, 0));
+  for (int sample = 0; sample < num_samples; sample++) {
+    uint64_t key = rng();
+    hash_t hash = HashUtil::HashBytes(algorithm, reinterpret_cast<const char *>(&key), sizeof(key));
+    for (int in_bit = 0; in_bit < 64; in_bit++) {
+      uint64_t flipped_key = key ^ (uint64_t{1} << in_bit);
+      hash_t diff =
+          hash ^ HashUtil::HashBytes(algorithm, reinterpret_cast<const char *>(&flipped_key), sizeof(flipped_key));
+      for (int out_bit = 0; out_bit < 64; out_bit++) {
+        flips[in_bit][out_bit] += (diff >> out_bit) & 1;
+      }
+    }
+  }
+  double worst = 0;
+  for (const auto &row : flips) {
+    for (int count : row) {
+      worst = std::max(worst, std::fabs(static_cast<double>(count) / num_samples - 0.5));
+    }
+  }
+  return worst;
+}
+
+TEST(HashUtilTest, QualityTest) {
+  for (const auto &[algorithm, name] : ALGORITHMS) {
+    double low = ChiSquare(algorithm, false);
+    double high = ChiSquare(algorithm, true);
+    double bias = AvalancheBias(algorithm);
+    LOG_INFO("%-10s chi-square low bits: %10.1f, high bits: %10.1f, worst avalanche bias: %.3f", name.c_str(), low,
+             high, bias);
+    if (algorithm != HashAlgorithm::ROTATE_XOR) {
+      // 1023 degrees of freedom: mean 1023, standard deviation ~45
+      EXPECT_LT(low, 1300) << name;
+      EXPECT_LT(high, 1300) << name;
+    }
+  }
+  EXPECT_LT(AvalancheBias(HashUtil::DEFAULT_HASH_ALGORITHM), 0.1);
+}
+
+TEST(HashUtilTest, DISABLED_ThroughputTest) {
+  const int num_hashes = 1000000;
+  std::vector<char> data(64 + num_hashes);
+  std::mt19937 rng(15445);
+  for (auto &byte : data) {
+    byte = static_cast<char>(rng());
+  }
+
+  for (size_t key_size : {8, 64}) {
+    for (const auto &[algorithm, name] : ALGORITHMS) {
+      hash_t sink = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < num_hashes; i++) {
+        sink ^= HashUtil::HashBytes(algorithm, data.data() + i, key_size);
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      LOG_INFO("%-10s %2zu-byte keys: %6.1f M hashes/sec (%lx)", name.c_str(), key_size,
+               num_hashes / elapsed.count() / 1e6, sink);
+    }
+  }
+}
+
+TEST(HashUtilTest, HashValueTest) {
+  // equal values hash equally, and the varchar hash only depends on the string contents
+  Value forty_two = ValueFactory::GetIntegerValue(42);
+  Value also_forty_two = ValueFactory::GetIntegerValue(42);
+  Value forty_three = ValueFactory::GetIntegerValue(43);
+  EXPECT_EQ(HashUtil::HashValue(&forty_two), HashUtil::HashValue(&also_forty_two));
+  EXPECT_NE(HashUtil::HashValue(&forty_two), HashUtil::HashValue(&forty_three));
+  std::string str = "hello world";
+  Value a = ValueFactory::GetVarcharValue(str);
+  Value b = ValueFactory::GetVarcharValue(str);
+  EXPECT_EQ(HashUtil::HashValue(&a), HashUtil::HashValue(&b));
+
+  // combining is order-dependent, summing is not
+  hash_t l = HashUtil::HashValue(&a);
+  hash_t r = HashUtil::HashValue(&forty_two);
+  EXPECT_NE(HashUtil::CombineHashes(l, r), HashUtil::CombineHashes(r, l));
+  EXPECT_EQ(HashUtil::SumHashes(l, r), HashUtil::SumHashes(r, l));
+}
+
+}  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_table_concurrent_test.cpp
+//
+// Identification: test/container/hash_table_concurrent_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "container/hash/extendible_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+// helper function to launch multiple threads
+template <typename... Args>
+void LaunchParallelTest(uint64_t num_threads, Args &&... args) {
+  std::vector<std::thread> thread_group;
+
+  // Launch a group of threads
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    thread_group.push_back(std::thread(args..., thread_itr));
+  }
+
+  // Join the threads with the main thread
+  for (uint64_t thread_itr = 0; thread_itr < num_threads; ++thread_itr) {
+    thread_group[thread_itr].join();
+  }
+}
+
+// helper function to insert the keys owned by one thread
+void InsertHelperSplit(ExtendibleHashTable<int, int, IntComparator> *ht, int num_keys, int total_threads,
+                       uint64_t thread_itr) {
+  for (int key = 0; key < num_keys; key++) {
+    if (static_cast<uint64_t>(key) % total_threads == thread_itr) {
+      EXPECT_TRUE(ht->Insert(nullptr, key, key));
+    }
+  }
+}
+
+// helper function to delete the keys owned by one thread
+void DeleteHelperSplit(ExtendibleHashTable<int, int, IntComparator> *ht, int num_keys, int total_threads,
+                       uint64_t thread_itr) {
+  for (int key = 0; key < num_keys; key++) {
+    if (static_cast<uint64_t>(key) % total_threads == thread_itr) {
+      EXPECT_TRUE(ht->Remove(nullptr, key, key));
+    }
+  }
+}
+
+// helper function to look up every key, from every thread
+void LookupHelper(ExtendibleHashTable<int, int, IntComparator> *ht, int num_keys,
+                  __attribute__((unused)) uint64_t thread_itr = 0) {
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    ht->GetValue(nullptr, key, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to find " << key;
+  }
+}
+
+TEST(HashTableConcurrentTest, InsertTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_keys = 10000;
+  LaunchParallelTest(4, InsertHelperSplit, &ht, num_keys, 4);
+  ht.VerifyIntegrity();
+  LookupHelper(&ht, num_keys);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableConcurrentTest, MixTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // insert everything, then concurrently read and delete disjoint halves of the key space
+  const int num_keys = 10000;
+  LaunchParallelTest(4, InsertHelperSplit, &ht, num_keys, 4);
+  std::thread reader([&ht] {
+    for (int key = num_keys; key < 2 * num_keys; key++) {
+      std::vector<int> res;
+      ht.GetValue(nullptr, key, &res);
+      EXPECT_EQ(0, res.size());
+    }
+  });
+  LaunchParallelTest(4, DeleteHelperSplit, &ht, num_keys, 4);
+  reader.join();
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableConcurrentTest, DISABLED_ThroughputTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  const int num_keys = 10000;
+  LaunchParallelTest(4, InsertHelperSplit, &ht, num_keys, 4);
+
+  for (uint64_t num_threads : {1, 2, 4, 8}) {
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(num_threads, LookupHelper, &ht, num_keys);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("%lu reader threads: %.0f lookups/sec", num_threads, num_threads * num_keys / elapsed.count());
+  }
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
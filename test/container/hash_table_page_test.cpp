@@ -10,20 +10,33 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
+#include <functional>
+#include <string>
 #include <thread>  // NOLINT
 #include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "common/logger.h"
+#include "container/hash/hash_function.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/hash_table_bucket_page.h"
 #include "storage/page/hash_table_directory_page.h"
+#include "storage/page/hash_table_slotted_bucket_page.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
+// the hash of a key that the directory picks its bucket by, and passes down to it
+template <typename KeyType>
+static uint32_t DirectoryHash(const KeyType &key) {
+  return static_cast<uint32_t>(HashFunction<KeyType>().GetHash(key));
+}
+
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
+TEST(HashTablePageTest, DirectoryPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -57,7 +70,7 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
 }
 
 // NOLINTNEXTLINE
-TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
+TEST(HashTablePageTest, BucketPageSampleTest) {
   DiskManager *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
 
@@ -69,7 +82,7 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
 
   // insert a few (key, value) pairs
   for (unsigned i = 0; i < 10; i++) {
-    assert(bucket_page->Insert(i, i, IntComparator()));
+    assert(bucket_page->Insert(i, i, DirectoryHash(i), IntComparator()));
   }
 
   // check for the inserted pairs
@@ -81,7 +94,7 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   // remove a few pairs
   for (unsigned i = 0; i < 10; i++) {
     if (i % 2 == 1) {
-      assert(bucket_page->Remove(i, i, IntComparator()));
+      assert(bucket_page->Remove(i, i, DirectoryHash(i), IntComparator()));
     }
   }
 
@@ -102,7 +115,7 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   // try to remove the already-removed pairs
   for (unsigned i = 0; i < 10; i++) {
     if (i % 2 == 1) {
-      assert(!bucket_page->Remove(i, i, IntComparator()));
+      assert(!bucket_page->Remove(i, i, DirectoryHash(i), IntComparator()));
     }
   }
 
@@ -114,4 +127,204 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   delete bpm;
 }
 
+TEST(HashTablePageTest, SortedBucketPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<int, int, IntComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+
+  // insert keys out of order, two values per key
+  const int num_keys = 100;
+  for (int i = 0; i < num_keys; i++) {
+    int key = (i * 37) % num_keys;
+    EXPECT_TRUE(bucket_page->InsertSorted(key, key, DirectoryHash(key), IntComparator()));
+    EXPECT_TRUE(bucket_page->InsertSorted(key, -key - 1, DirectoryHash(key), IntComparator()));
+  }
+  EXPECT_FALSE(bucket_page->InsertSorted(5, 5, DirectoryHash(5), IntComparator()));
+
+  // entries fill a prefix of the bucket in key order, equal keys in insertion order
+  EXPECT_EQ(2 * num_keys, bucket_page->NumReadable());
+  for (int i = 0; i < 2 * num_keys; i++) {
+    EXPECT_TRUE(bucket_page->IsReadable(i));
+    EXPECT_EQ(i / 2, bucket_page->KeyAt(i));
+    EXPECT_EQ(i % 2 == 0 ? i / 2 : -i / 2 - 1, bucket_page->ValueAt(i));
+  }
+  EXPECT_EQ(20, bucket_page->LowerBound(10, IntComparator()));
+  EXPECT_EQ(2 * num_keys, bucket_page->LowerBound(num_keys, IntComparator()));
+
+  // sorted removes keep the prefix dense, and fingerprinted lookups still work
+  for (int key = 0; key < num_keys; key += 2) {
+    EXPECT_TRUE(bucket_page->RemoveSorted(key, key, IntComparator()));
+  }
+  EXPECT_FALSE(bucket_page->RemoveSorted(0, 0, IntComparator()));
+  EXPECT_EQ(3 * num_keys / 2, bucket_page->NumReadable());
+  for (int i = 1; i < 3 * num_keys / 2; i++) {
+    EXPECT_LE(bucket_page->KeyAt(i - 1), bucket_page->KeyAt(i));
+  }
+  std::vector<int> res;
+  EXPECT_TRUE(bucket_page->GetValue(4, DirectoryHash(4), IntComparator(), &res));
+  EXPECT_EQ(std::vector<int>{-5}, res);
+
+  // compaction after unsorted removes restores a dense sorted prefix
+  for (uint32_t i = 0; i < bucket_page->NumReadable(); i += 3) {
+    bucket_page->RemoveAt(i);
+  }
+  bucket_page->Compact();
+  uint32_t num_readable = bucket_page->NumReadable();
+  for (uint32_t i = 0; i < num_readable; i++) {
+    EXPECT_TRUE(bucket_page->IsReadable(i));
+    if (i > 0) {
+      EXPECT_LE(bucket_page->KeyAt(i - 1), bucket_page->KeyAt(i));
+    }
+  }
+  EXPECT_FALSE(bucket_page->IsReadable(num_readable));
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+static VarlenKey MakeVarlenKey(const std::string &str, Schema *key_schema) {
+  VarlenKey key;
+  key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(str)}, key_schema));
+  return key;
+}
+
+TEST(HashTablePageTest, SlottedBucketPageTest) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+  auto key_schema = ParseCreateStatement("a varchar(256)");
+  VarlenComparator cmp(key_schema.get());
+
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableSlottedBucketPage<RID, VarlenComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+
+  // keys of different lengths, all longer than the widest GenericKey and differing only in their last bytes
+  auto key_of = [&](int i) {
+    return MakeVarlenKey(std::string(64 + i % 50, 'k') + std::to_string(i), key_schema.get());
+  };
+  int num_keys = 0;
+  while (bucket_page->HasSpaceFor(key_of(num_keys))) {
+    EXPECT_TRUE(bucket_page->Insert(key_of(num_keys), RID(0, num_keys), DirectoryHash(key_of(num_keys)), cmp));
+    num_keys++;
+  }
+  EXPECT_GT(num_keys, 20);
+  EXPECT_FALSE(bucket_page->Insert(key_of(num_keys), RID(0, num_keys), DirectoryHash(key_of(num_keys)), cmp));
+  EXPECT_FALSE(bucket_page->Insert(key_of(0), RID(0, 0), DirectoryHash(key_of(0)), cmp));
+  EXPECT_EQ(num_keys, bucket_page->NumReadable());
+  EXPECT_LE(bucket_page->BytesUsed(), bucket_page->BytesCapacity());
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    EXPECT_TRUE(bucket_page->GetValue(key_of(i), DirectoryHash(key_of(i)), cmp, &res));
+    EXPECT_EQ(std::vector<RID>{RID(0, i)}, res);
+    EXPECT_EQ(0, cmp(key_of(i), bucket_page->KeyAt(i)));
+  }
+
+  // removed entries leave tombstones, whose space is reclaimed once a longer key needs it
+  for (int i = 0; i < num_keys; i += 2) {
+    EXPECT_TRUE(bucket_page->Remove(key_of(i), RID(0, i), DirectoryHash(key_of(i)), cmp));
+  }
+  EXPECT_FALSE(bucket_page->Remove(key_of(0), RID(0, 0), DirectoryHash(key_of(0)), cmp));
+  EXPECT_TRUE(bucket_page->IsOccupied(0));
+  EXPECT_FALSE(bucket_page->IsReadable(0));
+  VarlenKey long_key = MakeVarlenKey(std::string(1000, 'l'), key_schema.get());
+  EXPECT_TRUE(bucket_page->Insert(long_key, RID(1, 0), DirectoryHash(long_key), cmp));
+  EXPECT_FALSE(bucket_page->Fits(MakeVarlenKey(std::string(PAGE_SIZE, 'h'), key_schema.get())));
+  EXPECT_EQ(num_keys / 2 + 1, bucket_page->NumReadable());
+  for (int i = 1; i < num_keys; i += 2) {
+    std::vector<RID> res;
+    EXPECT_TRUE(bucket_page->GetValue(key_of(i), DirectoryHash(key_of(i)), cmp, &res));
+    EXPECT_EQ(std::vector<RID>{RID(0, i)}, res);
+  }
+  std::vector<RID> res;
+  EXPECT_TRUE(bucket_page->GetValue(long_key, DirectoryHash(long_key), cmp, &res));
+  EXPECT_FALSE(bucket_page->GetValue(key_of(0), DirectoryHash(key_of(0)), cmp, &res));
+  EXPECT_EQ(1, res.size());
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+
+  // sorted buckets keep their slots in key order
+  bucket_page = reinterpret_cast<HashTableSlottedBucketPage<RID, VarlenComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+  for (int i = 0; i < 20; i++) {
+    int key = (i * 7) % 20;
+    EXPECT_TRUE(bucket_page->InsertSorted(key_of(key), RID(0, key), DirectoryHash(key_of(key)), cmp));
+  }
+  for (int i = 0; i < 20; i += 3) {
+    EXPECT_TRUE(bucket_page->RemoveSorted(key_of(i), RID(0, i), cmp));
+  }
+  EXPECT_EQ(bucket_page->NumSlots(), bucket_page->NumReadable());
+  for (uint32_t i = 1; i < bucket_page->NumSlots(); i++) {
+    EXPECT_LT(cmp(bucket_page->KeyAt(i - 1), bucket_page->KeyAt(i)), 0);
+  }
+  EXPECT_EQ(0, cmp(key_of(1), bucket_page->KeyAt(bucket_page->LowerBound(key_of(1), cmp))));
+
+  bpm->UnpinPage(bucket_page_id, true, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// fill a bucket, then time point lookups that hit and miss
+template <typename KeyType, typename ValueType, typename KeyComparator>
+void BucketLookupBenchmark(const char *name, KeyComparator cmp, const std::function<KeyType(int)> &make_key,
+                           const std::function<ValueType(int)> &make_value, int num_lookups) {
+  DiskManager *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+  page_id_t bucket_page_id = INVALID_PAGE_ID;
+  auto bucket_page = reinterpret_cast<HashTableBucketPage<KeyType, ValueType, KeyComparator> *>(
+      bpm->NewPage(&bucket_page_id, nullptr)->GetData());
+
+  int num_keys = 0;
+  while (!bucket_page->IsFull()) {
+    KeyType key = make_key(num_keys);
+    ASSERT_TRUE(bucket_page->Insert(key, make_value(num_keys), DirectoryHash(key), cmp));
+    num_keys++;
+  }
+
+  size_t num_found = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_lookups; i++) {
+    std::vector<ValueType> result;
+    // every other lookup is for a key that was never inserted
+    KeyType key = make_key(i % 2 == 0 ? i % num_keys : num_keys + i);
+    bucket_page->GetValue(key, DirectoryHash(key), cmp, &result);
+    num_found += result.size();
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_EQ(num_lookups / 2, num_found);
+  LOG_INFO("%s: %d slots, %.0f lookups/sec", name, num_keys, num_lookups / elapsed.count());
+
+  bpm->UnpinPage(bucket_page_id, false, nullptr);
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+void BucketPageLookups(int num_lookups) {
+  BucketLookupBenchmark<int, int, IntComparator>(
+      "int", IntComparator(), [](int i) { return i; }, [](int i) { return i; }, num_lookups);
+
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  BucketLookupBenchmark<GenericKey<8>, RID, GenericComparator<8>>(
+      "GenericKey<8>", comparator,
+      [](int i) {
+        GenericKey<8> key;
+        key.SetFromInteger(i);
+        return key;
+      },
+      [](int i) { return RID(0, i); }, num_lookups);
+}
+
+TEST(HashTablePageTest, BucketPageLookupTest) { BucketPageLookups(1000); }
+
+TEST(HashTablePageTest, DISABLED_BucketPageLookupBenchmark) { BucketPageLookups(100000); }
+
 }  // namespace bustub
@@ -18,13 +18,15 @@
 #include "container/hash/extendible_hash_table.h"
 #include "gtest/gtest.h"
 #include "murmur3/MurmurHash3.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
 
 namespace bustub {
 
 // NOLINTNEXTLINE
 
 // NOLINTNEXTLINE
-TEST(HashTableTest, DISABLED_SampleTest) {
+TEST(HashTableTest, SampleTest) {
   auto *disk_manager = new DiskManager("test.db");
   auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
   ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
@@ -117,4 +119,283 @@ TEST(HashTableTest, DISABLED_SampleTest) {
   delete bpm;
 }
 
+TEST(HashTableTest, MultiPageDirectoryTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<64> comparator(key_schema.get());
+  ExtendibleHashTable<GenericKey<64>, RID, GenericComparator<64>> ht("blah", bpm, comparator,
+                                                                     HashFunction<GenericKey<64>>());
+
+  // wide keys keep buckets small, so the directory outgrows a single directory page
+  const int64_t num_keys = 40000;
+  GenericKey<64> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(ht.Insert(nullptr, index_key, RID(0, key)));
+  }
+  EXPECT_GT(ht.GetGlobalDepth(), DIRECTORY_ARRAY_DEPTH);
+  ht.VerifyIntegrity();
+
+  for (int64_t key = 0; key < num_keys; key++) {
+    std::vector<RID> res;
+    index_key.SetFromInteger(key);
+    ht.GetValue(nullptr, index_key, &res);
+    ASSERT_EQ(1, res.size()) << "Failed to find " << key;
+    EXPECT_EQ(key, res[0].GetSlotNum());
+  }
+
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(ht.Remove(nullptr, index_key, RID(0, key)));
+  }
+  EXPECT_LE(ht.GetGlobalDepth(), DIRECTORY_ARRAY_DEPTH);
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+// Fills the first bucket until it splits, then repeatedly removes and re-inserts the key that caused the split.
+static ExtendibleHashTableStats SplitBoundaryWorkload(const ExtendibleHashTableOptions &options) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>(), options);
+
+  int key = 0;
+  while (ht.GetStats().num_splits_ == 0) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+    key++;
+  }
+  int boundary_key = key - 1;
+  for (int i = 0; i < 100; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, boundary_key, boundary_key));
+    EXPECT_TRUE(ht.Insert(nullptr, boundary_key, boundary_key));
+  }
+  ht.VerifyIntegrity();
+  ExtendibleHashTableStats stats = ht.GetStats();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+  return stats;
+}
+
+TEST(HashTableTest, MergeHysteresisTest) {
+  // a pair that only just overflowed one bucket stays split under the default policy
+  ExtendibleHashTableStats stats = SplitBoundaryWorkload(ExtendibleHashTableOptions());
+  EXPECT_EQ(1, stats.num_splits_);
+  EXPECT_EQ(0, stats.num_merges_);
+
+  // merging whenever the pair fits in one bucket splits and merges on every iteration
+  ExtendibleHashTableOptions eager;
+  eager.merge_threshold_ = 1.0;
+  eager.shrink_margin_ = 1;
+  stats = SplitBoundaryWorkload(eager);
+  EXPECT_EQ(101, stats.num_splits_);
+  EXPECT_EQ(100, stats.num_merges_);
+  EXPECT_EQ(101, stats.num_directory_grows_);
+  EXPECT_EQ(100, stats.num_directory_shrinks_);
+}
+
+TEST(HashTableTest, ShrinkMarginTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTableOptions options;
+  options.shrink_margin_ = 3;
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>(), options);
+
+  const int num_keys = 20000;
+  for (int key = 0; key < num_keys; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+  ExtendibleHashTableStats stats = ht.GetStats();
+  EXPECT_EQ(ht.GetGlobalDepth(), stats.num_directory_grows_);
+  EXPECT_EQ(0, stats.num_merges_);
+
+  for (int key = 0; key < num_keys; key++) {
+    EXPECT_TRUE(ht.Remove(nullptr, key, key));
+  }
+  stats = ht.GetStats();
+  EXPECT_GT(stats.num_merges_, 0);
+  EXPECT_GT(stats.num_directory_shrinks_, 0);
+  // whenever the directory shrinks it keeps shrink_margin_ - 1 spare levels
+  EXPECT_GE(ht.GetGlobalDepth(), 2);
+  EXPECT_EQ(ht.GetGlobalDepth(), stats.num_directory_grows_ - stats.num_directory_shrinks_);
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, UnsplittableBucketTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>());
+
+  // a bucket filled with a single key cannot be split apart, so it stays put once full
+  int num_values = 0;
+  while (ht.Insert(nullptr, 0, num_values)) {
+    num_values++;
+  }
+  EXPECT_GT(num_values, 0);
+  EXPECT_FALSE(ht.Insert(nullptr, 0, 0));
+  EXPECT_EQ(0, ht.GetGlobalDepth());
+  EXPECT_EQ(0, ht.GetStats().num_splits_);
+
+  // another key still splits the bucket, and takes none of the full key's values along
+  EXPECT_TRUE(ht.Insert(nullptr, 1, 1));
+  EXPECT_GT(ht.GetStats().num_splits_, 0);
+  std::vector<int> res;
+  ht.GetValue(nullptr, 0, &res);
+  EXPECT_EQ(num_values, res.size());
+  ht.VerifyIntegrity();
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, IteratorTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  ExtendibleHashTableOptions options;
+  options.sorted_buckets_ = true;
+  ExtendibleHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), HashFunction<int>(), options);
+
+  const int num_keys = 5000;
+  for (int key = 0; key < num_keys; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+  for (int key = 0; key < num_keys; key += 5) {
+    EXPECT_TRUE(ht.Remove(nullptr, key, key));
+  }
+  ht.VerifyIntegrity();
+  std::vector<int> res;
+  EXPECT_TRUE(ht.GetValue(nullptr, 1, &res));
+  EXPECT_FALSE(ht.GetValue(nullptr, 5, &res));
+
+  // a full scan returns every entry exactly once, in key order within each bucket
+  std::vector<int> seen(num_keys, 0);
+  int num_out_of_order = 0;
+  int prev_key = -1;
+  for (auto iter = ht.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ((*iter).first, (*iter).second);
+    seen[(*iter).first]++;
+    num_out_of_order += static_cast<int>((*iter).first < prev_key);
+    prev_key = (*iter).first;
+  }
+  for (int key = 0; key < num_keys; key++) {
+    EXPECT_EQ(key % 5 == 0 ? 0 : 1, seen[key]) << "Wrong count for " << key;
+  }
+  // every new bucket restarts the key order, so there is at most one descent per bucket
+  EXPECT_LT(num_out_of_order, 1 << ht.GetGlobalDepth());
+
+  // partitions cover the directory between them
+  const uint32_t num_partitions = 3;
+  std::fill(seen.begin(), seen.end(), 0);
+  for (uint32_t partition = 0; partition < num_partitions; partition++) {
+    for (auto iter = ht.Begin(partition, num_partitions); !iter.IsEnd(); ++iter) {
+      seen[(*iter).first]++;
+    }
+  }
+  for (int key = 0; key < num_keys; key++) {
+    EXPECT_EQ(key % 5 == 0 ? 0 : 1, seen[key]) << "Wrong count for " << key;
+  }
+
+  // range scans only return keys within the bounds
+  int num_in_range = 0;
+  for (auto iter = ht.Begin(1000, 1999); !iter.IsEnd(); ++iter) {
+    EXPECT_GE((*iter).first, 1000);
+    EXPECT_LE((*iter).first, 1999);
+    num_in_range++;
+  }
+  EXPECT_EQ(800, num_in_range);
+
+  // merges keep buckets sorted too
+  for (int key = 0; key < 4 * num_keys / 5; key++) {
+    EXPECT_EQ(key % 5 != 0, ht.Remove(nullptr, key, key));
+  }
+  EXPECT_GT(ht.GetStats().num_merges_, 0);
+  std::fill(seen.begin(), seen.end(), 0);
+  num_out_of_order = 0;
+  prev_key = -1;
+  for (auto iter = ht.Begin(); !iter.IsEnd(); ++iter) {
+    seen[(*iter).first]++;
+    num_out_of_order += static_cast<int>((*iter).first < prev_key);
+    prev_key = (*iter).first;
+  }
+  for (int key = 0; key < num_keys; key++) {
+    EXPECT_EQ(key >= 4 * num_keys / 5 && key % 5 != 0 ? 1 : 0, seen[key]) << "Wrong count for " << key;
+  }
+  EXPECT_LT(num_out_of_order, 1 << ht.GetGlobalDepth());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(HashTableTest, VarlenKeyTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  auto key_schema = ParseCreateStatement("a varchar(300)");
+  VarlenComparator cmp(key_schema.get());
+  ExtendibleHashTable<VarlenKey, RID, VarlenComparator> ht("blah", bpm, cmp, HashFunction<VarlenKey>());
+
+  // long keys that only differ past the first 64 bytes, which a GenericKey<64> would cut off
+  auto key_of = [&](int i) {
+    VarlenKey key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(std::string(64 + i % 200, 'k') + std::to_string(i))},
+                         key_schema.get()));
+    return key;
+  };
+  const int num_keys = 3000;
+  for (int i = 0; i < num_keys; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key_of(i), RID(0, i)));
+  }
+  EXPECT_FALSE(ht.Insert(nullptr, key_of(0), RID(0, 0)));
+  EXPECT_GT(ht.GetStats().num_splits_, 0);
+  ht.VerifyIntegrity();
+  for (int i = 0; i < num_keys; i++) {
+    std::vector<RID> res;
+    EXPECT_TRUE(ht.GetValue(nullptr, key_of(i), &res));
+    EXPECT_EQ(std::vector<RID>{RID(0, i)}, res) << "Wrong result for " << i;
+  }
+
+  // an entry larger than a page can never fit, so its bucket is not split in vain
+  VarlenKey huge_key;
+  huge_key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(std::string(PAGE_SIZE, 'h'))}, key_schema.get()));
+  uint64_t num_splits = ht.GetStats().num_splits_;
+  EXPECT_FALSE(ht.Insert(nullptr, huge_key, RID(1, 0)));
+  EXPECT_EQ(num_splits, ht.GetStats().num_splits_);
+
+  // removing most of the keys merges buckets by the bytes they hold
+  for (int i = 0; i < num_keys; i++) {
+    if (i % 10 != 0) {
+      EXPECT_TRUE(ht.Remove(nullptr, key_of(i), RID(0, i)));
+    }
+  }
+  EXPECT_GT(ht.GetStats().num_merges_, 0);
+  ht.VerifyIntegrity();
+  int num_entries = 0;
+  for (auto iter = ht.Begin(); !iter.IsEnd(); ++iter) {
+    EXPECT_EQ(0, (*iter).second.GetSlotNum() % 10);
+    EXPECT_EQ(0, cmp((*iter).first, key_of((*iter).second.GetSlotNum())));
+    num_entries++;
+  }
+  EXPECT_EQ(num_keys / 10, num_entries);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
 }  // namespace bustub
@@ -0,0 +1,254 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// linear_probe_hash_table_test.cpp
+//
+// Identification: test/container/linear_probe_hash_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "container/hash/linear_probe_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LinearProbeHashTableTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1000, HashFunction<int>());
+
+  // insert a few values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Insert(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to insert " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // check if the inserted values are all there
+  for (int i = 0; i < 5; i++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to keep " << i << std::endl;
+    EXPECT_EQ(i, res[0]);
+  }
+
+  // insert one more value for each key
+  for (int i = 0; i < 5; i++) {
+    if (i == 0) {
+      // duplicate values for the same key are not allowed
+      EXPECT_FALSE(ht.Insert(nullptr, i, 2 * i));
+    } else {
+      EXPECT_TRUE(ht.Insert(nullptr, i, 2 * i));
+    }
+    ht.Insert(nullptr, i, 2 * i);
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      // duplicate values for the same key are not allowed
+      EXPECT_EQ(1, res.size());
+      EXPECT_EQ(i, res[0]);
+    } else {
+      EXPECT_EQ(2, res.size());
+    }
+  }
+
+  // look for a key that does not exist
+  std::vector<int> res;
+  ht.GetValue(nullptr, 20, &res);
+  EXPECT_EQ(0, res.size());
+
+  // delete some values
+  for (int i = 0; i < 5; i++) {
+    EXPECT_TRUE(ht.Remove(nullptr, i, i));
+    std::vector<int> res;
+    ht.GetValue(nullptr, i, &res);
+    if (i == 0) {
+      // (0, 0) is the only pair with key 0
+      EXPECT_EQ(0, res.size());
+    } else {
+      EXPECT_EQ(1, res.size());
+      EXPECT_EQ(2 * i, res[0]);
+    }
+  }
+  EXPECT_FALSE(ht.Remove(nullptr, 0, 0));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(LinearProbeHashTableTest, IncrementalResizeTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+  size_t initial_size = ht.GetSize();
+
+  // every key must stay visible while the table grows, including in the middle of migrating to a new table
+  const int num_keys = 20000;
+  int num_checks_while_resizing = 0;
+  double max_insert_us = 0;
+  for (int key = 0; key < num_keys; key++) {
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    max_insert_us = std::max(max_insert_us, elapsed.count());
+
+    if (ht.IsResizing() && key % 97 == 0) {
+      num_checks_while_resizing++;
+      for (int prev_key = 0; prev_key <= key; prev_key++) {
+        std::vector<int> res;
+        ht.GetValue(nullptr, prev_key, &res);
+        ASSERT_EQ(1, res.size()) << "Failed to find " << prev_key << " while resizing";
+      }
+    }
+  }
+  EXPECT_GT(num_checks_while_resizing, 0);
+  EXPECT_GT(ht.GetSize(), initial_size);
+  EXPECT_GE(ht.GetSize() * 3, num_keys * 4);
+  LOG_INFO("grew from %zu to %zu slots, slowest insert took %.0f us", initial_size, ht.GetSize(), max_insert_us);
+
+  // removing keys also advances the migration
+  for (int key = 0; key < num_keys; key += 2) {
+    EXPECT_TRUE(ht.Remove(nullptr, key, key));
+  }
+  EXPECT_FALSE(ht.IsResizing());
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    EXPECT_EQ(key % 2, res.size()) << "Wrong result for " << key;
+  }
+
+  // an explicit resize is migrated by later operations as well
+  size_t size = ht.GetSize();
+  ht.Resize(size);
+  EXPECT_TRUE(ht.IsResizing());
+  EXPECT_EQ(2 * size, ht.GetSize());
+  for (int key = 0; key < num_keys; key += 2) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+  }
+  EXPECT_FALSE(ht.IsResizing());
+  for (int key = 0; key < num_keys; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    EXPECT_EQ(1, res.size()) << "Failed to find " << key;
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(LinearProbeHashTableTest, ChurnTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+
+  // keep the table at a steady size while replacing its contents many times over
+  const int num_live_keys = 10000;
+  std::unordered_set<int> live_keys;
+  std::vector<int> live_key_list;
+  for (int key = 0; key < num_live_keys; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, key, key));
+    live_keys.insert(key);
+    live_key_list.push_back(key);
+  }
+  size_t size = ht.GetSize();
+  LinearProbeHashTableStats stats = ht.GetStats();
+  LOG_INFO("after inserts: avg probe length %.2f, max probe length %zu", stats.avg_probe_length_,
+           stats.max_probe_length_);
+
+  std::mt19937 rng(15445);
+  int next_key = num_live_keys;
+  for (int i = 0; i < 10 * num_live_keys; i++) {
+    size_t victim_idx = rng() % live_key_list.size();
+    int victim = live_key_list[victim_idx];
+    EXPECT_TRUE(ht.Remove(nullptr, victim, victim));
+    live_keys.erase(victim);
+    EXPECT_TRUE(ht.Insert(nullptr, next_key, next_key));
+    live_keys.insert(next_key);
+    live_key_list[victim_idx] = next_key++;
+  }
+
+  for (int key = 0; key < next_key; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    EXPECT_EQ(live_keys.count(key), res.size()) << "Wrong result for " << key;
+  }
+
+  // without tombstones, churn neither lengthens probes nor grows the table
+  LinearProbeHashTableStats churned_stats = ht.GetStats();
+  LOG_INFO("after churn:   avg probe length %.2f, max probe length %zu", churned_stats.avg_probe_length_,
+           churned_stats.max_probe_length_);
+  EXPECT_EQ(num_live_keys, churned_stats.num_entries_);
+  EXPECT_LT(churned_stats.avg_probe_length_, 2 * stats.avg_probe_length_);
+  EXPECT_LT(churned_stats.avg_probe_length_, 4);
+  EXPECT_EQ(size, ht.GetSize());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+TEST(LinearProbeHashTableTest, ConcurrentTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  LinearProbeHashTable<int, int, IntComparator> ht("blah", bpm, IntComparator(), 1, HashFunction<int>());
+
+  // writers on disjoint keys, while the table grows and while it does not, next to a reader of keys nobody touches
+  const int num_keys = 10000;
+  const int num_threads = 4;
+  for (int key = 0; key < num_keys; key++) {
+    EXPECT_TRUE(ht.Insert(nullptr, -key - 1, key));
+  }
+  for (int round = 0; round < 2; round++) {
+    std::vector<std::thread> threads;
+    for (int thread_itr = 0; thread_itr < num_threads; thread_itr++) {
+      threads.emplace_back([&ht, round, thread_itr] {
+        for (int key = thread_itr; key < num_keys; key += num_threads) {
+          EXPECT_TRUE(round == 0 ? ht.Insert(nullptr, key, key) : ht.Remove(nullptr, key, key));
+          EXPECT_FALSE(round == 0 ? ht.Insert(nullptr, key, key) : ht.Remove(nullptr, key, key));
+        }
+      });
+    }
+    threads.emplace_back([&ht] {
+      for (int key = 0; key < num_keys; key++) {
+        std::vector<int> res;
+        ht.GetValue(nullptr, -key - 1, &res);
+        EXPECT_EQ(1, res.size()) << "Failed to find " << -key - 1;
+      }
+    });
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  for (int key = -num_keys; key < num_keys; key++) {
+    std::vector<int> res;
+    ht.GetValue(nullptr, key, &res);
+    EXPECT_EQ(key < 0 ? 1 : 0, res.size()) << "Wrong result for " << key;
+  }
+  EXPECT_EQ(num_keys, ht.GetStats().num_entries_);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+  delete bpm;
+}
+
+}  // namespace bustub
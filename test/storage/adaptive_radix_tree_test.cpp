@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// adaptive_radix_tree_test.cpp
+//
+// Identification: test/storage/adaptive_radix_tree_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "gtest/gtest.h"
+#include "storage/index/adaptive_radix_tree.h"
+#include "storage/index/adaptive_radix_tree_index.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+// checks that tree holds exactly the entries of expected, in order, also when starting at low
+void CheckTree(AdaptiveRadixTree *tree, const std::multimap<std::string, RID> &expected, const std::string &low) {
+  std::vector<std::pair<std::string, RID>> scanned;
+  tree->Scan(nullptr, true, [&](const std::string &key, RID rid) {
+    scanned.emplace_back(key, rid);
+    return true;
+  });
+  ASSERT_EQ(scanned.size(), expected.size());
+  auto it = expected.begin();
+  for (const auto &[key, rid] : scanned) {
+    EXPECT_EQ(key, it->first);
+    EXPECT_EQ(rid, it->second);
+    ++it;
+  }
+  EXPECT_EQ(tree->IsEmpty(), expected.empty());
+
+  for (bool low_inclusive : {true, false}) {
+    std::vector<std::string> keys;
+    tree->Scan(&low, low_inclusive, [&](const std::string &key, RID rid) {
+      keys.push_back(key);
+      return keys.size() < 10;
+    });
+    auto from = low_inclusive ? expected.lower_bound(low) : expected.upper_bound(low);
+    for (const auto &key : keys) {
+      ASSERT_NE(from, expected.end());
+      EXPECT_EQ(key, from->first);
+      ++from;
+    }
+    EXPECT_TRUE(keys.size() == 10 || from == expected.end());
+  }
+}
+
+}  // namespace
+
+TEST(AdaptiveRadixTreeTest, InsertRemoveTest) {
+  AdaptiveRadixTree tree;
+  std::multimap<std::string, RID> expected;
+  std::mt19937 gen(0);
+
+  // 3-byte keys over few enough byte values that nodes of every size fill up and empty again
+  auto random_key = [&](int num_bytes) {
+    std::string key;
+    for (int i = 0; i < 3; i++) {
+      key.push_back(static_cast<char>(gen() % num_bytes));
+    }
+    return key;
+  };
+  for (int num_bytes : {3, 12, 40, 256}) {
+    for (int round = 0; round < 4000; round++) {
+      std::string key = random_key(num_bytes);
+      RID rid(round, num_bytes);
+      bool present = expected.count(key) != 0;
+      if (gen() % 3 != 0) {
+        EXPECT_EQ(tree.Insert(key, rid), !present);
+        if (!present) {
+          expected.emplace(key, rid);
+        }
+      } else {
+        EXPECT_EQ(tree.Remove(key, rid), present);
+        expected.erase(key);
+      }
+
+      std::vector<RID> rids;
+      EXPECT_EQ(tree.GetValue(key, &rids), expected.count(key) != 0);
+      if (round % 500 == 0) {
+        CheckTree(&tree, expected, random_key(num_bytes));
+      }
+    }
+    CheckTree(&tree, expected, random_key(num_bytes));
+  }
+
+  // emptying the tree shrinks every node until none is left
+  while (!expected.empty()) {
+    EXPECT_TRUE(tree.Remove(expected.begin()->first, expected.begin()->second));
+    expected.erase(expected.begin());
+  }
+  CheckTree(&tree, expected, "");
+}
+
+TEST(AdaptiveRadixTreeTest, PrefixTest) {
+  AdaptiveRadixTree tree;
+  std::multimap<std::string, RID> expected;
+
+  // terminated keys sharing long prefixes, which are split where they differ, and merged back when removed
+  std::vector<std::string> keys{"abcdefgh", "abcdefxy", "abcd", "abzz", "b", "abcdefghij", "abcdefgz"};
+  for (size_t i = 0; i < keys.size(); i++) {
+    keys[i].push_back(0);
+    EXPECT_TRUE(tree.Insert(keys[i], RID(0, i)));
+    expected.emplace(keys[i], RID(0, i));
+    CheckTree(&tree, expected, keys[0]);
+  }
+  std::vector<RID> rids;
+  EXPECT_FALSE(tree.GetValue(std::string("abcdefgy\0", 9), &rids));
+  EXPECT_FALSE(tree.GetValue(std::string("abc\0", 4), &rids));
+  EXPECT_TRUE(rids.empty());
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    EXPECT_FALSE(tree.Remove(keys[i] + "x", RID(0, i)));
+    EXPECT_TRUE(tree.Remove(keys[i], RID(0, i)));
+    expected.erase(keys[i]);
+    CheckTree(&tree, expected, keys.back());
+  }
+}
+
+TEST(AdaptiveRadixTreeTest, NonUniqueTest) {
+  AdaptiveRadixTree tree(false);
+  std::multimap<std::string, RID> expected;
+  for (int key = 0; key < 100; key++) {
+    for (int slot = 0; slot < 5; slot++) {
+      std::string key_bytes{static_cast<char>(key), static_cast<char>(key % 7)};
+      EXPECT_TRUE(tree.Insert(key_bytes, RID(key, slot)));
+      EXPECT_FALSE(tree.Insert(key_bytes, RID(key, slot)));
+      expected.emplace(key_bytes, RID(key, slot));
+    }
+  }
+  CheckTree(&tree, expected, std::string{50, 0});
+
+  std::string key_bytes{10, 3};
+  std::vector<RID> rids;
+  EXPECT_TRUE(tree.GetValue(key_bytes, &rids));
+  EXPECT_EQ(rids.size(), 5);
+
+  // removing one RID of a key keeps the others
+  EXPECT_FALSE(tree.Remove(key_bytes, RID(11, 0)));
+  EXPECT_TRUE(tree.Remove(key_bytes, RID(10, 0)));
+  rids.clear();
+  EXPECT_TRUE(tree.GetValue(key_bytes, &rids));
+  EXPECT_EQ(rids.size(), 4);
+  EXPECT_EQ(std::count(rids.begin(), rids.end(), RID(10, 0)), 0);
+}
+
+TEST(AdaptiveRadixTreeTest, DISABLED_Benchmark) {
+  // the same keys in a B+ tree and an adaptive radix tree index
+  Schema schema{{Column{"a", TypeId::BIGINT}}};
+  auto bplus_tree_meta = std::make_unique<IndexMetadata>("bplus_tree", "foo", &schema, std::vector<uint32_t>{0});
+  auto art_meta = std::make_unique<IndexMetadata>("art", "foo", &schema, std::vector<uint32_t>{0});
+  Schema *key_schema = art_meta->GetKeySchema();
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+  auto bplus_tree = std::make_unique<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>>(
+      std::move(bplus_tree_meta), bpm);
+  auto art = std::make_unique<AdaptiveRadixTreeIndex>(std::move(art_meta));
+
+  const int64_t num_keys = 200000;
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys[key] = key * 3;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  auto key_tuple = [&](int64_t key) { return Tuple({ValueFactory::GetBigIntValue(key)}, key_schema); };
+
+  const int num_scans = 2000;
+  const int64_t scan_length = 100;
+  for (Index *index : std::vector<Index *>{bplus_tree.get(), art.get()}) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t key : keys) {
+      index->InsertEntry(key_tuple(key), RID(0, key), nullptr);
+    }
+    std::chrono::duration<double> insert_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<RID> rids;
+    for (int64_t key : keys) {
+      index->ScanKey(key_tuple(key), &rids, nullptr);
+    }
+    std::chrono::duration<double> get_time = std::chrono::steady_clock::now() - start;
+    ASSERT_EQ(rids.size(), num_keys);
+    for (int64_t i = 0; i < num_keys; i++) {
+      EXPECT_EQ(rids[i].GetSlotNum(), keys[i]);
+    }
+
+    start = std::chrono::steady_clock::now();
+    int64_t num_scanned = 0;
+    for (int scan = 0; scan < num_scans; scan++) {
+      Tuple low = key_tuple(keys[scan]);
+      Tuple high = key_tuple(keys[scan] + 3 * (scan_length - 1));
+      index->ScanRange(
+          &low, true, &high, true,
+          [&](RID rid) {
+            num_scanned++;
+            return true;
+          },
+          nullptr);
+    }
+    std::chrono::duration<double> scan_time = std::chrono::steady_clock::now() - start;
+    EXPECT_LE(num_scanned, num_scans * scan_length);
+    EXPECT_GT(num_scanned, num_scans * scan_length * 9 / 10);
+
+    LOG_INFO("%s: %ld inserts %.3f sec, %ld lookups %.3f sec, %d scans of %ld keys %.3f sec",
+             index->GetName().c_str(), num_keys, insert_time.count(), num_keys, get_time.count(), num_scans,
+             scan_length, scan_time.count());
+  }
+
+  bplus_tree.reset();
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
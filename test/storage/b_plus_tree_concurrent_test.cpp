@@ -10,12 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
 #include "test_util.h"  // NOLINT
@@ -71,6 +75,18 @@ void InsertHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
+// helper function to look up keys that are all in the tree
+void LookupHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, const std::vector<int64_t> &keys,
+                  __attribute__((unused)) uint64_t thread_itr = 0) {
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  for (auto key : keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree->GetValue(index_key, &rids));
+  }
+}
+
 // helper function to delete
 void DeleteHelper(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree, const std::vector<int64_t> &remove_keys,
                   __attribute__((unused)) uint64_t thread_itr = 0) {
@@ -100,7 +116,7 @@ void DeleteHelperSplit(BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree
   delete transaction;
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
+TEST(BPlusTreeConcurrentTest, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -152,7 +168,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
+TEST(BPlusTreeConcurrentTest, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -203,7 +219,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_InsertTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
+TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -245,7 +261,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
+TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -288,7 +304,7 @@ TEST(BPlusTreeConcurrentTest, DISABLED_DeleteTest2) {
   remove("test.log");
 }
 
-TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
+TEST(BPlusTreeConcurrentTest, MixTest) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -333,4 +349,309 @@ TEST(BPlusTreeConcurrentTest, DISABLED_MixTest) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, StressTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  // small pages, so that the tree is deep and splits and merges all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // keys [0, num_keys) are inserted and removed over and over, keys [num_keys, 2 * num_keys) stay put throughout
+  const int64_t num_keys = 2000;
+  const uint64_t num_threads = 4;
+  std::vector<int64_t> stable_keys;
+  for (int64_t key = num_keys; key < 2 * num_keys; key++) {
+    stable_keys.push_back(key);
+  }
+  InsertHelper(&tree, stable_keys);
+
+  std::vector<GenericKey<8>> stable_index_keys(stable_keys.size());
+  for (size_t i = 0; i < stable_keys.size(); i++) {
+    stable_index_keys[i].SetFromInteger(stable_keys[i]);
+  }
+
+  std::atomic<bool> done{false};
+  std::thread reader([&] {
+    std::vector<RID> rids;
+    while (!done) {
+      LookupHelper(&tree, stable_keys);
+      // and all at once, reusing the path down the tree between keys that are close
+      rids.clear();
+      auto found = tree.MultiGet(stable_index_keys, &rids);
+      EXPECT_EQ(std::count(found.begin(), found.end(), true), num_keys);
+      ASSERT_EQ(rids.size(), stable_keys.size());
+      for (size_t i = 0; i < rids.size(); i++) {
+        EXPECT_EQ(rids[i].GetSlotNum(), stable_keys[i]);
+      }
+      // a scan returns keys in increasing order, and every key that was in the tree throughout
+      int64_t prev_key = -1;
+      int64_t num_stable_keys = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        EXPECT_LT(prev_key, key);
+        num_stable_keys += key >= num_keys ? 1 : 0;
+        prev_key = key;
+      }
+      EXPECT_EQ(num_stable_keys, num_keys);
+      // and so does a scan backwards, in decreasing order
+      prev_key = 2 * num_keys;
+      num_stable_keys = 0;
+      for (auto iterator = tree.RBegin(); iterator != tree.End(); ++iterator) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        EXPECT_GT(prev_key, key);
+        num_stable_keys += key >= num_keys ? 1 : 0;
+        prev_key = key;
+      }
+      EXPECT_EQ(num_stable_keys, num_keys);
+    }
+  });
+
+  auto worker = [&](uint64_t thread_itr) {
+    std::vector<int64_t> keys;
+    for (int64_t key = thread_itr; key < num_keys; key += num_threads) {
+      keys.push_back(key);
+    }
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    for (int round = 0; round < 3; round++) {
+      InsertHelper(&tree, keys);
+      LookupHelper(&tree, keys);
+      DeleteHelper(&tree, keys);
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_FALSE(tree.GetValue(index_key, &rids));
+      }
+    }
+    InsertHelper(&tree, keys);
+  };
+  LaunchParallelTest(num_threads, worker);
+  done = true;
+  reader.join();
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, 2 * num_keys);
+
+  auto stats = tree.GetConcurrencyStats();
+  EXPECT_GT(stats.num_optimistic_ops_, 0);
+  EXPECT_GT(stats.num_pessimistic_ops_, 0);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, WriteBufferTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  tree.SetWriteBufferSize(100);
+
+  // each thread writes its own keys, which are buffered and flushed by all threads
+  const int64_t num_keys = 2000;
+  const uint64_t num_threads = 4;
+  auto worker = [&](uint64_t thread_itr) {
+    std::vector<int64_t> keys;
+    for (int64_t key = thread_itr; key < num_keys; key += num_threads) {
+      keys.push_back(key);
+    }
+    GenericKey<8> index_key;
+    std::vector<RID> rids;
+    for (int round = 0; round < 3; round++) {
+      InsertHelper(&tree, keys);
+      LookupHelper(&tree, keys);
+      DeleteHelper(&tree, keys);
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_FALSE(tree.GetValue(index_key, &rids));
+      }
+    }
+    InsertHelper(&tree, keys);
+  };
+  LaunchParallelTest(num_threads, worker);
+
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key++;
+  }
+  EXPECT_EQ(current_key, num_keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, DeferredMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // writers remove three of every four keys while readers look up the rest, and a background thread rebalances
+  std::vector<int64_t> kept_keys;
+  std::vector<int64_t> removed_keys;
+  for (int64_t key = 0; key < 20000; key++) {
+    (key % 4 == 0 ? kept_keys : removed_keys).push_back(key);
+  }
+  for (bool deferred : {false, true}) {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree(deferred ? "deferred" : "inline", bpm, comparator, 8, 8);
+    InsertHelper(&tree, kept_keys);
+    InsertHelper(&tree, removed_keys);
+    tree.SetDeferredMerges(deferred);
+    if (deferred) {
+      tree.StartBackgroundRebalance(std::chrono::milliseconds(1));
+    }
+
+    auto before = tree.GetConcurrencyStats();
+    auto start = std::chrono::steady_clock::now();
+    std::thread reader([&] { LaunchParallelTest(2, LookupHelper, &tree, kept_keys); });
+    LaunchParallelTest(4, DeleteHelperSplit, &tree, removed_keys, 4);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    reader.join();
+    tree.StopBackgroundRebalance();
+    size_t num_rebalanced = tree.Rebalance();
+    auto stats = tree.GetConcurrencyStats();
+    LOG_INFO("%s merges: %.0f removes/sec, %lu pessimistic ops, %zu leaves still to rebalance after them",
+             deferred ? "deferred" : "inline", removed_keys.size() / elapsed.count(),
+             stats.num_pessimistic_ops_ - before.num_pessimistic_ops_, num_rebalanced);
+
+    size_t next = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      ASSERT_LT(next, kept_keys.size());
+      EXPECT_EQ((*iterator).first.ToString(), kept_keys[next++]);
+    }
+    EXPECT_EQ(next, kept_keys.size());
+    DeleteHelper(&tree, kept_keys);
+    EXPECT_TRUE(tree.IsEmpty());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, StatsTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(200, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 8, 8);
+
+  // stats are collected over and over while writers split and merge pages underneath
+  std::vector<int64_t> kept_keys;
+  std::vector<int64_t> changed_keys;
+  for (int64_t key = 0; key < 10000; key++) {
+    (key % 2 == 0 ? kept_keys : changed_keys).push_back(key);
+  }
+  InsertHelper(&tree, kept_keys);
+  std::atomic<bool> done{false};
+  std::thread collector([&] {
+    while (!done) {
+      auto stats = tree.CollectStats(0.5);
+      EXPECT_GE(stats.height_, 2);
+      EXPECT_GT(stats.num_entries_, 0);
+    }
+  });
+  LaunchParallelTest(2, InsertHelperSplit, &tree, changed_keys, 2);
+  LaunchParallelTest(2, DeleteHelperSplit, &tree, changed_keys, 2);
+  done = true;
+  collector.join();
+  EXPECT_EQ(tree.CollectStats().num_entries_, kept_keys.size());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, DISABLED_ThroughputTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 10000; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  for (uint64_t num_threads : {1, 2, 4, 8}) {
+    auto start = std::chrono::steady_clock::now();
+    LaunchParallelTest(num_threads, LookupHelper, &tree, keys);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("%lu reader threads: %.0f lookups/sec", num_threads, num_threads * keys.size() / elapsed.count());
+  }
+
+  // readers keep running while writers insert into the same leaves
+  std::vector<int64_t> new_keys;
+  for (int64_t key = 10000; key < 20000; key++) {
+    new_keys.push_back(key);
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::thread writer([&] { LaunchParallelTest(2, InsertHelperSplit, &tree, new_keys, 2); });
+  LaunchParallelTest(4, LookupHelper, &tree, keys);
+  writer.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  auto stats = tree.GetConcurrencyStats();
+  LOG_INFO("4 readers and 2 writers: %.0f ops/sec, %lu optimistic, %lu restarts, %lu pessimistic",
+           (4 * keys.size() + new_keys.size()) / elapsed.count(), stats.num_optimistic_ops_, stats.num_restarts_,
+           stats.num_pessimistic_ops_);
+  LookupHelper(&tree, new_keys);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -12,6 +12,11 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <iterator>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -20,7 +25,7 @@
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
+TEST(BPlusTreeTests, DeleteTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -98,7 +103,7 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
+TEST(BPlusTreeTests, DeleteTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -175,4 +180,419 @@ TEST(BPlusTreeTests, DISABLED_DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, RandomizedTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that every kind of split, merge and redistribution happens
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int64_t> key_dist(0, 499);
+  std::set<int64_t> expected;
+  std::vector<RID> rids;
+  for (int i = 0; i < 5000; i++) {
+    int64_t key = key_dist(gen);
+    index_key.SetFromInteger(key);
+    if (gen() % 2 == 0) {
+      rid.Set(0, key);
+      EXPECT_EQ(tree.Insert(index_key, rid), expected.insert(key).second);
+    } else {
+      tree.Remove(index_key);
+      expected.erase(key);
+    }
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(index_key, &rids), expected.count(key) > 0);
+  }
+
+  auto expected_it = expected.begin();
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator, ++expected_it) {
+    ASSERT_NE(expected_it, expected.end());
+    EXPECT_EQ((*iterator).second.GetSlotNum(), *expected_it);
+  }
+  EXPECT_EQ(expected_it, expected.end());
+
+  // removing everything leaves an empty tree
+  for (auto key : expected) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  EXPECT_EQ(tree.Begin(), tree.End());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that the previous page ids change with every kind of split and merge
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  EXPECT_EQ(tree.RBegin(), tree.End());
+
+  // iterating backwards from high, or from the last key, visits the keys not greater than it in descending order
+  auto check_reverse = [&](const std::set<int64_t> &expected, const int64_t *high) {
+    auto expected_it = expected.rbegin();
+    if (high != nullptr) {
+      expected_it = std::make_reverse_iterator(expected.upper_bound(*high));
+      index_key.SetFromInteger(*high);
+    }
+    for (auto iterator = high == nullptr ? tree.RBegin() : tree.RBegin(index_key); iterator != tree.End();
+         ++iterator, ++expected_it) {
+      ASSERT_NE(expected_it, expected.rend());
+      EXPECT_EQ((*iterator).second.GetSlotNum(), *expected_it);
+    }
+    EXPECT_EQ(expected_it, expected.rend());
+  };
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int64_t> key_dist(0, 499);
+  std::set<int64_t> expected;
+  for (int i = 0; i < 5000; i++) {
+    int64_t key = key_dist(gen);
+    index_key.SetFromInteger(key);
+    if (gen() % 2 == 0) {
+      rid.Set(0, key);
+      EXPECT_EQ(tree.Insert(index_key, rid), expected.insert(key).second);
+    } else {
+      tree.Remove(index_key);
+      expected.erase(key);
+    }
+    if (i % 250 == 0) {
+      int64_t high = key_dist(gen);
+      check_reverse(expected, nullptr);
+      check_reverse(expected, &high);
+    }
+  }
+
+  // the leaves of a bulk loaded tree are linked backwards as well
+  for (auto key : expected) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key);
+  }
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  expected.clear();
+  for (int64_t key = 0; key < 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, key);
+    entries.emplace_back(index_key, rid);
+    expected.insert(key);
+  }
+  EXPECT_TRUE(tree.BulkLoad(entries.data(), entries.data() + entries.size()));
+  for (int64_t high : {-1, 0, 1, 500, 501, 998, 2000}) {
+    check_reverse(expected, &high);
+  }
+  check_reverse(expected, nullptr);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, CompressedKeysTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint,b bigint,c bigint,d bigint,e bigint,f bigint,g bigint,h bigint");
+  GenericComparator<64> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // pages as large as they get, so that the keys' common bytes decide how many entries fit
+  BPlusTree<GenericKey<64>, RID, GenericComparator<64>> tree("foo_pk", bpm, comparator);
+  RID rid;
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Keys come in groups of 16, in the order of their ids. Within most groups keys only differ in their first two
+  // columns, but every 16th group differs from the others in all columns, and within itself only in the last one, so
+  // that inserting one of its keys widens the entries of a page, and separating two of them takes all their bytes.
+  auto make_key = [&key_schema](int64_t id) {
+    int64_t group = id / 16;
+    std::vector<Value> columns(8, Value(TypeId::BIGINT, int64_t{0}));
+    columns[0] = Value(TypeId::BIGINT, group);
+    columns[1] = Value(TypeId::BIGINT, id % 16);
+    if (group % 16 == 0) {
+      for (int column = 1; column < 7; column++) {
+        columns[column] = Value(TypeId::BIGINT, group * 1000003 + column);
+      }
+      columns[7] = Value(TypeId::BIGINT, id % 16);
+    }
+    GenericKey<64> key;
+    key.SetFromKey(Tuple(columns, key_schema.get()), key_schema.get());
+    return key;
+  };
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int64_t> id_dist(0, 19999);
+  std::set<int64_t> expected;
+  std::vector<RID> rids;
+  for (int i = 0; i < 60000; i++) {
+    int64_t id = id_dist(gen);
+    if (gen() % 3 != 0) {
+      rid.Set(0, id);
+      EXPECT_EQ(tree.Insert(make_key(id), rid), expected.insert(id).second);
+    } else {
+      tree.Remove(make_key(id));
+      expected.erase(id);
+    }
+    rids.clear();
+    EXPECT_EQ(tree.GetValue(make_key(id), &rids), expected.count(id) > 0);
+  }
+
+  auto expected_it = expected.begin();
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator, ++expected_it) {
+    ASSERT_NE(expected_it, expected.end());
+    EXPECT_EQ((*iterator).second.GetSlotNum(), *expected_it);
+  }
+  EXPECT_EQ(expected_it, expected.end());
+
+  // some leaves hold more entries than would fit uncompressed
+  using LeafPage = BPlusTreeLeafPage<GenericKey<64>, RID, GenericComparator<64>>;
+  int max_leaf_size = 0;
+  Page *page = tree.FindLeafPage(make_key(0), true);
+  while (page != nullptr) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    max_leaf_size = std::max(max_leaf_size, leaf->GetSize());
+    page_id_t next_page_id = leaf->GetNextPageId();
+    bpm->UnpinPage(page->GetPageId(), false);
+    page = next_page_id == INVALID_PAGE_ID ? nullptr : bpm->FetchPage(next_page_id);
+  }
+  int uncompressed_max_size = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(GenericKey<64>) + sizeof(RID));
+  EXPECT_GT(max_leaf_size, uncompressed_max_size);
+
+  for (auto id : expected) {
+    tree.Remove(make_key(id));
+    rids.clear();
+    EXPECT_FALSE(tree.GetValue(make_key(id), &rids));
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, NonUniqueTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<16> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that the values of a key spread over several leaves
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree("foo_pk", bpm, comparator, 3, 4, false);
+  EXPECT_FALSE(tree.IsUnique());
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // 20 values for each of 50 keys, and the keys of a tree that is not unique have to have room for a value
+  EXPECT_THROW((BPlusTree<GenericKey<8>, RID, GenericComparator<8>>("bar_pk", bpm, GenericComparator<8>(nullptr),
+                                                                   3, 4, false)),
+               Exception);
+  const int64_t num_keys = 50;
+  const int64_t num_values = 20;
+  std::vector<std::pair<int64_t, int64_t>> entries;
+  for (int64_t key = 0; key < num_keys; key++) {
+    for (int64_t value = 0; value < num_values; value++) {
+      entries.emplace_back(key, value);
+    }
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(15445));
+  GenericKey<16> index_key;
+  for (const auto &[key, value] : entries) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(key, value)));
+  }
+  index_key.SetFromInteger(7);
+  EXPECT_FALSE(tree.Insert(index_key, RID(7, 3)));
+
+  auto check_values = [&](int64_t key, int64_t expected_values) {
+    std::vector<RID> rids;
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), expected_values > 0);
+    std::set<int64_t> values;
+    for (const auto &rid : rids) {
+      EXPECT_EQ(rid.GetPageId(), key);
+      values.insert(rid.GetSlotNum());
+    }
+    EXPECT_EQ(values.size(), expected_values);
+    EXPECT_EQ(rids.size(), expected_values);
+  };
+  for (int64_t key = 0; key < num_keys; key++) {
+    check_values(key, num_values);
+  }
+  check_values(num_keys, 0);
+
+  // iterators return the keys entries are stored under, in order, which KeyOf turns back into the inserted keys
+  int64_t num_entries = 0;
+  int64_t prev_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    int64_t key = tree.KeyOf((*iterator).first).ToString();
+    EXPECT_LE(prev_key, key);
+    EXPECT_EQ((*iterator).second.GetPageId(), key);
+    prev_key = key;
+    num_entries++;
+  }
+  EXPECT_EQ(num_entries, num_keys * num_values);
+  // and start at the first or, backwards, the last entry of a key
+  index_key.SetFromInteger(10);
+  auto iterator = tree.Begin(index_key);
+  EXPECT_EQ(tree.KeyOf((*iterator).first).ToString(), 10);
+  for (int64_t value = 1; value < num_values; value++) {
+    ++iterator;
+  }
+  EXPECT_EQ(tree.KeyOf((*iterator).first).ToString(), 10);
+  ++iterator;
+  EXPECT_EQ(tree.KeyOf((*iterator).first).ToString(), 11);
+  auto reverse_iterator = tree.RBegin(index_key);
+  EXPECT_EQ(tree.KeyOf((*reverse_iterator).first).ToString(), 10);
+  for (int64_t value = 0; value < num_values; value++) {
+    ++reverse_iterator;
+  }
+  EXPECT_EQ(tree.KeyOf((*reverse_iterator).first).ToString(), 9);
+
+  // removing a key-value pair keeps the other values of the key, removing a key drops them all
+  for (int64_t value = 0; value < num_values; value += 2) {
+    index_key.SetFromInteger(20);
+    tree.Remove(index_key, RID(20, value));
+  }
+  check_values(20, num_values / 2);
+  index_key.SetFromInteger(30);
+  tree.Remove(index_key);
+  check_values(30, 0);
+  check_values(29, num_values);
+  check_values(31, num_values);
+
+  // bulk loading keeps every entry too
+  BPlusTree<GenericKey<16>, RID, GenericComparator<16>> loaded_tree("bar_pk", bpm, comparator, 3, 4, false);
+  std::vector<std::pair<GenericKey<16>, RID>> load_entries;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    for (int64_t value = 0; value < num_values; value++) {
+      load_entries.emplace_back(index_key, RID(key, num_values - value));
+    }
+  }
+  EXPECT_TRUE(loaded_tree.BulkLoad(load_entries.data(), load_entries.data() + load_entries.size()));
+  std::vector<RID> rids;
+  index_key.SetFromInteger(30);
+  EXPECT_TRUE(loaded_tree.GetValue(index_key, &rids));
+  EXPECT_EQ(rids.size(), num_values);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DeferredMergeTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // three of every four keys are removed, which leaves every leaf underflowing but none empty
+  const int64_t num_keys = 1000;
+  GenericKey<8> index_key;
+  auto check_keys = [&](BPlusTree<GenericKey<8>, RID, GenericComparator<8>> *tree) {
+    std::vector<RID> rids;
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(key);
+      EXPECT_EQ(tree->GetValue(index_key, &rids), key % 4 == 0);
+    }
+    int64_t next_key = 0;
+    for (auto iterator = tree->Begin(); iterator != tree->End(); ++iterator) {
+      EXPECT_EQ((*iterator).first.ToString(), next_key);
+      next_key += 4;
+    }
+    EXPECT_EQ(next_key, num_keys);
+  };
+  for (bool deferred : {false, true}) {
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree(deferred ? "deferred" : "inline", bpm, comparator, 8, 8);
+    for (int64_t key = 0; key < num_keys; key++) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key));
+    }
+    tree.SetDeferredMerges(deferred);
+
+    uint64_t num_pessimistic_ops = tree.GetConcurrencyStats().num_pessimistic_ops_;
+    for (int64_t key = 0; key < num_keys; key++) {
+      if (key % 4 != 0) {
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key);
+      }
+    }
+    // removes only latch the leaf once merges are deferred
+    num_pessimistic_ops = tree.GetConcurrencyStats().num_pessimistic_ops_ - num_pessimistic_ops;
+    if (deferred) {
+      EXPECT_EQ(num_pessimistic_ops, 0);
+    } else {
+      EXPECT_GT(num_pessimistic_ops, 0);
+    }
+    check_keys(&tree);
+
+    // rebalancing merges the leaves that are still underflowing, once, mostly latching only their parent and sibling
+    num_pessimistic_ops = tree.GetConcurrencyStats().num_pessimistic_ops_;
+    size_t num_rebalanced = tree.Rebalance();
+    num_pessimistic_ops = tree.GetConcurrencyStats().num_pessimistic_ops_ - num_pessimistic_ops;
+    EXPECT_EQ(num_rebalanced > 0, deferred);
+    EXPECT_LE(num_pessimistic_ops, num_rebalanced / 2);
+    EXPECT_EQ(tree.Rebalance(), 0);
+    check_keys(&tree);
+
+    // the tree still shrinks down to nothing
+    tree.SetDeferredMerges(false);
+    for (int64_t key = 0; key < num_keys; key += 4) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+    EXPECT_TRUE(tree.IsEmpty());
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -11,16 +11,24 @@
 //===----------------------------------------------------------------------===//
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
 #include "gtest/gtest.h"
 #include "storage/index/b_plus_tree.h"
+#include "storage/page/header_page.h"
 #include "test_util.h"  // NOLINT
 
 namespace bustub {
 
-TEST(BPlusTreeTests, DISABLED_InsertTest1) {
+TEST(BPlusTreeTests, InsertTest1) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -78,7 +86,7 @@ TEST(BPlusTreeTests, DISABLED_InsertTest1) {
   remove("test.log");
 }
 
-TEST(BPlusTreeTests, DISABLED_InsertTest2) {
+TEST(BPlusTreeTests, InsertTest2) {
   // create KeyComparator and index schema
   auto key_schema = ParseCreateStatement("a bigint");
   GenericComparator<8> comparator(key_schema.get());
@@ -145,4 +153,738 @@ TEST(BPlusTreeTests, DISABLED_InsertTest2) {
   remove("test.db");
   remove("test.log");
 }
+TEST(BPlusTreeTests, MetaPageTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that the root changes again and again
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = reinterpret_cast<HeaderPage *>(bpm->NewPage(&page_id));
+  header_page->Init();
+
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(0);
+  tree.Insert(index_key, RID(0, 0));
+  page_id_t meta_page_id;
+  ASSERT_TRUE(header_page->GetRootId("foo_pk", &meta_page_id));
+  for (int64_t key = 1; key < 1000; key++) {
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, RID(0, key));
+  }
+  // the root moved, the meta page did not
+  page_id_t current_meta_page_id;
+  ASSERT_TRUE(header_page->GetRootId("foo_pk", &current_meta_page_id));
+  EXPECT_EQ(current_meta_page_id, meta_page_id);
+
+  // another tree finds the root through the meta page
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> opened_tree("foo_pk", bpm, comparator, 3, 4);
+  EXPECT_TRUE(opened_tree.Open());
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 1000; key++) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(opened_tree.GetValue(index_key, &rids));
+  }
+  EXPECT_EQ(rids.size(), 1000);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> other_tree("bar_pk", bpm, comparator, 3, 4);
+  EXPECT_FALSE(other_tree.Open());
+  EXPECT_TRUE(other_tree.IsEmpty());
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  for (int64_t num_keys : {0, 1, 2, 3, 5, 13, 100, 1000}) {
+    for (double fill_factor : {0.5, 1.0}) {
+      DiskManager *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      // small pages, so that there are several internal levels with short last pages
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+      GenericKey<8> index_key;
+
+      // create and fetch header_page
+      page_id_t page_id;
+      auto header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      // even keys only, each one twice: the first copy is loaded
+      std::vector<std::pair<GenericKey<8>, RID>> entries;
+      for (int64_t key = 0; key < num_keys; key++) {
+        index_key.SetFromInteger(2 * key);
+        entries.emplace_back(index_key, RID(0, key));
+        entries.emplace_back(index_key, RID(1, key));
+      }
+      EXPECT_TRUE(tree.BulkLoad(entries.data(), entries.data() + entries.size(), fill_factor));
+      EXPECT_EQ(tree.IsEmpty(), num_keys == 0);
+
+      int64_t current_key = 0;
+      for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+        EXPECT_EQ((*iterator).first.ToString(), 2 * current_key);
+        EXPECT_EQ((*iterator).second, RID(0, current_key));
+        current_key++;
+      }
+      EXPECT_EQ(current_key, num_keys);
+
+      // the loaded tree is an ordinary one: fill in the odd keys, then remove the even ones
+      RID rid;
+      std::vector<RID> rids;
+      for (int64_t key = 0; key < num_keys; key++) {
+        index_key.SetFromInteger(2 * key + 1);
+        EXPECT_TRUE(tree.Insert(index_key, RID(0, key)));
+      }
+      for (int64_t key = 0; key < num_keys; key++) {
+        index_key.SetFromInteger(2 * key);
+        tree.Remove(index_key);
+      }
+      for (int64_t key = 0; key < 2 * num_keys; key++) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        EXPECT_EQ(tree.GetValue(index_key, &rids), key % 2 == 1);
+      }
+
+      // a tree that is not empty cannot be bulk loaded
+      EXPECT_EQ(tree.BulkLoad(entries.data(), entries.data() + entries.size(), fill_factor), num_keys == 0);
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete disk_manager;
+      delete bpm;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+TEST(BPlusTreeTests, MultiGetTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // small pages, so that the keys spread over many leaves and subtrees
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  std::vector<GenericKey<8>> index_keys(1000);
+  for (int64_t key = 0; key < 1000; key++) {
+    index_keys[key].SetFromInteger(key);
+  }
+  std::vector<RID> rids;
+  // the values of the keys found come in the order of the keys; only the even keys are in the tree unless it is empty
+  auto check = [&](const std::vector<GenericKey<8>> &lookup_keys, bool empty) {
+    rids.clear();
+    auto found = tree.MultiGet(lookup_keys, &rids);
+    ASSERT_EQ(found.size(), lookup_keys.size());
+    size_t num_found = 0;
+    for (size_t i = 0; i < lookup_keys.size(); i++) {
+      int64_t key = lookup_keys[i].ToString();
+      EXPECT_EQ(found[i], !empty && key % 2 == 0);
+      if (found[i]) {
+        ASSERT_LT(num_found, rids.size());
+        EXPECT_EQ(rids[num_found++].GetSlotNum(), key);
+      }
+    }
+    EXPECT_EQ(num_found, rids.size());
+  };
+  check(index_keys, true);
+
+  std::vector<int64_t> keys;
+  for (int64_t key = 0; key < 1000; key += 2) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  for (auto key : keys) {
+    tree.Insert(index_keys[key], RID(0, key));
+  }
+  // sorted keys, as an index nested loop join with a sorted outer side probes them
+  check(index_keys, false);
+  // unsorted keys, which may lead anywhere in the tree, and repeated ones
+  std::vector<GenericKey<8>> shuffled_keys = index_keys;
+  shuffled_keys.insert(shuffled_keys.end(), index_keys.begin(), index_keys.begin() + 100);
+  std::shuffle(shuffled_keys.begin(), shuffled_keys.end(), std::mt19937(15445));
+  check(shuffled_keys, false);
+  check({}, false);
+
+  // and from a tree that became empty again
+  for (auto key : keys) {
+    tree.Remove(index_keys[key]);
+  }
+  EXPECT_TRUE(tree.IsEmpty());
+  check(index_keys, true);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DISABLED_MultiGetBenchmark) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_keys = 200000;
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  std::vector<GenericKey<8>> index_keys;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(0, key));
+    index_keys.push_back(index_key);
+  }
+  tree.BulkLoad(entries.data(), entries.data() + entries.size());
+
+  for (bool multi_get : {false, true}) {
+    std::vector<RID> rids;
+    auto start = std::chrono::steady_clock::now();
+    if (multi_get) {
+      tree.MultiGet(index_keys, &rids);
+    } else {
+      for (const auto &key : index_keys) {
+        tree.GetValue(key, &rids);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("%s %ld sorted keys: %.3f sec", multi_get ? "multi getting" : "getting", num_keys, elapsed.count());
+    ASSERT_EQ(rids.size(), num_keys);
+    for (int64_t key = 0; key < num_keys; key++) {
+      EXPECT_EQ(rids[key].GetSlotNum(), key);
+    }
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DISABLED_NonUniqueBenchmark) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  GenericComparator<16> wide_comparator(key_schema.get());
+
+  // the same entries in a unique tree, a non-unique tree, and a non-unique tree with few distinct keys
+  const int64_t num_entries = 200000;
+  const int64_t num_low_cardinality_keys = 100;
+  for (int64_t num_keys : {int64_t{0}, num_entries, num_low_cardinality_keys}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> unique_tree("foo_pk", bpm, comparator);
+    BPlusTree<GenericKey<16>, RID, GenericComparator<16>> tree(
+        "foo_pk", bpm, wide_comparator, (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(RID), INTERNAL_PAGE_SIZE, false);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    bool unique = num_keys == 0;
+    int64_t num_lookups = unique ? num_entries : num_keys;
+    if (unique) {
+      std::vector<std::pair<GenericKey<8>, RID>> entries(num_entries);
+      for (int64_t entry = 0; entry < num_entries; entry++) {
+        entries[entry].first.SetFromInteger(entry);
+        entries[entry].second = RID(0, entry);
+      }
+      unique_tree.BulkLoad(entries.data(), entries.data() + entries.size());
+    } else {
+      std::vector<std::pair<GenericKey<16>, RID>> entries(num_entries);
+      for (int64_t entry = 0; entry < num_entries; entry++) {
+        entries[entry].first.SetFromInteger(entry * num_keys / num_entries);
+        entries[entry].second = RID(0, entry);
+      }
+      tree.BulkLoad(entries.data(), entries.data() + entries.size());
+    }
+    // pages are allocated one after the other, so the last page id counts them
+    page_id_t num_pages;
+    bpm->NewPage(&num_pages);
+    bpm->UnpinPage(num_pages, false);
+
+    std::vector<RID> rids;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t key = 0; key < num_lookups; key++) {
+      if (unique) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        unique_tree.GetValue(index_key, &rids);
+      } else {
+        GenericKey<16> index_key;
+        index_key.SetFromInteger(key);
+        tree.GetValue(index_key, &rids);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("%s, %ld keys: %d pages, %.3f sec to look up every key", unique ? "unique" : "non-unique",
+             unique ? num_entries : num_keys, num_pages - 1, elapsed.count());
+    EXPECT_EQ(rids.size(), num_entries);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BPlusTreeTests, WriteBufferTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // some writes are buffered and some are flushed all along
+  tree.SetWriteBufferSize(64);
+  std::vector<int64_t> keys(1000);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  GenericKey<8> index_key;
+  for (auto key : keys) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(0, key)));
+    EXPECT_FALSE(tree.Insert(index_key, RID(0, key)));
+  }
+  // removes are blind, whether their key is buffered or not
+  for (auto key : keys) {
+    if (key % 2 == 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+  // inserting a removed key again replaces the removed entry
+  for (int64_t key = 0; key < 100; key += 4) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.Insert(index_key, RID(1, key)));
+  }
+
+  auto expected_page_id = [](int64_t key) { return key % 2 == 1 ? 0 : (key < 100 && key % 4 == 0 ? 1 : -1); };
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < 1000; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(tree.GetValue(index_key, &rids), expected_page_id(key) >= 0);
+    if (expected_page_id(key) >= 0) {
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetPageId(), expected_page_id(key));
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+    }
+  }
+
+  // iterators see the tree flushed
+  int64_t num_keys = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    int64_t key = (*iterator).first.ToString();
+    EXPECT_GE(expected_page_id(key), 0);
+    EXPECT_EQ((*iterator).second.GetPageId(), expected_page_id(key));
+    num_keys++;
+  }
+  EXPECT_EQ(num_keys, 500 + 25);
+
+  // a flush writes each leaf once for all the buffered writes that fall into it
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> wide_tree("foo_pk", bpm, comparator, 64, 64);
+  for (int64_t key = 0; key < 1000; key += 2) {
+    index_key.SetFromInteger(key);
+    wide_tree.Insert(index_key, RID(0, key));
+  }
+  wide_tree.SetWriteBufferSize(1000);
+  for (int64_t key = 1; key < 200; key += 2) {
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(wide_tree.Insert(index_key, RID(0, key)));
+  }
+  auto before = wide_tree.GetConcurrencyStats();
+  wide_tree.FlushWriteBuffer();
+  auto after = wide_tree.GetConcurrencyStats();
+  EXPECT_LT((after.num_optimistic_ops_ + after.num_pessimistic_ops_) -
+                (before.num_optimistic_ops_ + before.num_pessimistic_ops_),
+            100);
+  for (int64_t key = 0; key < 200; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(wide_tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, DISABLED_WriteBufferBenchmark) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  const int64_t num_keys = 100000;
+  std::vector<int64_t> keys(num_keys);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+
+  for (size_t write_buffer_size : {0, 10000}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    // a buffer pool that holds a small part of the tree, so that random inserts keep evicting dirty leaves
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    tree.SetWriteBufferSize(write_buffer_size);
+    auto start = std::chrono::steady_clock::now();
+    GenericKey<8> index_key;
+    for (auto key : keys) {
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key));
+    }
+    tree.FlushWriteBuffer();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("inserting %ld keys with a write buffer of %zu: %.3f sec, %d page writes", num_keys, write_buffer_size,
+             elapsed.count(), disk_manager->GetNumWrites());
+
+    int64_t current_key = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).first.ToString(), current_key);
+      current_key++;
+    }
+    EXPECT_EQ(current_key, num_keys);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BPlusTreeTests, DISABLED_BulkLoadBenchmark) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  const int64_t num_keys = 200000;
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(0, key));
+  }
+  std::shuffle(entries.begin(), entries.end(), std::mt19937(15445));
+
+  for (bool bulk_load : {false, true}) {
+    DiskManager *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    auto start = std::chrono::steady_clock::now();
+    if (bulk_load) {
+      // the sort is part of the build
+      std::vector<std::pair<GenericKey<8>, RID>> sorted_entries = entries;
+      std::sort(sorted_entries.begin(), sorted_entries.end(),
+                [&comparator](const auto &lhs, const auto &rhs) { return comparator(lhs.first, rhs.first) < 0; });
+      tree.BulkLoad(sorted_entries.data(), sorted_entries.data() + sorted_entries.size());
+    } else {
+      for (const auto &entry : entries) {
+        tree.Insert(entry.first, entry.second);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    // pages are allocated one after the other, so the last page id counts them
+    page_id_t num_pages;
+    bpm->NewPage(&num_pages);
+    bpm->UnpinPage(num_pages, false);
+    LOG_INFO("%s %ld keys: %.3f sec, %d pages", bulk_load ? "bulk loading" : "inserting", num_keys, elapsed.count(),
+             num_pages - 1);
+
+    int64_t current_key = 0;
+    for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+      EXPECT_EQ((*iterator).first.ToString(), current_key);
+      current_key++;
+    }
+    EXPECT_EQ(current_key, num_keys);
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+}
+
+TEST(BPlusTreeTests, StatsTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t num_keys = 5000;
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  GenericKey<8> index_key;
+  for (int64_t key = 0; key < num_keys; key++) {
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(0, key));
+  }
+  const size_t num_buckets = 10;
+  // a full walk sees every page, and each level's pages are the children of the level above
+  auto check_stats = [&](const BPlusTreeStats<GenericKey<8>> &stats, int64_t num_entries) {
+    ASSERT_EQ(stats.levels_.size(), stats.height_);
+    EXPECT_EQ(stats.levels_[0].num_pages_, 1);
+    for (size_t depth = 0; depth < stats.levels_.size(); depth++) {
+      const auto &level = stats.levels_[depth];
+      EXPECT_EQ(level.num_pages_read_, level.num_pages_);
+      if (depth + 1 < stats.levels_.size()) {
+        EXPECT_EQ(stats.levels_[depth + 1].num_pages_, level.num_entries_read_);
+      }
+      EXPECT_GT(level.min_fill_, 0);
+      EXPECT_LE(level.min_fill_, level.avg_fill_);
+      EXPECT_LE(level.avg_fill_, 1);
+    }
+    EXPECT_EQ(stats.levels_.back().num_entries_read_, num_entries);
+    EXPECT_EQ(stats.num_entries_, num_entries);
+    EXPECT_GE(stats.leaf_fragmentation_, 0);
+    EXPECT_LE(stats.leaf_fragmentation_, 1);
+
+    // the buckets hold every entry, in key order, each about its share
+    ASSERT_FALSE(stats.key_distribution_.empty());
+    EXPECT_LE(stats.key_distribution_.size(), num_buckets);
+    EXPECT_EQ(stats.key_distribution_[0].first.ToString(), 0);
+    uint64_t num_bucket_entries = 0;
+    for (size_t i = 0; i < stats.key_distribution_.size(); i++) {
+      const auto &[key, count] = stats.key_distribution_[i];
+      if (i > 0) {
+        EXPECT_GT(key.ToString(), stats.key_distribution_[i - 1].first.ToString());
+        EXPECT_EQ(key.ToString() - stats.key_distribution_[i - 1].first.ToString(),
+                  stats.key_distribution_[i - 1].second);
+      }
+      if (i + 1 < stats.key_distribution_.size()) {
+        EXPECT_GE(count, num_entries / num_buckets);
+      }
+      num_bucket_entries += count;
+    }
+    EXPECT_EQ(num_bucket_entries, num_entries);
+  };
+
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("inserted", bpm, comparator, 8, 8);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> loaded_tree("loaded", bpm, comparator, 8, 8);
+  EXPECT_EQ(tree.CollectStats().height_, 0);
+  EXPECT_TRUE(tree.CollectStats().levels_.empty());
+  std::vector<std::pair<GenericKey<8>, RID>> shuffled_entries = entries;
+  std::shuffle(shuffled_entries.begin(), shuffled_entries.end(), std::mt19937(15445));
+  for (const auto &entry : shuffled_entries) {
+    tree.Insert(entry.first, entry.second);
+  }
+  loaded_tree.BulkLoad(entries.data(), entries.data() + entries.size());
+
+  auto stats = tree.CollectStats(1.0, num_buckets);
+  auto loaded_stats = loaded_tree.CollectStats(1.0, num_buckets);
+  check_stats(stats, num_keys);
+  check_stats(loaded_stats, num_keys);
+  for (const auto &level : stats.levels_) {
+    EXPECT_EQ(level.num_underflowing_, 0);
+  }
+  // inserts leave leaves split in half to fill up again, a bulk load packs them
+  EXPECT_GT(loaded_stats.levels_.back().avg_fill_, stats.levels_.back().avg_fill_ + 0.1);
+  EXPECT_LT(loaded_stats.levels_.back().num_pages_, stats.levels_.back().num_pages_);
+  EXPECT_LE(loaded_stats.height_, stats.height_);
+  LOG_INFO("inserted: height %d, %lu leaves %.2f full, fragmentation %.2f; loaded: height %d, %lu leaves %.2f full, "
+           "fragmentation %.2f",
+           stats.height_, stats.levels_.back().num_pages_, stats.levels_.back().avg_fill_, stats.leaf_fragmentation_,
+           loaded_stats.height_, loaded_stats.levels_.back().num_pages_, loaded_stats.levels_.back().avg_fill_,
+           loaded_stats.leaf_fragmentation_);
+
+  // a sample reads a fraction of the leaves, but still counts them all, and estimates the entries
+  auto sampled_stats = tree.CollectStats(0.1, num_buckets);
+  ASSERT_EQ(sampled_stats.height_, stats.height_);
+  const auto &leaves = stats.levels_.back();
+  const auto &sampled_leaves = sampled_stats.levels_.back();
+  EXPECT_EQ(sampled_leaves.num_pages_, leaves.num_pages_);
+  EXPECT_NEAR(sampled_leaves.num_pages_read_, leaves.num_pages_ / 10.0, 1);
+  EXPECT_NEAR(sampled_stats.num_entries_, num_keys, num_keys / 10);
+  EXPECT_NEAR(sampled_leaves.avg_fill_, leaves.avg_fill_, 0.1);
+  EXPECT_LE(sampled_stats.key_distribution_.size(), num_buckets);
+  for (size_t depth = 0; depth + 1 < stats.levels_.size(); depth++) {
+    EXPECT_EQ(sampled_stats.levels_[depth].num_pages_read_, stats.levels_[depth].num_pages_);
+  }
+
+  // removes with deferred merges leave leaves underflowing until the tree is rebalanced
+  tree.SetDeferredMerges(true);
+  for (int64_t key = 0; key < num_keys; key++) {
+    if (key % 4 != 0) {
+      index_key.SetFromInteger(key);
+      tree.Remove(index_key);
+    }
+  }
+  EXPECT_GT(tree.CollectStats().levels_.back().num_underflowing_, 0);
+  tree.Rebalance();
+  stats = tree.CollectStats();
+  for (const auto &level : stats.levels_) {
+    EXPECT_EQ(level.num_underflowing_, 0);
+  }
+  EXPECT_EQ(stats.num_entries_, num_keys / 4);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, KeyHeadTest) {
+  // the heads of keys in the comparator's order never decrease, and keys with different heads never compare equal
+  auto check_heads = [](const std::string &sql, const std::vector<Value> &values) {
+    auto key_schema = ParseCreateStatement(sql);
+    GenericComparator<32> comparator(key_schema.get());
+    std::vector<GenericKey<32>> keys;
+    for (const auto &value : values) {
+      GenericKey<32> key;
+      key.SetFromKey(Tuple({value}, key_schema.get()), key_schema.get());
+      keys.push_back(key);
+    }
+    for (const auto &lhs : keys) {
+      for (const auto &rhs : keys) {
+        if (comparator(lhs, rhs) < 0) {
+          EXPECT_LE(comparator.KeyHead(lhs), comparator.KeyHead(rhs)) << sql;
+        }
+        if (comparator.KeyHead(lhs) < comparator.KeyHead(rhs)) {
+          EXPECT_LT(comparator(lhs, rhs), 0) << sql;
+        }
+      }
+    }
+  };
+  check_heads("a tinyint", {Value(TypeId::TINYINT, static_cast<int8_t>(-100)),
+                            Value(TypeId::TINYINT, static_cast<int8_t>(0)),
+                            Value(TypeId::TINYINT, static_cast<int8_t>(100))});
+  check_heads("a integer", {Value(TypeId::INTEGER, -2000000000), Value(TypeId::INTEGER, -1), Value(TypeId::INTEGER, 0),
+                            Value(TypeId::INTEGER, 1), Value(TypeId::INTEGER, 2000000000)});
+  check_heads("a bigint", {Value(TypeId::BIGINT, -(int64_t{1} << 40)), Value(TypeId::BIGINT, (-(int64_t{1} << 40)) + 1),
+                           Value(TypeId::BIGINT, int64_t{-3}), Value(TypeId::BIGINT, int64_t{0}),
+                           Value(TypeId::BIGINT, int64_t{3}), Value(TypeId::BIGINT, int64_t{1} << 40),
+                           Value(TypeId::BIGINT, (int64_t{1} << 40) + 1)});
+  check_heads("a double", {Value(TypeId::DECIMAL, -1e300), Value(TypeId::DECIMAL, -2.5), Value(TypeId::DECIMAL, -0.0),
+                           Value(TypeId::DECIMAL, 0.0), Value(TypeId::DECIMAL, 1e-300), Value(TypeId::DECIMAL, 2.5),
+                           Value(TypeId::DECIMAL, 2.5000001), Value(TypeId::DECIMAL, 1e300)});
+  check_heads("a varchar(16)", {Value(TypeId::VARCHAR, "a"), Value(TypeId::VARCHAR, "ab"),
+                                Value(TypeId::VARCHAR, "abcd"), Value(TypeId::VARCHAR, "abcde"),
+                                Value(TypeId::VARCHAR, "abcdf"), Value(TypeId::VARCHAR, "b"),
+                                Value(TypeId::VARCHAR, "\xff")});
+
+  // strings that share their first bytes share their heads, so the tree falls back to the comparator
+  auto key_schema = ParseCreateStatement("a varchar(16)");
+  GenericComparator<32> comparator(key_schema.get());
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<32>, RID, GenericComparator<32>> tree("foo_pk", bpm, comparator);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  auto make_key = [&key_schema](int64_t id) {
+    char name[16];
+    snprintf(name, sizeof(name), "key_%05ld", id);
+    GenericKey<32> key;
+    key.SetFromKey(Tuple({Value(TypeId::VARCHAR, std::string(name))}, key_schema.get()), key_schema.get());
+    return key;
+  };
+  std::vector<int64_t> ids;
+  for (int64_t id = 0; id < 5000; id++) {
+    ids.push_back(id);
+  }
+  std::shuffle(ids.begin(), ids.end(), std::mt19937(15445));
+  for (auto id : ids) {
+    EXPECT_TRUE(tree.Insert(make_key(id), RID(0, id)));
+  }
+  std::vector<RID> rids;
+  for (auto id : ids) {
+    rids.clear();
+    EXPECT_TRUE(tree.GetValue(make_key(id), &rids));
+    ASSERT_EQ(rids.size(), 1U);
+    EXPECT_EQ(rids[0].GetSlotNum(), id);
+  }
+  int64_t current_id = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_id);
+    current_id++;
+  }
+  EXPECT_EQ(current_id, static_cast<int64_t>(ids.size()));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeTests, KeyEncoderTest) {
+  // memcmp orders encoded keys column by column as the values compare, and decoding gives the values back
+  auto key_schema = ParseCreateStatement("a integer,b varchar(8),c double");
+  GenericComparator<32> comparator(key_schema.get());
+  std::vector<int32_t> integers = {-70000, -1, 0, 1, 256, 70000};
+  std::vector<std::string> strings = {std::string(1, '\0'), "a", std::string("a\0b", 3), "ab", "b"};
+  std::vector<double> decimals = {-1.5, 0.0, 0.25, 1e10};
+  std::vector<std::vector<Value>> rows;
+  for (auto integer : integers) {
+    for (const auto &string : strings) {
+      for (auto decimal : decimals) {
+        rows.push_back(
+            {Value(TypeId::INTEGER, integer), Value(TypeId::VARCHAR, string), Value(TypeId::DECIMAL, decimal)});
+      }
+    }
+  }
+  // the rows are listed in order
+  GenericKey<32> previous;
+  for (size_t i = 0; i < rows.size(); i++) {
+    GenericKey<32> key;
+    key.SetFromKey(Tuple(rows[i], key_schema.get()), key_schema.get());
+    for (uint32_t column = 0; column < 3; column++) {
+      EXPECT_EQ(CmpBool::CmpTrue, key.ToValue(key_schema.get(), column).CompareEquals(rows[i][column]));
+    }
+    if (i > 0) {
+      EXPECT_LT(comparator(previous, key), 0);
+    }
+    previous = key;
+  }
+}
+
 }  // namespace bustub
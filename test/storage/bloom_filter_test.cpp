@@ -0,0 +1,162 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter_test.cpp
+//
+// Identification: test/storage/bloom_filter_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/logger.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/bloom_filter.h"
+#include "storage/index/extendible_hash_table_index.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+hash_t HashOf(int64_t key) { return HashUtil::HashBytes(reinterpret_cast<const char *>(&key), sizeof(key)); }
+
+}  // namespace
+
+TEST(BloomFilterTest, FalsePositiveRateTest) {
+  const int64_t num_keys = 100000;
+  for (size_t bits_per_key : {8, 10, 16}) {
+    BloomFilter filter(num_keys, bits_per_key);
+    EXPECT_GE(filter.GetSize() * 8, num_keys * bits_per_key);
+    for (int64_t key = 0; key < num_keys; key++) {
+      filter.Insert(HashOf(key));
+    }
+
+    // never a false negative, and few false positives
+    for (int64_t key = 0; key < num_keys; key++) {
+      ASSERT_TRUE(filter.MayContain(HashOf(key)));
+    }
+    int64_t num_passed = 0;
+    for (int64_t key = num_keys; key < 2 * num_keys; key++) {
+      num_passed += filter.MayContain(HashOf(key)) ? 1 : 0;
+    }
+    double rate = static_cast<double>(num_passed) / num_keys;
+    LOG_INFO("%zu bits per key: false positive rate %.4f", bits_per_key, rate);
+    EXPECT_LT(rate, bits_per_key == 8 ? 0.04 : bits_per_key == 10 ? 0.02 : 0.003);
+  }
+}
+
+TEST(BloomFilterTest, ConcurrentInsertTest) {
+  // threads inserting into the same blocks at once lose none of each other's bits
+  const int num_threads = 4;
+  const int64_t keys_per_thread = 20000;
+  BloomFilter filter(num_threads * keys_per_thread / 64, 10);
+  std::vector<std::thread> threads;
+  for (int thread = 0; thread < num_threads; thread++) {
+    threads.emplace_back([&filter, thread] {
+      for (int64_t key = thread; key < num_threads * keys_per_thread; key += num_threads) {
+        filter.Insert(HashOf(key));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int64_t key = 0; key < num_threads * keys_per_thread; key++) {
+    ASSERT_TRUE(filter.MayContain(HashOf(key)));
+  }
+}
+
+TEST(BloomFilterTest, IndexTest) {
+  Schema schema{{Column{"a", TypeId::BIGINT}}};
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  std::vector<std::unique_ptr<Index>> indexes;
+  indexes.push_back(std::make_unique<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>>(
+      std::make_unique<IndexMetadata>("bplus_tree", "foo", &schema, std::vector<uint32_t>{0}), bpm));
+  indexes.push_back(std::make_unique<ExtendibleHashTableIndex<GenericKey<8>, RID, GenericComparator<8>>>(
+      std::make_unique<IndexMetadata>("hash_table", "foo", &schema, std::vector<uint32_t>{0}), bpm,
+      HashFunction<GenericKey<8>>()));
+
+  // even keys are in the index, odd ones are probed for and missed
+  const int64_t num_keys = 20000;
+  for (auto &index : indexes) {
+    Schema *key_schema = index->GetKeySchema();
+    auto key = [&](int64_t key) { return Tuple({ValueFactory::GetBigIntValue(key)}, key_schema); };
+    for (int64_t i = 0; i < num_keys; i++) {
+      index->InsertEntry(key(2 * i), RID(0, i), nullptr);
+    }
+    auto probe = [&](int64_t begin) {
+      auto start = std::chrono::steady_clock::now();
+      int64_t num_found = 0;
+      for (int64_t i = 0; i < num_keys; i++) {
+        std::vector<RID> rids;
+        index->ScanKey(key(begin + 2 * i), &rids, nullptr);
+        num_found += static_cast<int64_t>(rids.size());
+      }
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      return std::make_pair(num_found, elapsed.count());
+    };
+
+    EXPECT_EQ(index->GetBloomFilter(), nullptr);
+    auto [unfiltered_hits, unfiltered_time] = probe(0);
+    auto [unfiltered_misses, unfiltered_miss_time] = probe(1);
+    EXPECT_EQ(unfiltered_hits, num_keys);
+    EXPECT_EQ(unfiltered_misses, 0);
+
+    index->RebuildBloomFilter(10);
+    ASSERT_NE(index->GetBloomFilter(), nullptr);
+    auto [hits, time] = probe(0);
+    auto [misses, miss_time] = probe(1);
+    EXPECT_EQ(hits, num_keys);
+    EXPECT_EQ(misses, 0);
+    LOG_INFO("%s: %ld hits %.3f / %.3f sec, %ld misses %.3f / %.3f sec without / with a Bloom filter",
+             index->GetName().c_str(), num_keys, unfiltered_time, time, num_keys, unfiltered_miss_time, miss_time);
+
+    // keys inserted after the rebuild are added to the filter
+    index->InsertEntry(key(-1), RID(1, 0), nullptr);
+    std::vector<RID> rids;
+    index->ScanKey(key(-1), &rids, nullptr);
+    EXPECT_EQ(rids.size(), 1);
+
+    // rebuilds swap the filter under probes, and never lose a key inserted while they scan
+    std::thread rebuilder([&index] {
+      for (int rebuild = 0; rebuild < 5; rebuild++) {
+        index->RebuildBloomFilter(10);
+      }
+    });
+    for (int64_t i = 0; i < 1000; i++) {
+      index->InsertEntry(key(2 * (num_keys + i)), RID(1, i + 1), nullptr);
+      rids.clear();
+      index->ScanKey(key(2 * (num_keys + i)), &rids, nullptr);
+      EXPECT_EQ(rids.size(), 1);
+    }
+    rebuilder.join();
+    EXPECT_EQ(probe(num_keys * 2).first, 1000);
+
+    index->DropBloomFilter();
+    EXPECT_EQ(index->GetBloomFilter(), nullptr);
+    EXPECT_EQ(probe(0).first, num_keys);
+  }
+
+  indexes.clear();
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub
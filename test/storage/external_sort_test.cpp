@@ -0,0 +1,126 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// external_sort_test.cpp
+//
+// Identification: test/storage/external_sort_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "storage/index/external_sort.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(ExternalSortTest, SortTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+  auto *disk_manager = new DiskManager("test.db");
+  // five runs are merged at a time
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(20, disk_manager);
+
+  // few distinct keys, so that each comes up many times, in the order its entries were added
+  const int64_t num_entries = 20000;
+  std::mt19937 gen(15445);
+  std::vector<int64_t> keys(num_entries);
+  for (auto &key : keys) {
+    key = gen() % 1000;
+  }
+  for (size_t run_size : {100, 1000, 100000}) {
+    ExternalSort<GenericKey<8>, RID, GenericComparator<8>> sort(bpm, comparator, run_size);
+    GenericKey<8> index_key;
+    for (int64_t i = 0; i < num_entries; i++) {
+      index_key.SetFromInteger(keys[i]);
+      sort.Add(index_key, RID(0, i));
+    }
+    EXPECT_EQ(sort.GetSize(), num_entries);
+    EXPECT_EQ(sort.GetNumRuns(), run_size < num_entries ? (num_entries + run_size - 1) / run_size - 1 : 0);
+
+    // scanning again returns the same entries, once the runs are merged down to a few
+    for (int scan = 0; scan < 2; scan++) {
+      int64_t num_scanned = 0;
+      int64_t previous_key = -1;
+      uint32_t previous_slot = 0;
+      sort.Scan([&](const std::pair<GenericKey<8>, RID> &entry) {
+        int64_t key = entry.first.ToString();
+        uint32_t slot = entry.second.GetSlotNum();
+        EXPECT_EQ(keys[slot], key);
+        EXPECT_TRUE(key > previous_key || (key == previous_key && slot > previous_slot));
+        previous_key = key;
+        previous_slot = slot;
+        num_scanned++;
+      });
+      EXPECT_EQ(num_scanned, num_entries);
+      EXPECT_LE(sort.GetNumRuns(), 5);
+    }
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(ExternalSortTest, BulkLoadTest) {
+  Schema schema{{Column{"a", TypeId::BIGINT}}};
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(20, disk_manager);
+  page_id_t page_id;
+  bpm->NewPage(&page_id);
+
+  // shuffled keys, each produced twice: the first copy is loaded, from runs far smaller than the index
+  const int64_t num_keys = 20000;
+  std::vector<int64_t> keys(num_keys);
+  for (int64_t key = 0; key < num_keys; key++) {
+    keys[key] = key;
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(15445));
+  auto index = std::make_unique<BPlusTreeIndex<GenericKey<8>, RID, GenericComparator<8>>>(
+      std::make_unique<IndexMetadata>("bplus_tree", "foo", &schema, std::vector<uint32_t>{0}), bpm);
+  int64_t next = 0;
+  auto produce = [&](std::pair<GenericKey<8>, RID> *entry) {
+    if (next == 2 * num_keys) {
+      return false;
+    }
+    entry->first.SetFromInteger(keys[next % num_keys]);
+    entry->second = RID(next / num_keys, keys[next % num_keys]);
+    next++;
+    return true;
+  };
+  EXPECT_TRUE(index->BulkLoad(produce, 1.0, 500));
+
+  int64_t current_key = 0;
+  for (auto iterator = index->GetBeginIterator(); iterator != index->GetEndIterator(); ++iterator) {
+    EXPECT_EQ((*iterator).first.ToString(), current_key);
+    EXPECT_EQ((*iterator).second, RID(0, current_key));
+    current_key++;
+  }
+  EXPECT_EQ(current_key, num_keys);
+
+  // a loaded index is not loaded again
+  next = 0;
+  EXPECT_FALSE(index->BulkLoad(produce, 1.0, 500));
+  EXPECT_EQ(next, 0);
+
+  index.reset();
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+}  // namespace bustub